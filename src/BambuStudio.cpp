@@ -22,10 +22,11 @@
 #include <cstring>
 #include <iostream>
 #include <math.h>
-
-#if defined(__linux__) || defined(__LINUX__)
 #include <condition_variable>
 #include <mutex>
+#include <thread>
+
+#if defined(__linux__) || defined(__LINUX__)
 #include <boost/thread.hpp>
 //add json logic
 #include "nlohmann/json.hpp"
@@ -43,9 +44,12 @@ using namespace nlohmann;
 #include <boost/dll/runtime_symbol_info.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/task_group.h>
+
 #include "unix/fhs.hpp"  // Generated by CMake from ../platform/unix/fhs.hpp.in
 
 #include "libslic3r/libslic3r.h"
+#include "libslic3r/BatchServer.hpp"
 #include "libslic3r/Config.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/GCode/PostProcessor.hpp"
@@ -68,6 +72,7 @@ using namespace nlohmann;
 
 #include "libslic3r/Orient.hpp"
 #include "libslic3r/PNGReadWrite.hpp"
+#include "libslic3r/Profiler.hpp"
 #include "libslic3r/ObjColorUtils.hpp"
 
 #include "BambuStudio.hpp"
@@ -382,6 +387,11 @@ typedef struct _cli_callback_mgr {
             close(m_pipe_fd);
             m_pipe_fd = -1;
         }
+        //BBS: allow starting again by the next job of the batch server
+        lck.lock();
+        m_started = false;
+        m_exit = false;
+        lck.unlock();
         BOOST_LOG_TRIVIAL(info) << "cli_callback_mgr_t::stop successfully.";
     }
 }cli_callback_mgr_t;
@@ -410,6 +420,95 @@ void default_status_callback(const PrintBase::SlicingStatus& slicing_status)
 }
 
 
+//BBS: plates sliced concurrently ahead of the serial export loop
+typedef struct _parallel_plate {
+    int                                         index { 0 };
+    PrintBase*                                  print { nullptr };
+    size_t                                      triangle_count { 0 };
+    std::unordered_map<std::string, long long>  slice_time;
+    std::vector<PrintBase::SlicingStatus>       warnings;
+    std::mutex                                  warnings_mutex;
+    std::exception_ptr                          error;
+}parallel_plate_t;
+
+// Process wide state reached by Print::process() of the plates processed concurrently:
+// - Model::printSpeedMap and Model::extruderParamsMap, read by the brim generation, are filled from the project config
+//   and from the print config of a plate (bed exclude area). They are set once for all the plates of a batch.
+// - PrintStateBase::g_last_timestamp, the step timestamps shared by all the prints, is atomic.
+// - CNumericLocalesSetter is only used by the G-code export and the G-code processor, which run in the serial loop,
+//   and it switches the locale of the calling thread only.
+// - The lazily filled tables of Print (filament temperature types, nozzle hardness, incompatible filaments)
+//   are read by Print::validate() and the G-code export, which run in the serial loop as well.
+// To keep any other state derived from the print config the same for all the concurrent plates,
+// only plates with the same print config as the first one are processed concurrently, the other ones by the serial loop.
+static bool same_global_config(const PrintConfig &config1, const PrintConfig &config2)
+{
+    return config1.equals(config2);
+}
+
+static void process_parallel_plate(parallel_plate_t &plate)
+{
+    BOOST_LOG_TRIVIAL(info) << boost::format("%1%: start plate %2%, %3% triangles") % __FUNCTION__ % (plate.index + 1) % plate.triangle_count;
+    plate.print->set_status_callback([&plate](const PrintBase::SlicingStatus &slicing_status) {
+        if (slicing_status.warning_step != -1) {
+            std::lock_guard<std::mutex> lck(plate.warnings_mutex);
+            plate.warnings.push_back(slicing_status);
+        }
+    });
+    plate.slice_time[TIME_USING_CACHE] = 0;
+    plate.slice_time[TIME_MAKE_PERIMETERS] = 0;
+    plate.slice_time[TIME_INFILL] = 0;
+    plate.slice_time[TIME_GENERATE_SUPPORT] = 0;
+    try {
+        plate.print->process(&plate.slice_time);
+    } catch (...) {
+        plate.error = std::current_exception();
+    }
+    BOOST_LOG_TRIVIAL(info) << boost::format("%1%: finished plate %2%") % __FUNCTION__ % (plate.index + 1);
+}
+
+// Process the prints of several plates concurrently. Each Print::process() runs its own parallel loops,
+// all of them are scheduled to the same TBB work stealing pool. The plates are grouped in the plate order
+// into batches of at most max_parallel plates fitting into the memory budget, a plate exceeding the budget
+// is processed alone. The warnings are collected per plate and reported later by the serial loop in the plate order,
+// so the results are identical to slicing the plates one by one.
+// With a memory budget, the first plate is processed alone to measure the resident memory retained per triangle,
+// the memory of the other plates is estimated from it. If it can not be measured, the plates are processed one by one.
+static void process_plates_in_parallel(std::vector<std::unique_ptr<parallel_plate_t>> &plates, size_t max_parallel, size_t memory_budget)
+{
+    BOOST_LOG_TRIVIAL(info) << boost::format("%1%: %2% plates, max parallel %3%, memory budget %4% MB") % __FUNCTION__ % plates.size() % max_parallel % (memory_budget >> 20);
+    size_t batch_begin        = 0;
+    double bytes_per_triangle = 0.;
+    if (memory_budget > 0 && ! plates.empty()) {
+        const size_t resident_before = process_resident_memory();
+        process_parallel_plate(*plates.front());
+        const size_t resident_after  = process_resident_memory();
+        if (resident_before > 0 && resident_after > resident_before && plates.front()->triangle_count > 0)
+            bytes_per_triangle = double(resident_after - resident_before) / double(plates.front()->triangle_count);
+        else
+            max_parallel = 1;
+        BOOST_LOG_TRIVIAL(info) << boost::format("%1%: plate %2% retained %3% MB, %4% bytes per triangle")
+            % __FUNCTION__ % (plates.front()->index + 1) % ((resident_after > resident_before ? resident_after - resident_before : 0) >> 20) % size_t(bytes_per_triangle);
+        batch_begin = 1;
+    }
+    auto estimated_memory = [bytes_per_triangle](const parallel_plate_t &plate) { return size_t(bytes_per_triangle * double(plate.triangle_count)); };
+    while (batch_begin < plates.size()) {
+        size_t batch_end    = batch_begin + 1;
+        size_t batch_memory = estimated_memory(*plates[batch_begin]);
+        while (batch_end < plates.size() && batch_end - batch_begin < max_parallel &&
+               (memory_budget == 0 || batch_memory + estimated_memory(*plates[batch_end]) <= memory_budget))
+            batch_memory += estimated_memory(*plates[batch_end ++]);
+
+        tbb::task_group group;
+        for (size_t i = batch_begin; i < batch_end; ++ i) {
+            parallel_plate_t *plate = plates[i].get();
+            group.run([plate]() { process_parallel_plate(*plate); });
+        }
+        group.wait();
+        batch_begin = batch_end;
+    }
+}
+
 static PrinterTechnology get_printer_technology(const DynamicConfig &config)
 {
     const ConfigOptionEnum<PrinterTechnology> *opt = config.option<ConfigOptionEnum<PrinterTechnology>>("printer_technology");
@@ -596,6 +695,81 @@ const float bed3d_ax3s_default_stem_length = 25.0f;
 const float bed3d_ax3s_default_tip_radius = 2.5f * bed3d_ax3s_default_stem_radius;
 const float bed3d_ax3s_default_tip_length = 5.0f;
 
+//BBS: the setting files and resource jsons parsed by the CLI are kept across the jobs of the batch server,
+//so that the system presets are only parsed once. The cached entries are revalidated by the file time and size.
+static bool g_cache_setting_files = false;
+
+typedef struct _cached_setting_file {
+    std::time_t                         mtime { 0 };
+    uintmax_t                           size { 0 };
+    DynamicPrintConfig                  config;
+    std::map<std::string, std::string>  key_values;
+    ConfigSubstitutions                 substitutions;
+    std::string                         reason;
+}cached_setting_file_t;
+static std::map<std::string, cached_setting_file_t> g_setting_files_cache;
+
+typedef struct _cached_json_file {
+    std::time_t     mtime { 0 };
+    uintmax_t       size { 0 };
+    json            root;
+}cached_json_file_t;
+static std::map<std::string, cached_json_file_t> g_json_files_cache;
+
+static bool get_file_stamp(const std::string &file, std::time_t &mtime, uintmax_t &size)
+{
+    boost::system::error_code ec;
+    mtime = boost::filesystem::last_write_time(file, ec);
+    if (ec)
+        return false;
+    size = boost::filesystem::file_size(file, ec);
+    return !ec;
+}
+
+static ConfigSubstitutions load_setting_file(const std::string &file, ForwardCompatibilitySubstitutionRule rule, DynamicPrintConfig &config,
+    std::map<std::string, std::string> &key_values, std::string &reason)
+{
+    std::time_t mtime;
+    uintmax_t   size;
+    // Loading into a non-empty config may merge with the existing values, do not cache that.
+    if (!g_cache_setting_files || !config.empty() || !get_file_stamp(file, mtime, size))
+        return config.load_from_json(file, rule, key_values, reason);
+
+    auto it = g_setting_files_cache.find(file);
+    if (it == g_setting_files_cache.end() || it->second.mtime != mtime || it->second.size != size) {
+        cached_setting_file_t entry;
+        entry.mtime = mtime;
+        entry.size  = size;
+        entry.substitutions = entry.config.load_from_json(file, rule, entry.key_values, entry.reason);
+        it = g_setting_files_cache.insert_or_assign(file, std::move(entry)).first;
+    }
+    else
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": reuse the cached setting file " << file;
+    config = it->second.config;
+    key_values.insert(it->second.key_values.begin(), it->second.key_values.end());
+    reason = it->second.reason;
+    return it->second.substitutions;
+}
+
+// May throw the exceptions of nlohmann::json::parse().
+static void load_json_file(const std::string &file, json &root)
+{
+    std::time_t mtime;
+    uintmax_t   size;
+    if (g_cache_setting_files && get_file_stamp(file, mtime, size)) {
+        auto it = g_json_files_cache.find(file);
+        if (it != g_json_files_cache.end() && it->second.mtime == mtime && it->second.size == size) {
+            root = it->second.root;
+            return;
+        }
+    }
+    boost::nowide::ifstream ifs(file);
+    ifs >> root;
+    ifs.close();
+    if (g_cache_setting_files && get_file_stamp(file, mtime, size))
+        g_json_files_cache[file] = { mtime, size, root };
+}
+
 static int load_key_values_from_json(const std::string &file, std::map<std::string, std::string>& key_values)
 {
     json j;
@@ -603,9 +777,7 @@ static int load_key_values_from_json(const std::string &file, std::map<std::stri
 
     BOOST_LOG_TRIVIAL(debug) << __FUNCTION__<< ": begin to parse "<<file;
     try {
-        boost::nowide::ifstream ifs(file);
-        ifs >> j;
-        ifs.close();
+        load_json_file(file, j);
 
         //parse the json elements
         for (auto it = j.begin(); it != j.end(); it++) {
@@ -1277,9 +1449,7 @@ static void load_downward_settings_list_from_config(std::string config_file, std
     else {
         try {
             json root_json;
-            boost::nowide::ifstream ifs(config_file);
-            ifs >> root_json;
-            ifs.close();
+            load_json_file(config_file, root_json);
 
             if (root_json.contains("printer")) {
                 json printer_json = root_json["printer"];
@@ -1381,12 +1551,28 @@ int CLI::run(int argc, char **argv)
         return CLI_INVALID_PARAMS;
     }
     BOOST_LOG_TRIVIAL(info) << "finished setup params, argc="<< argc << std::endl;
+    if (m_config.opt_bool("batch_server"))
+        return this->run_batch_server(argc, argv);
+    return this->run_job(argc, argv);
+}
+
+int CLI::run_job(int argc, char **argv)
+{
     std::string temp_path = wxFileName::GetTempDir().utf8_str().data();
     set_temporary_dir(temp_path);
 
     m_extra_config.apply(m_config, true);
     m_extra_config.normalize_fdm();
 
+    //BBS: record the profiler zones for the whole job, the trace is written when leaving CLI::run_job().
+    // The jobs of the batch server get their own trace files, see CLI::run_batch_server().
+    std::unique_ptr<Profiler::Session> profile_session;
+    ConfigOptionString* profile_out_option = m_config.option<ConfigOptionString>("profile_out");
+    if (profile_out_option && !profile_out_option->value.empty()) {
+        BOOST_LOG_TRIVIAL(info) << "profiling enabled, trace will be written to " << profile_out_option->value;
+        profile_session = std::make_unique<Profiler::Session>(profile_out_option->value);
+    }
+
     PrinterTechnology printer_technology = get_printer_technology(m_config);
 
     //BBS: remove GCodeViewer as seperate APP logic
@@ -1611,6 +1797,19 @@ int CLI::run(int argc, char **argv)
     if (custom_gcode_option)
         custom_gcode_file = custom_gcode_option->value;
 
+    std::string step_cache_dir;
+    ConfigOptionString* step_cache_dir_option = m_config.option<ConfigOptionString>("step_cache_dir");
+    if (step_cache_dir_option)
+        step_cache_dir = step_cache_dir_option->value;
+
+    size_t parallel_plates = 1, slicing_memory_budget = 0;
+    ConfigOptionInt* parallel_plates_option = m_config.option<ConfigOptionInt>("parallel_plates");
+    if (parallel_plates_option)
+        parallel_plates = (parallel_plates_option->value > 0) ? size_t(parallel_plates_option->value) : size_t(std::max(1u, std::thread::hardware_concurrency()));
+    ConfigOptionInt* slicing_memory_budget_option = m_config.option<ConfigOptionInt>("slicing_memory_budget");
+    if (slicing_memory_budget_option)
+        slicing_memory_budget = size_t(slicing_memory_budget_option->value) << 20;
+
     std::string load_assemble_list;
     std::vector<assemble_plate_info_t> assemble_plate_info_list;
     ConfigOptionString* load_assemble_list_option = m_config.option<ConfigOptionString>("load_assemble_list");
@@ -2025,7 +2224,7 @@ int CLI::run(int argc, char **argv)
             std::map<std::string, std::string> key_values;
             std::string reason;
 
-            config_substitutions = config.load_from_json(file, config_substitution_rule, key_values, reason);
+            config_substitutions = load_setting_file(file, config_substitution_rule, config, key_values, reason);
             if (!reason.empty()) {
                 BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<<  ":Can not load config from file "<<file<<"\n";
                 return CLI_CONFIG_FILE_ERROR;
@@ -2874,9 +3073,7 @@ int CLI::run(int argc, char **argv)
                 else {
                     try {
                         json root_json;
-                        boost::nowide::ifstream ifs(cli_config_file);
-                        ifs >> root_json;
-                        ifs.close();
+                        load_json_file(cli_config_file, root_json);
 
                         if (root_json.contains("printer")) {
                             json printer_json = root_json["printer"];
@@ -5685,6 +5882,9 @@ int CLI::run(int argc, char **argv)
                 std::string outfile;
                 //Print       fff_print;
                 std::vector<size_t> plate_triangle_counts(partplate_list.get_plate_count(), 0);
+                //BBS: plates processed concurrently at the end of the pre_check pass, indexed by plate
+                std::vector<std::unique_ptr<parallel_plate_t>> parallel_plates_list;
+                std::vector<parallel_plate_t*> parallel_plate_of(partplate_list.get_plate_count(), nullptr);
 
                 while(!finished)
                 {
@@ -6060,8 +6260,18 @@ int CLI::run(int argc, char **argv)
                             flush_and_exit(CLI_NO_SUITABLE_OBJECTS);
                         }
                         else {
-                            if (pre_check && (partplate_list.get_plate_count() > 1)) //continue to next plate directly
+                            if (pre_check && (partplate_list.get_plate_count() > 1)) { //continue to next plate directly
+                                //BBS: a plate with another print config than the first parallel plate is sliced by the serial loop
+                                if ((parallel_plates > 1) && !load_slicedata && step_cache_dir.empty() && (printer_technology == ptFFF) &&
+                                    (parallel_plates_list.empty() || same_global_config(print_fff->config(), dynamic_cast<Print*>(parallel_plates_list.front()->print)->config()))) {
+                                    parallel_plates_list.emplace_back(std::make_unique<parallel_plate_t>());
+                                    parallel_plate_t &parallel_plate = *parallel_plates_list.back();
+                                    parallel_plate.index = index;
+                                    parallel_plate.print = print;
+                                    parallel_plate.triangle_count = plate_triangle_counts[index];
+                                }
                                 continue;
+                            }
                             try {
                                 std::string outfile_final;
                                 BOOST_LOG_TRIVIAL(info) << "start Print::process for partplate "<<index+1 << std::endl;
@@ -6130,7 +6340,21 @@ int CLI::run(int argc, char **argv)
                                     }
                                 }
                                 else {
-                                    print->process(&slice_time);
+                                    if (!step_cache_dir.empty() && (printer_technology == ptFFF)) {
+                                        int ret = print_fff->load_step_cache(step_cache_dir);
+                                        BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": load step cache from " << step_cache_dir << ", ret=" << ret;
+                                    }
+                                    if (parallel_plate_t *parallel_plate = parallel_plate_of[index]) {
+                                        //BBS: already processed concurrently, report its results in the plate order
+                                        if (parallel_plate->error)
+                                            std::rethrow_exception(parallel_plate->error);
+                                        g_slicing_warnings.insert(g_slicing_warnings.end(), parallel_plate->warnings.begin(), parallel_plate->warnings.end());
+                                        slice_time = parallel_plate->slice_time;
+                                        // nothing to do unless the second apply() invalidated some steps
+                                        print->process();
+                                    }
+                                    else
+                                        print->process(&slice_time);
                                     BOOST_LOG_TRIVIAL(info) << "print::process: first time_using_cache is " << slice_time[TIME_USING_CACHE] << " secs.";
                                 }
                                 if (printer_technology == ptFFF) {
@@ -6268,6 +6492,12 @@ int CLI::run(int argc, char **argv)
                                         flush_and_exit(ret);
                                     }
                                 }
+                                if (!step_cache_dir.empty() && (printer_technology == ptFFF)) {
+                                    //the step cache is only an accelerator, failing to update it does not fail the slicing
+                                    int ret = print_fff->export_step_cache(step_cache_dir);
+                                    if (ret)
+                                        BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": export step cache to " << step_cache_dir << " error, ret=" << ret;
+                                }
                                 end_time = (long long)Slic3r::Utils::get_current_milliseconds_time_utc();
                                 sliced_plate_info.sliced_time = end_time - start_time;
                                 sliced_plate_info.sliced_time_with_cache = slice_time[TIME_USING_CACHE];
@@ -6380,8 +6610,16 @@ int CLI::run(int argc, char **argv)
                             }
                         }
                     }
-                    if (pre_check&& (partplate_list.get_plate_count() > 1))
+                    if (pre_check&& (partplate_list.get_plate_count() > 1)) {
                         pre_check = false;
+                        if (parallel_plates_list.size() > 1) {
+                            Model::setExtruderParams(m_print_config, filament_count);
+                            Model::setPrintSpeedTable(m_print_config, dynamic_cast<Print*>(parallel_plates_list.front()->print)->config());
+                            process_plates_in_parallel(parallel_plates_list, parallel_plates, slicing_memory_budget);
+                            for (std::unique_ptr<parallel_plate_t> &parallel_plate : parallel_plates_list)
+                                parallel_plate_of[parallel_plate->index] = parallel_plate.get();
+                        }
+                    }
                     else
                         finished = true;
                 }//end for partplate
@@ -7196,6 +7434,61 @@ int CLI::run(int argc, char **argv)
     return 0;
 }
 
+//BBS: batch server mode, the job protocol is described in BatchServer.hpp.
+//The arguments of the server command line are parsed once, each job starts from a copy of them and only parses its own arguments.
+//The setting files and resource jsons loaded by the jobs are kept by this process until the server stops.
+int CLI::run_batch_server(int argc, char **argv)
+{
+    m_config.option<ConfigOptionBool>("batch_server", true)->value = false;
+    const std::string program_name = argc > 0 ? argv[0] : SLIC3R_APP_KEY;
+
+    g_cache_setting_files = true;
+    BOOST_LOG_TRIVIAL(info) << boost::format("%1%: batch server started, %2% input files, %3% actions") % __FUNCTION__ % m_input_files.size() % m_actions.size();
+
+    // the jobs given the --profile-out of the server write their traces next to it, numbered in the order of the jobs
+    const ConfigOptionString *profile_out_option = m_config.option<ConfigOptionString>("profile_out");
+    const std::string         profile_out        = profile_out_option ? profile_out_option->value : std::string();
+    size_t                    job_count          = 0;
+
+    BatchServer server([this, &program_name, &profile_out, &job_count](const std::vector<std::string> &args) {
+        std::vector<std::string> job_args { program_name };
+        job_args.insert(job_args.end(), args.begin(), args.end());
+        std::vector<char*> job_argv;
+        for (std::string &arg : job_args)
+            job_argv.emplace_back(arg.data());
+        job_argv.emplace_back(nullptr);
+
+        CLI job;
+        job.m_config      = m_config;
+        job.m_input_files = m_input_files;
+        job.m_actions     = m_actions;
+        job.m_transforms  = m_transforms;
+        ++ job_count;
+        if (!job.parse_arguments(int(job_args.size()), job_argv.data()))
+            return CLI_INVALID_PARAMS;
+        ConfigOptionString *job_profile_out = job.m_config.option<ConfigOptionString>("profile_out");
+        if (job_profile_out != nullptr && !profile_out.empty() && job_profile_out->value == profile_out) {
+            boost::filesystem::path path(profile_out);
+            job_profile_out->value = (path.parent_path() / (path.stem().string() + "." + std::to_string(job_count) + path.extension().string())).string();
+        }
+        // the actions of the server command line may be repeated by the job
+        for (std::vector<std::string> *keys : { &job.m_actions, &job.m_transforms }) {
+            std::set<std::string> seen;
+            keys->erase(std::remove_if(keys->begin(), keys->end(), [&seen](const std::string &key) { return !seen.insert(key).second; }), keys->end());
+        }
+        int ret = job.run_job(int(job_args.size()), job_argv.data());
+        boost::nowide::cout.flush();
+        boost::nowide::cerr.flush();
+        return ret;
+    });
+    server.run(boost::nowide::cin, boost::nowide::cout);
+
+    g_cache_setting_files = false;
+    g_setting_files_cache.clear();
+    g_json_files_cache.clear();
+    return CLI_SUCCESS;
+}
+
 bool CLI::setup(int argc, char **argv)
 {
     // Detect the operating system flavor after SLIC3R_LOGLEVEL is set.
@@ -7248,15 +7541,23 @@ bool CLI::setup(int argc, char **argv)
     set_local_dir((path_resources / "i18n").string());
     set_sys_shapes_dir((path_resources / "shapes").string());
 
+    return this->parse_arguments(argc, argv);
+}
+
+bool CLI::parse_arguments(int argc, char **argv)
+{
     // Parse all command line options into a DynamicConfig.
     // If any option is unsupported, print usage and abort immediately.
+    //BBS: parsed into an empty config first, so the options of a batch server job replace the ones of the server instead of being chained to them.
     t_config_option_keys opt_order;
-    if (! m_config.read_cli(argc, argv, &m_input_files, &opt_order)) {
+    DynamicPrintAndCLIConfig cli_config;
+    if (! cli_config.read_cli(argc, argv, &m_input_files, &opt_order)) {
         // Separate error message reported by the CLI parser from the help.
         boost::nowide::cerr << std::endl;
         this->print_help();
         return false;
     }
+    m_config.apply(cli_config);
     // Parse actions and transform options.
     for (auto const &opt_key : opt_order) {
         if (cli_actions_config_def.has(opt_key))
@@ -117,6 +117,13 @@ private:
     std::vector<Model>          m_models;
 
     bool setup(int argc, char **argv);
+    // Parses the command line into m_config, m_input_files, m_actions and m_transforms, on top of their current content.
+    bool parse_arguments(int argc, char **argv);
+    // Everything run() does after the process setup and the parsing of the arguments.
+    int run_job(int argc, char **argv);
+
+    //BBS: batch server mode, reads slicing jobs from stdin and runs them in this process.
+    int run_batch_server(int argc, char **argv);
 
     /// Prints usage of the CLI.
     void print_help(bool include_print_options = false, PrinterTechnology printer_technology = ptAny) const;
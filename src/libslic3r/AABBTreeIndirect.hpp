@@ -7,6 +7,7 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -470,6 +471,116 @@ namespace detail {
 		}
 	}
 
+	// Maximum number of rays traced together through the AABB tree by intersect_rays_first_hit().
+	static constexpr const size_t RayPacketSize = 32;
+
+	// Trace a packet of up to RayPacketSize rays sharing a common origin through the AABB tree, returning the first hit of each ray.
+	// The tree is traversed once for the whole packet with an explicit stack. Each traversed node keeps the list of rays
+	// of the packet entering its bounding box before their closest hit found so far, its children are only tested against these rays.
+	// Thus the cost of traversing a node is proportional to the number of rays still active there, even for divergent rays,
+	// while the nodes close to the root shared by most of the rays are fetched from memory once for the whole packet.
+	template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+	static inline void intersect_ray_packet_first_hit(
+		const std::vector<VertexType> 		&vertices,
+		const std::vector<IndexedFaceType> 	&faces,
+		const TreeType 						&tree,
+		const VectorType					&origin,
+		const VectorType					*dirs,
+		size_t                               num_rays,
+		igl::Hit                            *hits,
+		double                               eps)
+	{
+		using CoordType = typename TreeType::CoordType;
+		assert(num_rays <= RayPacketSize);
+		// The tree is balanced, its depth is bounded by the number of bits of the node index.
+		static constexpr const size_t MaxDepth = sizeof(size_t) * 8;
+
+		// Structure of arrays of the inverse ray directions and of the ray parameters of the closest hits.
+		CoordType invdir[3][RayPacketSize];
+		CoordType t_best[RayPacketSize];
+		double    t_hit[RayPacketSize];
+		// Rays entering the bounding box of the node being traversed at each depth of the tree.
+		uint8_t   active[MaxDepth + 1][RayPacketSize];
+		size_t    num_active[MaxDepth + 1];
+		// Sum of the ray directions to order the traversal of the child nodes front to back.
+		CoordType dir_sum[3] { 0, 0, 0 };
+		for (size_t i = 0; i < num_rays; ++ i) {
+			for (int d = 0; d < 3; ++ d) {
+				invdir[d][i]  = CoordType(1.) / CoordType(dirs[i](d));
+				dir_sum[d]   += CoordType(dirs[i](d));
+			}
+			t_best[i] = std::numeric_limits<CoordType>::infinity();
+			t_hit[i]  = std::numeric_limits<double>::infinity();
+			hits[i]   = igl::Hit { -1, -1, 0.f, 0.f, std::numeric_limits<float>::infinity() };
+			active[0][i] = uint8_t(i);
+		}
+		num_active[0] = num_rays;
+		const CoordType ox = CoordType(origin.x());
+		const CoordType oy = CoordType(origin.y());
+		const CoordType oz = CoordType(origin.z());
+
+		// Node index and its depth, the root has depth 1 and its parent list active[0] contains all the rays.
+		std::pair<size_t, size_t> stack[MaxDepth * 2];
+		size_t stack_size = 0;
+		stack[stack_size ++] = { 0, 1 };
+		while (stack_size > 0) {
+			const auto [node_idx, depth] = stack[-- stack_size];
+			const auto  &node = tree.node(node_idx);
+			assert(node.is_valid());
+			assert(depth <= MaxDepth);
+			const auto  &bmin = node.bbox.min();
+			const auto  &bmax = node.bbox.max();
+			const CoordType x0 = bmin.x() - ox, x1 = bmax.x() - ox;
+			const CoordType y0 = bmin.y() - oy, y1 = bmax.y() - oy;
+			const CoordType z0 = bmin.z() - oz, z1 = bmax.z() - oz;
+			// Filter the rays of the parent node by the bounding box of this node.
+			const uint8_t *parent_active = active[depth - 1];
+			uint8_t       *this_active   = active[depth];
+			size_t         this_num      = 0;
+			for (size_t k = 0; k < num_active[depth - 1]; ++ k) {
+				const size_t i = parent_active[k];
+				CoordType tx0 = x0 * invdir[0][i], tx1 = x1 * invdir[0][i];
+				CoordType ty0 = y0 * invdir[1][i], ty1 = y1 * invdir[1][i];
+				CoordType tz0 = z0 * invdir[2][i], tz1 = z1 * invdir[2][i];
+				CoordType tmin = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), CoordType(0)));
+				CoordType tmax = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), t_best[i]));
+				this_active[this_num] = uint8_t(i);
+				this_num += tmin <= tmax;
+			}
+			if (this_num == 0)
+				continue;
+			if (node.is_leaf()) {
+				const auto &face = faces[node.idx];
+				const auto &v0   = vertices[face(0)];
+				const auto &v1   = vertices[face(1)];
+				const auto &v2   = vertices[face(2)];
+				for (size_t k = 0; k < this_num; ++ k) {
+					const size_t i = this_active[k];
+					double t, u, v;
+					if (intersect_triangle(origin, dirs[i], v0, v1, v2, t, u, v, eps) && t > 0. && t < t_hit[i]) {
+						t_hit[i]  = t;
+						// Round up, so that a bounding box entered by the ray at the parameter of the hit is not culled.
+						t_best[i] = std::nextafter(CoordType(t), std::numeric_limits<CoordType>::infinity());
+						hits[i]   = igl::Hit { int(node.idx), -1, float(u), float(v), float(t) };
+					}
+				}
+			} else {
+				num_active[depth] = this_num;
+				size_t left  = node_idx * 2 + 1;
+				size_t right = left + 1;
+				// Push the far child first to visit the near child first, which likely shortens the rays early.
+				const auto &lbox = tree.node(left).bbox;
+				const auto &rbox = tree.node(right).bbox;
+				if ((rbox.min().x() + rbox.max().x() - lbox.min().x() - lbox.max().x()) * dir_sum[0] +
+					(rbox.min().y() + rbox.max().y() - lbox.min().y() - lbox.max().y()) * dir_sum[1] +
+					(rbox.min().z() + rbox.max().z() - lbox.min().z() - lbox.max().z()) * dir_sum[2] < 0)
+					std::swap(left, right);
+				stack[stack_size ++] = { right, depth + 1 };
+				stack[stack_size ++] = { left,  depth + 1 };
+			}
+		}
+	}
+
     // Real-time collision detection, Ericson, Chapter 5
     template<typename Vector>
     static inline Vector closest_point_to_triangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
@@ -787,6 +898,37 @@ inline bool intersect_ray_all_hits(
 	return ! hits.empty();
 }
 
+// Find the first intersections of a bundle of rays sharing a common origin with indexed triangle set.
+// The rays are traced in packets of detail::RayPacketSize rays, see detail::intersect_ray_packet_first_hit(),
+// which is considerably faster than tracing the rays one by one with intersect_ray_first_hit() if the rays are coherent,
+// for example when sampling a hemisphere at a point of a surface.
+// hits are resized to the number of rays, a ray without intersection returns a hit with id == -1.
+// Intersection test is calculated with the accuracy of VectorType::Scalar
+// even if the triangle mesh and the AABB Tree are built with floats.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline void intersect_rays_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Common origin of the rays.
+	const VectorType					&origin,
+	// Directions of the rays.
+	const std::vector<VectorType>		&dirs,
+	// First intersection of each ray with the indexed triangle set.
+	std::vector<igl::Hit> 				&hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+	hits.assign(dirs.size(), igl::Hit { -1, -1, 0.f, 0.f, std::numeric_limits<float>::infinity() });
+	if (! tree.empty())
+		for (size_t i = 0; i < dirs.size(); i += detail::RayPacketSize)
+			detail::intersect_ray_packet_first_hit(vertices, faces, tree, origin, dirs.data() + i,
+				std::min(detail::RayPacketSize, dirs.size() - i), hits.data() + i, eps);
+}
+
 // Finding a closest triangle, its closest point and squared distance to the closest point
 // on a 3D indexed triangle set using a pre-built AABBTreeIndirect::Tree.
 // Closest point to triangle test will be performed with the accuracy of VectorType::Scalar
@@ -408,6 +408,7 @@ void SkeletalTrapezoidation::constructFromPolygons(const Polygons& polys)
     vd_node_to_he_node.clear();
 
     std::vector<Segment> segments;
+    segments.reserve(count_points(polys));
     for (size_t poly_idx = 0; poly_idx < polys.size(); poly_idx++)
         for (size_t point_idx = 0; point_idx < polys[poly_idx].size(); point_idx++)
             segments.emplace_back(&polys, poly_idx, point_idx);
@@ -18,6 +18,8 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 //#define ARACHNE_STITCH_PATCH_DEBUG
 
 namespace Slic3r::Arachne
@@ -517,19 +519,52 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
         );
     const coord_t transition_filter_dist   = scaled<coord_t>(100.f);
     const coord_t allowed_filter_deviation = wall_transition_filter_deviation;
-    SkeletalTrapezoidation wall_maker
-    (
-        prepared_outline,
-        *beading_strat,
-        beading_strat->getTransitioningAngle(),
-        discretization_step_size,
-        transition_filter_dist,
-        allowed_filter_deviation,
-        wall_transition_length,
-        apply_hole_compensation,
-        hole_indices
-    );
-    wall_maker.generateToolpaths(toolpaths);
+    auto generate_island = [&](const Polygons &island, std::vector<VariableWidthLines> &island_toolpaths) {
+        SkeletalTrapezoidation wall_maker
+        (
+            island,
+            *beading_strat,
+            beading_strat->getTransitioningAngle(),
+            discretization_step_size,
+            transition_filter_dist,
+            allowed_filter_deviation,
+            wall_transition_length,
+            apply_hole_compensation,
+            hole_indices
+        );
+        wall_maker.generateToolpaths(island_toolpaths);
+    };
+
+    // BBS: The skeleton inside of an island only depends on the island's own contour and holes, thus disjoint islands
+    // (perforated plates, lattices) are generated in parallel, each with its own Voronoi diagram and graph.
+    // Hole compensation addresses the polygons by their index in the outline, it is only applied to a single pass.
+    std::vector<Polygons> islands;
+    // A single contour with its holes is a single island, no need to split it.
+    if (!apply_hole_compensation &&
+        std::count_if(prepared_outline.begin(), prepared_outline.end(), [](const Polygon &polygon) { return polygon.area() > 0.; }) > 1) {
+        ExPolygons expolys = union_ex(prepared_outline);
+        if (expolys.size() > 1) {
+            islands.reserve(expolys.size());
+            for (ExPolygon &expoly : expolys)
+                islands.emplace_back(to_polygons(std::move(expoly)));
+        }
+    }
+    if (islands.empty()) {
+        generate_island(prepared_outline, toolpaths);
+    } else {
+        std::vector<std::vector<VariableWidthLines>> islands_toolpaths(islands.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, islands.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t island_idx = range.begin(); island_idx < range.end(); ++ island_idx)
+                generate_island(islands[island_idx], islands_toolpaths[island_idx]);
+        });
+        // Merge the islands wall by wall, keeping the order of the islands for the output to be deterministic.
+        for (std::vector<VariableWidthLines> &island_toolpaths : islands_toolpaths) {
+            if (toolpaths.size() < island_toolpaths.size())
+                toolpaths.resize(island_toolpaths.size());
+            for (size_t wall_idx = 0; wall_idx < island_toolpaths.size(); ++ wall_idx)
+                append(toolpaths[wall_idx], std::move(island_toolpaths[wall_idx]));
+        }
+    }
 
     stitchToolPaths(toolpaths, this->bead_width_x);
 
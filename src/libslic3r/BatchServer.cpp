@@ -0,0 +1,116 @@
+#include "BatchServer.hpp"
+#include "Time.hpp"
+#include "Utils.hpp"
+
+#include <istream>
+#include <ostream>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+namespace Slic3r {
+
+static std::string json_to_arg(const json &value)
+{
+    return value.is_string() ? value.get<std::string>() : value.dump();
+}
+
+static std::string json_to_list(const json &value)
+{
+    if (!value.is_array())
+        return json_to_arg(value);
+    std::string list;
+    for (size_t index = 0; index < value.size(); index++) {
+        if (index > 0)
+            list += ";";
+        list += json_to_arg(value[index]);
+    }
+    return list;
+}
+
+bool BatchServer::job_arguments(const std::string &line, std::string &id, std::vector<std::string> &args)
+{
+    json job = json::parse(line);
+    if (job.contains("id"))
+        id = json_to_arg(job["id"]);
+    if (job.contains("command") && job["command"] == "quit")
+        return false;
+
+    if (job.contains("settings"))
+        args.insert(args.end(), { "--load-settings", json_to_list(job["settings"]) });
+    if (job.contains("filaments"))
+        args.insert(args.end(), { "--load-filaments", json_to_list(job["filaments"]) });
+    if (job.contains("overrides") && job["overrides"].is_object())
+        for (auto it = job["overrides"].begin(); it != job["overrides"].end(); ++it)
+            args.insert(args.end(), { "--" + it.key(), json_to_arg(it.value()) });
+    if (job.contains("output_dir"))
+        args.insert(args.end(), { "--outputdir", json_to_arg(job["output_dir"]) });
+    if (job.contains("export_3mf"))
+        args.insert(args.end(), { "--export-3mf", json_to_arg(job["export_3mf"]) });
+    // without any action the CLI would start the GUI, slice all the plates by default
+    args.insert(args.end(), { "--slice", job.contains("plate") ? json_to_arg(job["plate"]) : std::string("0") });
+    if (job.contains("args") && job["args"].is_array())
+        for (const json &arg : job["args"])
+            args.emplace_back(json_to_arg(arg));
+    if (job.contains("input")) {
+        if (job["input"].is_array())
+            for (const json &input : job["input"])
+                args.emplace_back(json_to_arg(input));
+        else
+            args.emplace_back(json_to_arg(job["input"]));
+    }
+    return true;
+}
+
+size_t BatchServer::run(std::istream &in, std::ostream &out)
+{
+    out << "batch_server: ready" << std::endl;
+
+    size_t      job_count = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        boost::trim(line);
+        if (line.empty())
+            continue;
+
+        json        result;
+        int         ret = CLI_SUCCESS;
+        long long   start_time = (long long)Utils::get_current_milliseconds_time_utc();
+        try {
+            std::string              id;
+            std::vector<std::string> args;
+            bool                     quit = !job_arguments(line, id, args);
+            if (!id.empty())
+                result["id"] = id;
+            if (quit)
+                break;
+            BOOST_LOG_TRIVIAL(info) << boost::format("%1%: start job %2%, %3% arguments") % __FUNCTION__ % job_count % args.size();
+            ret = m_runner(args);
+        }
+        catch (const json::exception &err) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ": invalid job " << line << ", reason = " << err.what();
+            result["error"] = err.what();
+            ret = CLI_INVALID_PARAMS;
+        }
+        catch (const std::exception &err) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ": job " << job_count << " got an exception, reason = " << err.what();
+            result["error"] = err.what();
+            ret = CLI_SLICING_ERROR;
+        }
+        ++ job_count;
+
+        result["return_code"] = ret;
+        result["time_ms"]     = (long long)Utils::get_current_milliseconds_time_utc() - start_time;
+        out << "batch_result: " << result.dump() << std::endl;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << boost::format("%1%: batch server stopped after %2% jobs") % __FUNCTION__ % job_count;
+    return job_count;
+}
+
+} // namespace Slic3r
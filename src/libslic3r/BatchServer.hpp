@@ -0,0 +1,39 @@
+#ifndef slic3r_BatchServer_hpp_
+#define slic3r_BatchServer_hpp_
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+
+// BBS: Job protocol of the CLI batch server.
+// Each line of the input is a job in json, for example:
+//  {"id": "job1", "input": "model.3mf", "plate": 1, "output_dir": "out", "export_3mf": "result.3mf",
+//   "settings": ["machine.json", "process.json"], "filaments": ["filament.json"], "overrides": {"layer_height": "0.16"}, "args": ["--min-save"]}
+// The jobs are run one by one and a line "batch_result: {...}" is written for each of them.
+// {"command": "quit"} or the end of the input stops the server.
+class BatchServer
+{
+public:
+    // Runs a single job given its command line arguments (without the program name), returns one of the CLI_* codes.
+    using JobRunner = std::function<int(const std::vector<std::string> &args)>;
+
+    explicit BatchServer(JobRunner runner) : m_runner(std::move(runner)) {}
+
+    // Runs the jobs read from in until the end of the input or a quit command.
+    // Returns the number of jobs run.
+    size_t run(std::istream &in, std::ostream &out);
+
+    // Translates a job line into the CLI arguments, throws nlohmann::json::exception on invalid input.
+    // Returns false for the quit command.
+    static bool job_arguments(const std::string &line, std::string &id, std::vector<std::string> &args);
+
+private:
+    JobRunner m_runner;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_BatchServer_hpp_
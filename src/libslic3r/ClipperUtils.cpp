@@ -2,6 +2,12 @@
 #include "Geometry.hpp"
 #include "ShortestPath.hpp"
 
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#include "clipper2/clipper.h"
+
 // #define CLIPPER_UTILS_DEBUG
 
 #ifdef CLIPPER_UTILS_DEBUG
@@ -60,6 +66,50 @@ namespace ClipperUtils {
 Points EmptyPathsProvider::s_empty_points;
 Points SinglePathProvider::s_end;
 
+// Backend in the low bits, BackendFixed set by the first clipping operation.
+static constexpr const int BackendFixed = 0x100;
+
+// Compiled-in default, which may be overridden by the SLIC3R_CLIPPER_BACKEND environment variable ("clipper" or "clipper2").
+static Backend initial_backend()
+{
+    if (const char *env = std::getenv("SLIC3R_CLIPPER_BACKEND")) {
+        if (strcmp(env, "clipper2") == 0)
+            return Backend::Clipper2;
+        if (strcmp(env, "clipper") == 0)
+            return Backend::Clipper;
+    }
+#ifdef SLIC3R_CLIPPER2_BACKEND
+    return Backend::Clipper2;
+#else
+    return Backend::Clipper;
+#endif
+}
+
+static std::atomic<int>& backend_state()
+{
+    static std::atomic<int> state { int(initial_backend()) };
+    return state;
+}
+
+bool set_backend(Backend backend)
+{
+    std::atomic<int> &state   = backend_state();
+    int               current = state.load(std::memory_order_relaxed);
+    while (! (current & BackendFixed))
+        if (state.compare_exchange_weak(current, int(backend), std::memory_order_relaxed))
+            return true;
+    return (current & ~BackendFixed) == int(backend);
+}
+
+Backend backend()
+{
+    std::atomic<int> &state   = backend_state();
+    int               current = state.load(std::memory_order_relaxed);
+    if (! (current & BackendFixed))
+        current = state.fetch_or(BackendFixed, std::memory_order_relaxed);
+    return Backend(current & ~BackendFixed);
+}
+
 // Clip source polygon to be used as a clipping polygon with a bouding box around the source (to be clipped) polygon.
 // Useful as an optimization for expensive ClipperLib operations, for example when clipping source polygons one by one
 // with a set of polygons covering the whole layer below.
@@ -267,28 +317,238 @@ bool has_duplicate_points(const ClipperLib::PolyTree &polytree)
 }
 #endif
 
+//BBS: Clipper2 backend of the boolean operations and of the polyline clipping.
+// Each thread keeps its own Clipper64 and conversion buffers, so that after the first few operations
+// the input paths are converted into already allocated Path64 vectors.
+struct Clipper2Scratch
+{
+    Clipper2Lib::Clipper64  clipper;
+    Clipper2Lib::Paths64    subject;
+    Clipper2Lib::Paths64    clip;
+    Clipper2Lib::Paths64    closed;
+    Clipper2Lib::Paths64    open;
+    Clipper2Lib::PolyTree64 polytree;
+
+    // Clipper64 keeps collinear vertices by default, ClipperLib removes them. Remove them as ClipperLib does,
+    // so that both backends produce the same contours.
+    Clipper2Scratch() { this->clipper.PreserveCollinear(false); }
+
+    // Don't let a single huge layer pin its buffers on a worker thread for the rest of the slicing.
+    static constexpr const size_t MaxRetainedPaths = 4096;
+
+    void trim()
+    {
+        this->clipper.Clear();
+        for (Clipper2Lib::Paths64 *paths : { &this->subject, &this->clip, &this->closed, &this->open })
+            if (paths->capacity() > MaxRetainedPaths)
+                Clipper2Lib::Paths64().swap(*paths);
+    }
+};
+
+static Clipper2Scratch& clipper2_scratch()
+{
+    static thread_local Clipper2Scratch scratch;
+    return scratch;
+}
+
+static inline Clipper2Lib::ClipType clipper2_clip_type(ClipperLib::ClipType clip_type)
+{
+    switch (clip_type) {
+    case ClipperLib::ctIntersection: return Clipper2Lib::ClipType::Intersection;
+    case ClipperLib::ctUnion:        return Clipper2Lib::ClipType::Union;
+    case ClipperLib::ctDifference:   return Clipper2Lib::ClipType::Difference;
+    default:                         return Clipper2Lib::ClipType::Xor;
+    }
+}
+
+static inline Clipper2Lib::FillRule clipper2_fill_rule(ClipperLib::PolyFillType fill_type)
+{
+    switch (fill_type) {
+    case ClipperLib::pftEvenOdd:  return Clipper2Lib::FillRule::EvenOdd;
+    case ClipperLib::pftNonZero:  return Clipper2Lib::FillRule::NonZero;
+    case ClipperLib::pftPositive: return Clipper2Lib::FillRule::Positive;
+    default:                      return Clipper2Lib::FillRule::Negative;
+    }
+}
+
+// Convert the paths into the scratch buffer, reusing the capacity of the Path64 vectors filled by the previous operations.
+template<typename PathsProvider>
+static void clipper2_load_paths(PathsProvider &&paths, Clipper2Lib::Paths64 &out)
+{
+    size_t cnt = 0;
+    for (const Points &path : paths) {
+        if (cnt == out.size())
+            out.emplace_back();
+        Clipper2Lib::Path64 &dst = out[cnt ++];
+        dst.clear();
+        dst.reserve(path.size());
+        for (const Point &pt : path)
+            dst.emplace_back(pt.x(), pt.y());
+    }
+    out.resize(cnt);
+}
+
+static inline Points clipper2_path_to_points(const Clipper2Lib::Path64 &path)
+{
+    Points out;
+    out.reserve(path.size());
+    for (const Clipper2Lib::Point64 &pt : path)
+        out.emplace_back(pt.x, pt.y);
+    return out;
+}
+
+static ClipperLib::Paths clipper2_to_paths(const Clipper2Lib::Paths64 &paths)
+{
+    ClipperLib::Paths out;
+    out.reserve(paths.size());
+    for (const Clipper2Lib::Path64 &path : paths)
+        out.emplace_back(clipper2_path_to_points(path));
+    return out;
+}
+
+static void clipper2_polytree_to_expolygons(const Clipper2Lib::PolyPath64 &node, ExPolygons &out)
+{
+    for (const auto &outer : node) {
+        const size_t idx = out.size();
+        out.emplace_back();
+        out[idx].contour.points = clipper2_path_to_points(outer->Polygon());
+        out[idx].holes.reserve(outer->Count());
+        for (const auto &hole : *outer)
+            out[idx].holes.emplace_back(clipper2_path_to_points(hole->Polygon()));
+        // Islands inside the holes.
+        for (const auto &hole : *outer)
+            clipper2_polytree_to_expolygons(*hole, out);
+    }
+}
+
+// Fill the scratch Clipper64 with the closed subject and clip paths.
+template<class TSubj, class TClip>
+static Clipper2Scratch& clipper2_load(TSubj &&subject, TClip &&clip, bool open_subject)
+{
+    Clipper2Scratch &scratch = clipper2_scratch();
+    clipper2_load_paths(std::forward<TSubj>(subject), scratch.subject);
+    clipper2_load_paths(std::forward<TClip>(clip), scratch.clip);
+    scratch.clipper.Clear();
+    if (open_subject)
+        scratch.clipper.AddOpenSubject(scratch.subject);
+    else
+        scratch.clipper.AddSubject(scratch.subject);
+    if (! scratch.clip.empty())
+        scratch.clipper.AddClip(scratch.clip);
+    return scratch;
+}
+
+template<class TSubj, class TClip>
+static ClipperLib::Paths clipper2_do(
+    const ClipperLib::ClipType     clipType,
+    TSubj &&                       subject,
+    TClip &&                       clip,
+    const ClipperLib::PolyFillType fillType)
+{
+    Clipper2Scratch &scratch = clipper2_load(std::forward<TSubj>(subject), std::forward<TClip>(clip), false);
+    scratch.clipper.Execute(clipper2_clip_type(clipType), clipper2_fill_rule(fillType), scratch.closed, scratch.open);
+    ClipperLib::Paths out = clipper2_to_paths(scratch.closed);
+    scratch.trim();
+    return out;
+}
+
+// Offset a single path with the semantics of ClipperLib::ClipperOffset, which carries local modifications:
+// vertices closer than ShortestEdgeLength to the previous vertex are dropped before the offset,
+// a closed path is reoriented to a positive area before being offsetted, thus the output contours are CCW.
+static void clipper2_offset_path(const Points &path, const double delta, ClipperLib::JoinType joinType, double miterLimit,
+    ClipperLib::EndType endType, const double shortestEdgeLength, ClipperLib::Paths &out)
+{
+    const bool      closed = endType == ClipperLib::etClosedPolygon || endType == ClipperLib::etClosedLine;
+    const double    shortest_edge_length2 = shortestEdgeLength * shortestEdgeLength;
+    auto            same = [shortest_edge_length2](const Point &p1, const Point &p2) {
+        return shortest_edge_length2 > 0. ? (p2 - p1).cast<double>().squaredNorm() < shortest_edge_length2 : p1 == p2;
+    };
+    size_t          last = path.size();
+    if (closed)
+        for (; last > 1 && same(path.front(), path[last - 1]); -- last) ;
+    Clipper2Scratch    &scratch = clipper2_scratch();
+    scratch.subject.resize(1);
+    Clipper2Lib::Path64 &src = scratch.subject.front();
+    src.clear();
+    for (size_t i = 0; i < last; ++ i)
+        if (src.empty() || ! same(Point(src.back().x, src.back().y), path[i]))
+            src.emplace_back(path[i].x(), path[i].y());
+    if (endType == ClipperLib::etClosedPolygon) {
+        if (src.size() < 3)
+            return;
+        if (Clipper2Lib::Area(src) < 0)
+            std::reverse(src.begin(), src.end());
+    }
+
+    Clipper2Lib::JoinType join_type = Clipper2Lib::JoinType::Square;
+    double                miter_limit = 2.;
+    // ClipperLib::ClipperOffset default arc tolerance, which it uses for the round ends even if the joins are not round.
+    double                arc_tolerance = 0.25;
+    switch (joinType) {
+    case ClipperLib::jtRound:
+        join_type = Clipper2Lib::JoinType::Round;
+        if (miterLimit > 0.)
+            arc_tolerance = miterLimit;
+        break;
+    case ClipperLib::jtMiter:
+        join_type = Clipper2Lib::JoinType::Miter;
+        // ClipperLib clamps the miter limit to 2 from below, Clipper2 to 1.
+        miter_limit = std::max(2., miterLimit);
+        break;
+    default: break;
+    }
+    // ClipperLib limits the arc tolerance to a quarter of the offset.
+    arc_tolerance = std::min(arc_tolerance, std::abs(delta) * 0.25);
+
+    Clipper2Lib::EndType end_type = Clipper2Lib::EndType::Polygon;
+    switch (endType) {
+    case ClipperLib::etClosedLine:  end_type = Clipper2Lib::EndType::Joined; break;
+    case ClipperLib::etOpenButt:    end_type = Clipper2Lib::EndType::Butt;   break;
+    case ClipperLib::etOpenSquare:  end_type = Clipper2Lib::EndType::Square; break;
+    case ClipperLib::etOpenRound:   end_type = Clipper2Lib::EndType::Round;  break;
+    default: break;
+    }
+
+    Clipper2Lib::ClipperOffset co(miter_limit, arc_tolerance);
+    co.AddPaths(scratch.subject, join_type, end_type);
+    co.Execute(delta, scratch.closed);
+    out = clipper2_to_paths(scratch.closed);
+    scratch.trim();
+}
+
+// Offset a single path by ClipperLib or by Clipper2 depending on the backend. See clipper2_offset_path() for the semantics.
+static ClipperLib::Paths offset_path(const Points &path, const double delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType endType)
+{
+    const double      shortest_edge_length = std::abs(delta * ClipperOffsetShortestEdgeFactor);
+    ClipperLib::Paths out;
+    if (ClipperUtils::backend() == ClipperUtils::Backend::Clipper2) {
+        clipper2_offset_path(path, delta, joinType, miterLimit, endType, shortest_edge_length, out);
+    } else {
+        ClipperLib::ClipperOffset co;
+        if (joinType == jtRound)
+            co.ArcTolerance = miterLimit;
+        else
+            co.MiterLimit = miterLimit;
+        co.ShortestEdgeLength = shortest_edge_length;
+        co.AddPath(path, joinType, endType);
+        co.Execute(out, delta);
+    }
+    return out;
+}
+
 // Offset CCW contours outside, CW contours (holes) inside.
 // Don't calculate union of the output paths.
 template<typename PathsProvider>
 static ClipperLib::Paths raw_offset(PathsProvider &&paths, float offset, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType endType = ClipperLib::etClosedPolygon)
 {
-    ClipperLib::ClipperOffset co;
     ClipperLib::Paths out;
     out.reserve(paths.size());
-    ClipperLib::Paths out_this;
-    if (joinType == jtRound)
-        co.ArcTolerance = miterLimit;
-    else
-        co.MiterLimit = miterLimit;
-    co.ShortestEdgeLength = std::abs(offset * ClipperOffsetShortestEdgeFactor);
     for (const ClipperLib::Path &path : paths) {
-        co.Clear();
         // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
         // contours will be CCW oriented even though the input paths are CW oriented.
         // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-        co.AddPath(path, joinType, endType);
         bool ccw = endType == ClipperLib::etClosedPolygon ? ClipperLib::Orientation(path) : true;
-        co.Execute(out_this, ccw ? offset : - offset);
+        ClipperLib::Paths out_this = offset_path(path, ccw ? offset : - offset, joinType, miterLimit, endType);
         if (! ccw) {
             // Reverse the resulting contours.
             for (ClipperLib::Path &path : out_this)
@@ -313,6 +573,9 @@ TResult clipper_do(
     TClip &&                       clip,
     const ClipperLib::PolyFillType fillType)
 {
+    if constexpr (std::is_same_v<TResult, ClipperLib::Paths>)
+        if (ClipperUtils::backend() == ClipperUtils::Backend::Clipper2)
+            return clipper2_do(clipType, std::forward<TSubj>(subject), std::forward<TClip>(clip), fillType);
     ClipperLib::Clipper clipper;
     clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
     clipper.AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
@@ -342,6 +605,9 @@ TResult clipper_union(
     // fillType pftNonZero and pftPositive "should" produce the same result for "normalized with implicit union" set of polygons
     const ClipperLib::PolyFillType fillType = ClipperLib::pftNonZero)
 {
+    if constexpr (std::is_same_v<TResult, ClipperLib::Paths>)
+        if (ClipperUtils::backend() == ClipperUtils::Backend::Clipper2)
+            return clipper2_do(ClipperLib::ctUnion, std::forward<TSubj>(subject), ClipperUtils::EmptyPathsProvider(), fillType);
     ClipperLib::Clipper clipper;
     clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
     TResult retval;
@@ -437,17 +703,7 @@ Polygons contour_to_polygons(const Polygons &polygons, const float line_width, C
 static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::Paths &out)
 {
     // 1) Offset the outer contour.
-    ClipperLib::Paths contours;
-    {
-        ClipperLib::ClipperOffset co;
-        if (joinType == jtRound)
-            co.ArcTolerance = miterLimit;
-        else
-            co.MiterLimit = miterLimit;
-        co.ShortestEdgeLength = double(std::abs(delta * ClipperOffsetShortestEdgeFactor));
-        co.AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
-        co.Execute(contours, delta);
-    }
+    ClipperLib::Paths contours = offset_path(expoly.contour.points, delta, joinType, miterLimit, ClipperLib::etClosedPolygon);
     if (contours.empty())
         // No need to try to offset the holes.
         return 0;
@@ -459,21 +715,11 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
         // 2) Offset the holes one by one, collect the offsetted holes.
         ClipperLib::Paths holes;
         {
-            for (const Polygon &hole : expoly.holes) {
-                ClipperLib::ClipperOffset co;
-                if (joinType == jtRound)
-                    co.ArcTolerance = miterLimit;
-                else
-                    co.MiterLimit = miterLimit;
-                co.ShortestEdgeLength = double(std::abs(delta * ClipperOffsetShortestEdgeFactor));
-                co.AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
-                ClipperLib::Paths out2;
+            for (const Polygon &hole : expoly.holes)
                 // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
                 // contours will be CCW oriented even though the input paths are CW oriented.
                 // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-                co.Execute(out2, - delta);
-                append(holes, std::move(out2));
-            }
+                append(holes, offset_path(hole.points, - delta, joinType, miterLimit, ClipperLib::etClosedPolygon));
         }
 
         // 3) Subtract holes from the contours.
@@ -666,6 +912,40 @@ inline ClipperLib::PolyTree clipper_do_polytree(
         clipper_do_polytree(clipType, std::forward<PathProvider1>(subject), std::forward<PathProvider2>(clip), fillType);
 }
 
+template<typename PathProvider1, typename PathProvider2>
+inline ExPolygons clipper_do_expolygons(
+    const ClipperLib::ClipType       clipType,
+    PathProvider1                  &&subject,
+    PathProvider2                  &&clip,
+    const ClipperLib::PolyFillType   fillType)
+{
+    if (ClipperUtils::backend() == ClipperUtils::Backend::Clipper2) {
+        // Clipper2 builds the hierarchy of the output polygons without the JoinCommonEdges() bottleneck,
+        // thus the workaround of clipper_do_polytree() is not needed.
+        Clipper2Scratch &scratch = clipper2_load(std::forward<PathProvider1>(subject), std::forward<PathProvider2>(clip), false);
+        ExPolygons out;
+        if (scratch.clipper.Execute(clipper2_clip_type(clipType), clipper2_fill_rule(fillType), scratch.polytree, scratch.open))
+            clipper2_polytree_to_expolygons(scratch.polytree, out);
+        scratch.polytree.Clear();
+        scratch.trim();
+        return out;
+    }
+    return PolyTreeToExPolygons(clipper_do_polytree(clipType, std::forward<PathProvider1>(subject), std::forward<PathProvider2>(clip), fillType));
+}
+template<typename PathProvider1, typename PathProvider2>
+inline ExPolygons clipper_do_expolygons(
+    const ClipperLib::ClipType       clipType,
+    PathProvider1                  &&subject,
+    PathProvider2                  &&clip,
+    const ClipperLib::PolyFillType   fillType,
+    const ApplySafetyOffset          do_safety_offset)
+{
+    assert(do_safety_offset == ApplySafetyOffset::No || clipType != ClipperLib::ctUnion);
+    return do_safety_offset == ApplySafetyOffset::Yes ?
+        clipper_do_expolygons(clipType, std::forward<PathProvider1>(subject), safety_offset(std::forward<PathProvider2>(clip)), fillType) :
+        clipper_do_expolygons(clipType, std::forward<PathProvider1>(subject), std::forward<PathProvider2>(clip), fillType);
+}
+
 template<class TSubj, class TClip>
 static inline Polygons _clipper(ClipperLib::ClipType clipType, TSubj &&subject, TClip &&clip, ApplySafetyOffset do_safety_offset)
 {
@@ -736,7 +1016,7 @@ Slic3r::Polygons union_(const Slic3r::Polygons &subject, const Slic3r::ExPolygon
     { return _clipper(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::ExPolygonProvider(subject2), ApplySafetyOffset::No); }
 template <typename TSubject, typename TClip>
 static ExPolygons _clipper_ex(ClipperLib::ClipType clipType, TSubject &&subject,  TClip &&clip, ApplySafetyOffset do_safety_offset, ClipperLib::PolyFillType fill_type = ClipperLib::pftNonZero)
-    { return PolyTreeToExPolygons(clipper_do_polytree(clipType, std::forward<TSubject>(subject), std::forward<TClip>(clip), fill_type, do_safety_offset)); }
+    { return clipper_do_expolygons(clipType, std::forward<TSubject>(subject), std::forward<TClip>(clip), fill_type, do_safety_offset); }
 
 Slic3r::ExPolygons diff_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset)
     { return _clipper_ex(ClipperLib::ctDifference, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), do_safety_offset); }
@@ -813,14 +1093,13 @@ Slic3r::ExPolygons intersection_ex(const Slic3r::SurfacesPtr &subject, const Sli
 Slic3r::ExPolygons union_ex(const Slic3r::Polygons &subject, ClipperLib::PolyFillType fill_type)
     { return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No, fill_type); }
 Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject)
-    { return PolyTreeToExPolygons(clipper_do_polytree(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ClipperLib::pftNonZero)); }
+    { return clipper_do_expolygons(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ClipperLib::pftNonZero); }
 Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject, const Slic3r::Polygons &subject2)
 {
-    return PolyTreeToExPolygons(
-        clipper_do_polytree(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PolygonsProvider(subject2), ClipperLib::pftNonZero));
+    return clipper_do_expolygons(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PolygonsProvider(subject2), ClipperLib::pftNonZero);
 }
     Slic3r::ExPolygons union_ex(const Slic3r::Surfaces &subject)
-    { return PolyTreeToExPolygons(clipper_do_polytree(ClipperLib::ctUnion, ClipperUtils::SurfacesProvider(subject), ClipperUtils::EmptyPathsProvider(), ClipperLib::pftNonZero)); }
+    { return clipper_do_expolygons(ClipperLib::ctUnion, ClipperUtils::SurfacesProvider(subject), ClipperUtils::EmptyPathsProvider(), ClipperLib::pftNonZero); }
 // BBS
 Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons& poly1, const Slic3r::ExPolygons& poly2, bool safety_offset_)
     {
@@ -840,6 +1119,16 @@ Slic3r::ExPolygons xor_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPol
 template<typename PathsProvider1, typename PathsProvider2>
 Polylines _clipper_pl_open(ClipperLib::ClipType clipType, PathsProvider1 &&subject, PathsProvider2 &&clip)
 {
+    if (ClipperUtils::backend() == ClipperUtils::Backend::Clipper2) {
+        Clipper2Scratch &scratch = clipper2_load(std::forward<PathsProvider1>(subject), std::forward<PathsProvider2>(clip), true);
+        scratch.clipper.Execute(clipper2_clip_type(clipType), Clipper2Lib::FillRule::NonZero, scratch.closed, scratch.open);
+        Polylines out;
+        out.reserve(scratch.open.size());
+        for (const Clipper2Lib::Path64 &path : scratch.open)
+            out.emplace_back(clipper2_path_to_points(path));
+        scratch.trim();
+        return out;
+    }
     ClipperLib::Clipper clipper;
     clipper.AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
     clipper.AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
@@ -49,6 +49,20 @@ enum class ApplySafetyOffset {
 };
 
 namespace ClipperUtils {
+    // Engine performing the boolean operations (union, difference, intersection, xor), the polyline clipping and the offsets.
+    // The default is Clipper2 when compiled with SLIC3R_CLIPPER2_BACKEND, ClipperLib otherwise,
+    // the SLIC3R_CLIPPER_BACKEND environment variable ("clipper" or "clipper2") overrides the default.
+    // The operations returning ClipperLib::PolyTree always run on ClipperLib.
+    enum class Backend {
+        Clipper,
+        Clipper2
+    };
+    // The backend is fixed by the first clipping operation of the process, so that all the layers and all the objects
+    // of a print are processed by the same engine. set_backend() is to be called at startup, it returns false
+    // if a different backend has already been fixed.
+    bool    set_backend(Backend backend);
+    Backend backend();
+
     class PathsProviderIteratorBase {
     public:
         using value_type        = Points;
@@ -35,11 +35,11 @@ public:
     std::pair<int, int> loop_node_range;
     ExtrusionEntityCollection(): no_sort(false) {}
     ExtrusionEntityCollection(const ExtrusionEntityCollection &other) : no_sort(other.no_sort), is_reverse(other.is_reverse), loop_node_range(other.loop_node_range) { this->append(other.entities); }
-    ExtrusionEntityCollection(ExtrusionEntityCollection &&other)
+    ExtrusionEntityCollection(ExtrusionEntityCollection &&other) noexcept
         : entities(std::move(other.entities)), no_sort(other.no_sort), is_reverse(other.is_reverse), loop_node_range(other.loop_node_range) {}
     explicit ExtrusionEntityCollection(const ExtrusionPaths &paths);
     ExtrusionEntityCollection& operator=(const ExtrusionEntityCollection &other);
-    ExtrusionEntityCollection& operator=(ExtrusionEntityCollection &&other)
+    ExtrusionEntityCollection& operator=(ExtrusionEntityCollection &&other) noexcept
     {
         this->entities = std::move(other.entities);
         this->no_sort  = other.no_sort;
@@ -12,6 +12,7 @@
 #include "../VariableWidth.hpp"
 
 #include "FillBase.hpp"
+#include "FillCache.hpp"
 #include "FillConcentric.hpp"
 #include "FillHoneycomb.hpp"
 #include "Fill3DHoneycomb.hpp"
@@ -127,7 +128,7 @@ void Fill::fill_surface_extrusion(const Surface* surface, const FillParams& para
         if (params.use_arachne)
             thick_polylines = this->fill_surface_arachne(surface, params);
         else
-            polylines = this->fill_surface(surface, params);
+            polylines = this->fill_cache ? this->fill_cache->fill_surface(*this, surface, params) : this->fill_surface(surface, params);
     }
     catch (InfillFailedException&) {}
 
@@ -23,6 +23,7 @@
 namespace Slic3r {
 
 class Surface;
+class FillCache;
 enum InfillPattern : int;
 
 namespace FillAdaptive {
@@ -120,6 +121,9 @@ public:
     // Octree builds on mesh for usage in the adaptive cubic infill
     FillAdaptive::Octree* adapt_fill_octree = nullptr;
 
+    // BBS: polylines shared by the layers of an object, only set for the patterns accepted by FillCache::is_cacheable()
+    FillCache*  fill_cache = nullptr;
+
     // BBS: all no overlap expolygons in same layer
     ExPolygons  no_overlap_expolygons;
 
@@ -162,6 +166,7 @@ public:
         loop_clipping         = f->loop_clipping;
         bounding_box          = f->bounding_box;
         adapt_fill_octree     = f->adapt_fill_octree;
+        fill_cache            = f->fill_cache;
         no_overlap_expolygons = f->no_overlap_expolygons;
     };
 
@@ -199,6 +204,8 @@ protected:
 
     virtual std::pair<float, Point> _infill_direction(const Surface *surface) const;
 
+    friend class FillCache;
+
 public:
     static void connect_infill(Polylines &&infill_ordered, const ExPolygon &boundary, Polylines &polylines_out, const double spacing, const FillParams &params);
     static void connect_infill(Polylines &&infill_ordered, const Polygons &boundary, const BoundingBox& bbox, Polylines &polylines_out, const double spacing, const FillParams &params);
@@ -0,0 +1,116 @@
+#include <numeric>
+
+#include <boost/functional/hash.hpp>
+
+#include "../PrintConfig.hpp"
+#include "../Surface.hpp"
+
+#include "FillBase.hpp"
+#include "FillCache.hpp"
+#include "FillRectilinear.hpp"
+
+namespace Slic3r {
+
+bool FillCache::is_cacheable(InfillPattern pattern)
+{
+    switch (pattern) {
+    case ipRectilinear:
+    case ipAlignedRectilinear:
+    case ipMonotonic:
+    case ipGrid:
+    case ipTriangles:
+    case ipStars:
+        return true;
+    default:
+        // Cubic depends on Z, the zig-zag patterns on the layer index, the other patterns are not rectilinear.
+        return false;
+    }
+}
+
+bool FillCache::Key::operator==(const Key &rhs) const
+{
+    return type == rhs.type && angle == rhs.angle && shift == rhs.shift && odd_layer == rhs.odd_layer &&
+           spacing == rhs.spacing && overlap == rhs.overlap && link_max_length == rhs.link_max_length &&
+           bounding_box.min == rhs.bounding_box.min && bounding_box.max == rhs.bounding_box.max && bounding_box.defined == rhs.bounding_box.defined &&
+           density == rhs.density && anchor_length == rhs.anchor_length && anchor_length_max == rhs.anchor_length_max &&
+           resolution == rhs.resolution && dont_adjust == rhs.dont_adjust && monotonic == rhs.monotonic && dont_sort == rhs.dont_sort;
+}
+
+size_t FillCache::Key::hash() const
+{
+    size_t seed = type.hash_code();
+    boost::hash_combine(seed, angle);
+    boost::hash_combine(seed, shift.x());
+    boost::hash_combine(seed, shift.y());
+    boost::hash_combine(seed, odd_layer);
+    boost::hash_combine(seed, spacing);
+    boost::hash_combine(seed, density);
+    return seed;
+}
+
+static size_t hash_expolygon(const ExPolygon &expolygon, size_t seed)
+{
+    auto hash_polygon = [&seed](const Polygon &polygon) {
+        boost::hash_combine(seed, polygon.size());
+        for (const Point &pt : polygon.points) {
+            boost::hash_combine(seed, pt.x());
+            boost::hash_combine(seed, pt.y());
+        }
+    };
+    hash_polygon(expolygon.contour);
+    for (const Polygon &hole : expolygon.holes)
+        hash_polygon(hole);
+    return seed;
+}
+
+Polylines FillCache::fill_surface(Fill &filler, const Surface *surface, const FillParams &params)
+{
+    Key key;
+    key.type              = std::type_index(typeid(filler));
+    std::tie(key.angle, key.shift) = filler._infill_direction(surface);
+    // FillGrid reverses its lines on odd layers.
+    key.odd_layer         = dynamic_cast<const FillGrid*>(&filler) != nullptr && (filler.layer_id & 1) == 1;
+    key.spacing           = filler.spacing;
+    key.overlap           = filler.overlap;
+    key.link_max_length   = filler.link_max_length;
+    key.bounding_box      = filler.bounding_box;
+    key.density           = params.density;
+    key.anchor_length     = params.anchor_length;
+    key.anchor_length_max = params.anchor_length_max;
+    key.resolution        = params.resolution;
+    key.dont_adjust       = params.dont_adjust;
+    key.monotonic         = params.monotonic;
+    key.dont_sort         = params.dont_sort;
+    const size_t hash     = hash_expolygon(surface->expolygon, key.hash());
+
+    m_lookups.fetch_add(1, std::memory_order_relaxed);
+    EntryPtr found;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_entries.find(hash); it != m_entries.end())
+            for (const EntryPtr &entry : it->second)
+                if (entry->key == key && entry->expolygon == surface->expolygon) {
+                    found = entry;
+                    break;
+                }
+    }
+    if (found) {
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        filler.spacing = found->spacing;
+        return found->polylines;
+    }
+
+    // Not found, do the sweep outside of the lock.
+    Polylines polylines = filler.fill_surface(surface, params);
+    size_t    num_points = std::accumulate(polylines.begin(), polylines.end(), size_t(0), [](size_t acc, const Polyline &pl) { return acc + pl.size(); });
+    if (num_points > 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_num_points + num_points <= max_points) {
+            m_num_points += num_points;
+            m_entries[hash].emplace_back(std::make_shared<const Entry>(Entry{ key, surface->expolygon, polylines, filler.spacing }));
+        }
+    }
+    return polylines;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,88 @@
+#ifndef slic3r_FillCache_hpp_
+#define slic3r_FillCache_hpp_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "../libslic3r.h"
+#include "../BoundingBox.hpp"
+#include "../ExPolygon.hpp"
+#include "../Polyline.hpp"
+
+namespace Slic3r {
+
+class Fill;
+struct FillParams;
+class Surface;
+enum InfillPattern : int;
+
+// BBS: Infill polylines shared by the layers of a single PrintObject.
+// Prismatic parts produce the very same fill region on many layers. The rectilinear family of infills
+// only depends on the region, the fill parameters and on the layer parity, thus the sweep is done once
+// for each distinct region and the result is copied into the other layers.
+// The regions are matched exactly, the hash is only used to find the candidates.
+// Thread safe, the layers of an object are filled in parallel.
+class FillCache
+{
+public:
+    // Only patterns, which do not depend on Z or on the layer index (except for its parity) may be cached.
+    static bool is_cacheable(InfillPattern pattern);
+
+    // Same as filler.fill_surface(surface, params), the result may be taken from the cache.
+    // filler.spacing is updated the same way the filler adjusts it.
+    Polylines   fill_surface(Fill &filler, const Surface *surface, const FillParams &params);
+
+    size_t      lookups() const { return m_lookups.load(std::memory_order_relaxed); }
+    size_t      hits()    const { return m_hits.load(std::memory_order_relaxed); }
+
+private:
+    // Everything besides the region the rectilinear fillers depend on.
+    struct Key
+    {
+        std::type_index type { typeid(void) };
+        float           angle { 0.f };
+        Point           shift;
+        bool            odd_layer { false };
+        double          spacing { 0. };
+        double          overlap { 0. };
+        coord_t         link_max_length { 0 };
+        BoundingBox     bounding_box;
+        float           density { 0.f };
+        float           anchor_length { 0.f };
+        float           anchor_length_max { 0.f };
+        double          resolution { 0. };
+        bool            dont_adjust { false };
+        bool            monotonic { false };
+        bool            dont_sort { false };
+
+        bool operator==(const Key &rhs) const;
+        size_t hash() const;
+    };
+
+    struct Entry
+    {
+        Key         key;
+        ExPolygon   expolygon;
+        Polylines   polylines;
+        // Spacing as adjusted by the filler.
+        double      spacing;
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    // Limit the memory consumed by the cached polylines of objects, which do not repeat their regions.
+    static constexpr size_t max_points = 4 * 1024 * 1024;
+
+    std::mutex                                          m_mutex;
+    std::unordered_map<size_t, std::vector<EntryPtr>>   m_entries;
+    size_t                                              m_num_points { 0 };
+    std::atomic<size_t>                                 m_lookups { 0 };
+    std::atomic<size_t>                                 m_hits { 0 };
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_FillCache_hpp_
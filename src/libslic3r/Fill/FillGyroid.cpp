@@ -29,6 +29,7 @@ static inline double f(double x, double z_sin, double z_cos, bool vertical, bool
     }
 }
 
+// The wave runs along the Y axis of the returned polyline.
 static inline Polyline make_wave(
     const std::vector<Vec2d>& one_period, double width, double height, double offset, double scaleFactor,
     double z_cos, double z_sin, bool vertical, bool flip)
@@ -54,8 +55,7 @@ static inline Polyline make_wave(
     for (auto& point : points) {
         point(1) += offset;
         point(1) = std::clamp(double(point.y()), 0., height);
-        if (vertical)
-            std::swap(point(0), point(1));
+        std::swap(point(0), point(1));
         polyline.points.emplace_back((point * scaleFactor).cast<coord_t>());
     }
 
@@ -102,7 +102,9 @@ static std::vector<Vec2d> make_one_period(double width, double scaleFactor, doub
     return points;
 }
 
-static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height)
+// Generate the waves covering a width x height rectangle. The waves are returned running along the Y axis,
+// horizontal waves are returned transposed (X and Y swapped), which is indicated by the transposed flag.
+static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height, bool &transposed)
 {
     const double scaleFactor = scale_(line_spacing) / density_adjusted;
 
@@ -126,6 +128,7 @@ static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double
         upper_bound = width - M_PI_2;
         std::swap(width,height);
     }
+    transposed = ! vertical;
 
     std::vector<Vec2d> one_period_odd = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance); // creates one period of the waves, so it doesn't have to be recalculated all the time
     flip = !flip;                                                                   // even polylines are a bit shifted
@@ -145,6 +148,31 @@ static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double
     return result;
 }
 
+static inline void transpose(Points &points)
+{
+    for (Point &pt : points)
+        std::swap(pt.x(), pt.y());
+}
+
+// BBS: Clip the waves running along the Y axis with the expolygon. Clipper sweeps along the Y axis, thus such a wave is
+// a single monotonous bound of the sweep, while a wave running along the X axis is crossed by the scanlines at all its periods.
+// Clipping batches of neighbour waves with the expolygon cropped to the batch further limits the number of edges active in the sweep.
+static Polylines clip_waves(Polylines &&waves, const ExPolygon &expolygon)
+{
+    static constexpr const size_t batch_size = 16;
+    Polylines out;
+    Polylines batch;
+    for (size_t i = 0; i < waves.size(); i += batch_size) {
+        batch.assign(std::make_move_iterator(waves.begin() + i), std::make_move_iterator(waves.begin() + std::min(waves.size(), i + batch_size)));
+        BoundingBox bbox = get_extents(batch);
+        bbox.offset(SCALED_EPSILON);
+        Polygons clip = ClipperUtils::clip_clipper_polygons_with_subject_bbox(expolygon, bbox);
+        if (! clip.empty())
+            append(out, intersection_pl(batch, clip));
+    }
+    return out;
+}
+
 // FIXME: needed to fix build on Mac on buildserver
 constexpr double FillGyroid::PatternTolerance;
 
@@ -169,18 +197,37 @@ void FillGyroid::_fill_surface_single(
     bb.merge(align_to_grid(bb.min, Point(2*M_PI*distance, 2*M_PI*distance)));
 
     // generate pattern
-    Polylines polylines = make_gyroid_waves(
+    bool      transposed = false;
+    Polylines polylines  = make_gyroid_waves(
         scale_(this->z),
         density_adjusted,
         this->spacing,
         ceil(bb.size()(0) / distance) + 1.,
-        ceil(bb.size()(1) / distance) + 1.);
-
-	// shift the polyline to the grid origin
-	for (Polyline &pl : polylines)
-		pl.translate(bb.min);
+        ceil(bb.size()(1) / distance) + 1.,
+        transposed);
 
-	polylines = intersection_pl(polylines, expolygon);
+    if (transposed) {
+        // BBS: Horizontal waves are clipped in the transposed space, where they run along the Y axis.
+        const Point origin(bb.min.y(), bb.min.x());
+        for (Polyline &pl : polylines)
+            pl.translate(origin);
+        ExPolygon expolygon_transposed = expolygon;
+        // Transposition mirrors the polygons, restore their orientation.
+        transpose(expolygon_transposed.contour.points);
+        expolygon_transposed.contour.reverse();
+        for (Polygon &hole : expolygon_transposed.holes) {
+            transpose(hole.points);
+            hole.reverse();
+        }
+        polylines = clip_waves(std::move(polylines), expolygon_transposed);
+        for (Polyline &pl : polylines)
+            transpose(pl.points);
+    } else {
+        // shift the polyline to the grid origin
+        for (Polyline &pl : polylines)
+            pl.translate(bb.min);
+        polylines = clip_waves(std::move(polylines), expolygon);
+    }
 
     if (! polylines.empty()) {
 		// Remove very small bits, but be careful to not remove infill lines connecting thin walls!
@@ -14,8 +14,12 @@
 
 #include "bbs_3mf.hpp"
 
+#include <atomic>
+#include <charconv>
 #include <limits>
+#include <memory>
 #include <stdexcept>
+#include <string_view>
 #include <iomanip>
 
 #include <boost/assign.hpp>
@@ -509,7 +513,7 @@ Slic3r::Vec3f get_vec3_from_string(const std::string &pos_str)
         return pos;
 
     for (int i = 0; i < 3; ++i)
-        pos(i) = ::atof(values[i].c_str());
+        pos(i) = float(Slic3r::string_to_double_decimal_point(values[i]));
 
     return pos;
 }
@@ -537,7 +541,7 @@ Slic3r::Transform3d bbs_get_transform_from_3mf_specs_string(const std::string& m
     // we need to transpose them
     for (unsigned int c = 0; c < 4; ++c) {
         for (unsigned int r = 0; r < 3; ++r) {
-            ret(r, c) = ::atof(mat_elements_str[i++].c_str());
+            ret(r, c) = Slic3r::string_to_double_decimal_point(mat_elements_str[i++]);
         }
     }
     return ret;
@@ -560,7 +564,7 @@ Slic3r::Vec3d bbs_get_offset_from_3mf_specs_string(const std::string& vec_str)
         return ofs2ass;
 
     for (unsigned int i = 0; i < 3; i++) {
-        ofs2ass(i) = ::atof(vec_elements_str[i].c_str());
+        ofs2ass(i) = Slic3r::string_to_double_decimal_point(vec_elements_str[i]);
     }
 
     return ofs2ass;
@@ -585,6 +589,383 @@ float bbs_get_unit_factor(const std::string& unit)
         return 1.0f;
 }
 
+//BBS: fast path of the mesh geometry of the model files.
+// The <vertices> and <triangles> blocks hold nearly all the data of a model file, they are parsed here directly from
+// the inflated buffer, large blocks in parallel chunks. Expat only parses the rest of the file with the content of these blocks removed,
+// the parsed geometry is picked up in the order of the blocks by the end element handlers.
+struct BBS3MFVerticesBlock
+{
+    std::vector<Slic3r::Vec3f> vertices;
+
+    void append(BBS3MFVerticesBlock &&other) { vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end()); }
+};
+
+struct BBS3MFTrianglesBlock
+{
+    std::vector<Slic3r::Vec3i>       triangles;
+    std::vector<std::string> custom_supports;
+    std::vector<std::string> custom_fuzzy_skin;
+    std::vector<std::string> custom_seam;
+    std::vector<std::string> mmu_segmentation;
+    std::vector<std::string> face_properties;
+
+    void append(BBS3MFTrianglesBlock &&other)
+    {
+        triangles.insert(triangles.end(), other.triangles.begin(), other.triangles.end());
+        bbs_append_moved(custom_supports, other.custom_supports);
+        bbs_append_moved(custom_fuzzy_skin, other.custom_fuzzy_skin);
+        bbs_append_moved(custom_seam, other.custom_seam);
+        bbs_append_moved(mmu_segmentation, other.mmu_segmentation);
+        bbs_append_moved(face_properties, other.face_properties);
+    }
+
+    static void bbs_append_moved(std::vector<std::string> &dst, std::vector<std::string> &src)
+    {
+        if (dst.empty())
+            dst = std::move(src);
+        else
+            dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+    }
+};
+
+struct BBS3MFMeshBlocks
+{
+    std::vector<BBS3MFVerticesBlock>  vertices;
+    std::vector<BBS3MFTrianglesBlock> triangles;
+    size_t                            next_vertices { 0 };
+    size_t                            next_triangles { 0 };
+
+    BBS3MFVerticesBlock*  pop_vertices()  { return next_vertices < vertices.size() ? &vertices[next_vertices ++] : nullptr; }
+    BBS3MFTrianglesBlock* pop_triangles() { return next_triangles < triangles.size() ? &triangles[next_triangles ++] : nullptr; }
+};
+
+// Scanner of the self closing elements of a mesh block, anything unusual (comments, entities, nested or not self closing elements)
+// is reported as a failure and the whole file is parsed by expat instead.
+class BBS3MFMeshScanner
+{
+public:
+    BBS3MFMeshScanner(const char *begin, const char *end) : m_ptr(begin), m_end(end) {}
+
+    bool failed() const { return m_failed; }
+
+    // Consumes "<tag", returns false at the end of the block or on failure.
+    bool start_element(std::string_view tag)
+    {
+        skip_whitespaces();
+        if (m_ptr == m_end)
+            return false;
+        if (size_t(m_end - m_ptr) <= tag.size() + 1 || m_ptr[0] != '<' || std::string_view(m_ptr + 1, tag.size()) != tag ||
+            (!is_whitespace(m_ptr[tag.size() + 1]) && m_ptr[tag.size() + 1] != '/'))
+            return fail();
+        m_ptr += tag.size() + 1;
+        return true;
+    }
+
+    // Consumes the next attribute, returns false at the end of the element "/>" or on failure.
+    bool next_attribute(std::string_view &name, std::string_view &value)
+    {
+        skip_whitespaces();
+        if (m_ptr == m_end)
+            return fail();
+        if (*m_ptr == '/') {
+            if (m_end - m_ptr < 2 || m_ptr[1] != '>')
+                return fail();
+            m_ptr += 2;
+            return false;
+        }
+        const char *name_begin = m_ptr;
+        while (m_ptr < m_end && *m_ptr != '=' && *m_ptr != '/' && *m_ptr != '>' && !is_whitespace(*m_ptr))
+            ++ m_ptr;
+        name = std::string_view(name_begin, m_ptr - name_begin);
+        skip_whitespaces();
+        if (name.empty() || m_ptr == m_end || *m_ptr != '=')
+            return fail();
+        ++ m_ptr;
+        skip_whitespaces();
+        if (m_ptr == m_end || (*m_ptr != '"' && *m_ptr != '\''))
+            return fail();
+        const char  quote       = *m_ptr ++;
+        const char *value_begin = m_ptr;
+        while (m_ptr < m_end && *m_ptr != quote) {
+            // entities and markup in the values are left to expat
+            if (*m_ptr == '&' || *m_ptr == '<')
+                return fail();
+            ++ m_ptr;
+        }
+        if (m_ptr == m_end)
+            return fail();
+        value = std::string_view(value_begin, m_ptr - value_begin);
+        ++ m_ptr;
+        return true;
+    }
+
+private:
+    static bool is_whitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+    void skip_whitespaces() { while (m_ptr < m_end && is_whitespace(*m_ptr)) ++ m_ptr; }
+    bool fail() { m_failed = true; return false; }
+
+    const char *m_ptr;
+    const char *m_end;
+    bool        m_failed { false };
+};
+
+// The number parsers fail on a malformed or partially parsed value, the whole model file is then left to expat,
+// so that such a file is imported (or rejected) exactly as by the expat handlers.
+static bool bbs_parse_float(std::string_view value, float &result)
+{
+    const char *end = value.data() + value.size();
+    auto [ptr, ec] = fast_float::from_chars(value.data(), end, result);
+    return ec == std::errc() && ptr == end;
+}
+
+static bool bbs_parse_int(std::string_view value, int &result)
+{
+    if (!value.empty() && value.front() == '+')
+        value.remove_prefix(1);
+    const char *end = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(value.data(), end, result);
+    return ec == std::errc() && ptr == end;
+}
+
+static bool bbs_parse_vertex_elements(const char *begin, const char *end, BBS3MFVerticesBlock &block)
+{
+    BBS3MFMeshScanner scanner(begin, end);
+    std::string_view  name, value;
+    block.vertices.reserve((end - begin) / 48);
+    while (scanner.start_element(VERTEX_TAG)) {
+        Slic3r::Vec3f vertex = Slic3r::Vec3f::Zero();
+        while (scanner.next_attribute(name, value)) {
+            if (name.size() == 1 && name[0] >= 'x' && name[0] <= 'z' && !bbs_parse_float(value, vertex(name[0] - 'x')))
+                return false;
+        }
+        if (scanner.failed())
+            return false;
+        block.vertices.emplace_back(vertex);
+    }
+    return !scanner.failed();
+}
+
+static bool bbs_parse_triangle_elements(const char *begin, const char *end, BBS3MFTrianglesBlock &block)
+{
+    BBS3MFMeshScanner scanner(begin, end);
+    std::string_view  name, value;
+    block.triangles.reserve((end - begin) / 32);
+    while (scanner.start_element(TRIANGLE_TAG)) {
+        Slic3r::Vec3i       triangle = Slic3r::Vec3i::Zero();
+        std::string custom_supports, custom_fuzzy_skin, custom_seam, mmu_segmentation, face_property;
+        while (scanner.next_attribute(name, value)) {
+            if (name == V1_ATTR || name == V2_ATTR || name == V3_ATTR) {
+                if (!bbs_parse_int(value, triangle(name[1] - '1')))
+                    return false;
+            }
+            else if (name == CUSTOM_SUPPORTS_ATTR)
+                custom_supports = value;
+            else if (name == CUSTOM_FUZZY_SKIN_ATTR)
+                custom_fuzzy_skin = value;
+            else if (name == CUSTOM_SEAM_ATTR)
+                custom_seam = value;
+            else if (name == MMU_SEGMENTATION_ATTR)
+                mmu_segmentation = value;
+            else if (name == FACE_PROPERTY_ATTR)
+                face_property = value;
+        }
+        if (scanner.failed())
+            return false;
+        block.triangles.emplace_back(triangle);
+        block.custom_supports.emplace_back(std::move(custom_supports));
+        block.custom_fuzzy_skin.emplace_back(std::move(custom_fuzzy_skin));
+        block.custom_seam.emplace_back(std::move(custom_seam));
+        block.mmu_segmentation.emplace_back(std::move(mmu_segmentation));
+        block.face_properties.emplace_back(std::move(face_property));
+    }
+    return !scanner.failed();
+}
+
+// Parses a block in parallel chunks split at the element boundaries, '<' does not appear inside the attribute values.
+template<typename Block, typename ParseFn>
+static bool bbs_parse_mesh_block(const char *begin, const char *end, Block &block, ParseFn parse)
+{
+    static constexpr size_t chunk_size   = 1 << 20;
+    const size_t            chunks_count = size_t(end - begin) / chunk_size + 1;
+    if (chunks_count == 1)
+        return parse(begin, end, block);
+
+    std::vector<const char*> bounds(chunks_count + 1, end);
+    bounds.front() = begin;
+    for (size_t i = 1; i < chunks_count; ++ i) {
+        const char *split = std::max(begin + i * size_t(end - begin) / chunks_count, bounds[i - 1]);
+        const char *next  = (const char*)::memchr(split, '<', end - split);
+        bounds[i] = (next != nullptr) ? next : end;
+    }
+    std::vector<Block> chunks(chunks_count);
+    std::atomic<bool>  succeeded { true };
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks_count), [&bounds, &chunks, &succeeded, &parse](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            if (!parse(bounds[i], bounds[i + 1], chunks[i]))
+                succeeded = false;
+    });
+    if (!succeeded)
+        return false;
+    block = std::move(chunks.front());
+    for (size_t i = 1; i < chunks_count; ++ i)
+        block.append(std::move(chunks[i]));
+    return true;
+}
+
+// Inflates a model file into xml in pieces of bounded size. The content of its mesh blocks is parsed piece by piece by the fast path
+// and left out of xml, the parsed geometry is returned in mesh_blocks. If any content is not supported by the fast path,
+// the whole model file is inflated into xml for expat and mesh_blocks is null.
+static bool bbs_extract_model_xml(mz_zip_archive &archive, const mz_zip_archive_file_stat &stat, std::string &xml, std::unique_ptr<BBS3MFMeshBlocks> &mesh_blocks)
+{
+    // Inflated bytes kept in memory: one piece and the unfinished element of the previous piece.
+    static constexpr size_t piece_size = 1 << 24;
+    // Bytes after '<' needed to recognize a comment, a CDATA section or the name of a mesh block.
+    const size_t lookahead = std::max<size_t>(::strlen("<![CDATA["), ::strlen("<") + std::max(::strlen(VERTICES_TAG), ::strlen(TRIANGLES_TAG)) + 1);
+
+    mesh_blocks.reset();
+    xml.clear();
+
+    mz_zip_reader_extract_iter_state *iter = mz_zip_reader_extract_iter_new(&archive, stat.m_file_index, 0);
+    if (iter == nullptr)
+        return false;
+
+    enum class BlockType { None, Vertices, Triangles };
+    auto        blocks     = std::make_unique<BBS3MFMeshBlocks>();
+    BlockType   block_type = BlockType::None;
+    std::string close_tag;
+    std::string buffer;
+    size_t      pos       = 0;
+    bool        eof       = false;
+    bool        supported = true;
+    // Parses the complete elements of the open mesh block in [begin, end) and appends them to the block.
+    auto parse_block = [&blocks, &block_type](const char *begin, const char *end) {
+        if (block_type == BlockType::Triangles) {
+            BBS3MFTrianglesBlock block;
+            if (!bbs_parse_mesh_block(begin, end, block, bbs_parse_triangle_elements))
+                return false;
+            blocks->triangles.back().append(std::move(block));
+        } else {
+            BBS3MFVerticesBlock block;
+            if (!bbs_parse_mesh_block(begin, end, block, bbs_parse_vertex_elements))
+                return false;
+            blocks->vertices.back().append(std::move(block));
+        }
+        return true;
+    };
+
+    while (supported && !eof) {
+        // keep the unconsumed tail of the previous piece and inflate the next piece after it
+        buffer.erase(0, pos);
+        pos = 0;
+        const size_t tail = buffer.size();
+        buffer.resize(tail + piece_size);
+        const size_t read = mz_zip_reader_extract_iter_read(iter, buffer.data() + tail, piece_size);
+        buffer.resize(tail + read);
+        eof = read < piece_size;
+
+        const std::string_view data(buffer);
+        while (supported) {
+            if (block_type != BlockType::None) {
+                const size_t close = data.find(close_tag, pos);
+                if (close != std::string_view::npos) {
+                    supported  = parse_block(buffer.data() + pos, buffer.data() + close);
+                    pos        = close;
+                    block_type = BlockType::None;
+                    continue;
+                }
+                if (eof) {
+                    supported = false;
+                    break;
+                }
+                // the element after the last '<' may continue in the next piece
+                const size_t last = data.rfind('<');
+                if (last != std::string_view::npos && last > pos) {
+                    supported = parse_block(buffer.data() + pos, buffer.data() + last);
+                    pos       = last;
+                }
+                break;
+            }
+
+            const size_t lt = data.find('<', pos);
+            if (lt == std::string_view::npos || (!eof && data.size() - lt < lookahead)) {
+                // the tag may continue in the next piece
+                const size_t keep = (lt == std::string_view::npos) ? data.size() : lt;
+                xml.append(data.substr(pos, keep - pos));
+                pos = keep;
+                break;
+            }
+            // comments or CDATA sections may hide anything, leave them to expat
+            if (data.compare(lt, 4, "<!--") == 0 || data.compare(lt, 9, "<![CDATA[") == 0) {
+                supported = false;
+                break;
+            }
+            std::string_view tag;
+            if (data.compare(lt + 1, ::strlen(VERTICES_TAG), VERTICES_TAG) == 0)
+                tag = VERTICES_TAG;
+            else if (data.compare(lt + 1, ::strlen(TRIANGLES_TAG), TRIANGLES_TAG) == 0)
+                tag = TRIANGLES_TAG;
+            const size_t name_end = lt + 1 + tag.size();
+            if (tag.empty() || name_end >= data.size() || (data[name_end] != '>' && data[name_end] != '/' && !std::isspace((unsigned char)data[name_end]))) {
+                xml.append(data.substr(pos, lt + 1 - pos));
+                pos = lt + 1;
+                continue;
+            }
+            const size_t open_end = data.find('>', name_end);
+            if (open_end == std::string_view::npos) {
+                if (eof)
+                    supported = false;
+                else {
+                    xml.append(data.substr(pos, lt - pos));
+                    pos = lt;
+                }
+                break;
+            }
+            xml.append(data.substr(pos, open_end + 1 - pos));
+            pos = open_end + 1;
+            if (tag == TRIANGLES_TAG)
+                blocks->triangles.emplace_back();
+            else
+                blocks->vertices.emplace_back();
+            // an empty self closing block has no content
+            if (data[open_end - 1] != '/') {
+                block_type = (tag == TRIANGLES_TAG) ? BlockType::Triangles : BlockType::Vertices;
+                close_tag  = "</" + std::string(tag);
+            }
+        }
+    }
+
+    // the extraction stopped early on unsupported content is reported as failed
+    const bool extracted = mz_zip_reader_extract_iter_free(iter);
+    if (supported && !extracted)
+        return false;
+
+    if (!supported) {
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": unsupported mesh content in %1%, parse it by expat") % stat.m_filename;
+        xml.assign((size_t)stat.m_uncomp_size, 0);
+        return mz_zip_reader_extract_to_mem(&archive, stat.m_file_index, xml.data(), xml.size(), 0);
+    }
+    if (!blocks->vertices.empty() || !blocks->triangles.empty())
+        mesh_blocks = std::move(blocks);
+    return true;
+}
+
+// Parses the xml in pieces, XML_Parse() takes an int length.
+template<typename HasErrorFn, typename ErrorMessageFn>
+static void bbs_parse_model_xml(XML_Parser parser, const std::string &xml, const char *filename, HasErrorFn has_error, ErrorMessageFn error_message)
+{
+    static constexpr size_t piece_size = 1 << 26;
+    size_t offset = 0;
+    do {
+        const size_t size = std::min(xml.size() - offset, piece_size);
+        if (!XML_Parse(parser, xml.data() + offset, (int)size, (offset + size == xml.size()) ? 1 : 0) || has_error()) {
+            char error_buf[1024];
+            ::snprintf(error_buf, 1024, "Error (%s) while parsing '%s' at line %d", error_message(), filename, (int)XML_GetCurrentLineNumber(parser));
+            throw Slic3r::FileIOError(error_buf);
+        }
+        offset += size;
+    } while (offset < xml.size());
+}
+
 bool bbs_is_valid_object_type(const std::string& type)
 {
     // if the type is empty defaults to "model" (see specification)
@@ -715,6 +1096,25 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
             }
         };
 
+        // Same as the per element handlers: the vertices are scaled by the unit factor, the triangle attributes are appended.
+        static void bbs_apply_vertices_block(BBS3MFVerticesBlock &block, float unit_factor, Geometry &geometry)
+        {
+            geometry.vertices = std::move(block.vertices);
+            if (unit_factor != 1.f)
+                for (Vec3f &vertex : geometry.vertices)
+                    vertex *= unit_factor;
+        }
+
+        static void bbs_apply_triangles_block(BBS3MFTrianglesBlock &block, Geometry &geometry)
+        {
+            geometry.triangles = std::move(block.triangles);
+            BBS3MFTrianglesBlock::bbs_append_moved(geometry.custom_supports, block.custom_supports);
+            BBS3MFTrianglesBlock::bbs_append_moved(geometry.custom_fuzzy_skin, block.custom_fuzzy_skin);
+            BBS3MFTrianglesBlock::bbs_append_moved(geometry.custom_seam, block.custom_seam);
+            BBS3MFTrianglesBlock::bbs_append_moved(geometry.mmu_segmentation, block.mmu_segmentation);
+            BBS3MFTrianglesBlock::bbs_append_moved(geometry.face_properties, block.face_properties);
+        }
+
         struct CurrentObject
         {
             // ID of the object inside the 3MF file, 1 based.
@@ -868,6 +1268,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
             std::string obj_curr_metadata_name;
             std::string obj_curr_characters;
             float object_unit_factor;
+            std::unique_ptr<BBS3MFMeshBlocks> object_mesh_blocks;
             int object_current_color_group{-1};
             std::map<int, std::string> object_group_id_to_color;
             bool is_bbl_3mf { false };
@@ -1031,6 +1432,8 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         std::string m_parse_error_message;
         Model* m_model;
         float m_unit_factor;
+        // mesh geometry of the model file being parsed, pre-parsed by the fast path
+        std::unique_ptr<BBS3MFMeshBlocks> m_mesh_blocks;
         CurrentObject* m_curr_object{nullptr};
         IdToCurrentObjectMap m_current_objects;
         IndexToPathMap       m_index_paths;
@@ -2406,48 +2809,29 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         XML_SetElementHandler(m_xml_parser, _BBS_3MF_Importer::_handle_start_model_xml_element, _BBS_3MF_Importer::_handle_end_model_xml_element);
         XML_SetCharacterDataHandler(m_xml_parser, _BBS_3MF_Importer::_handle_xml_characters);
 
-        struct CallbackData
-        {
-            XML_Parser& parser;
-            _BBS_3MF_Importer& importer;
-            const mz_zip_archive_file_stat& stat;
-
-            CallbackData(XML_Parser& parser, _BBS_3MF_Importer& importer, const mz_zip_archive_file_stat& stat) : parser(parser), importer(importer), stat(stat) {}
-        };
-
-        CallbackData data(m_xml_parser, *this, stat);
-
-        mz_bool res = 0;
+        std::string xml;
+        if (!bbs_extract_model_xml(archive, stat, xml, m_mesh_blocks)) {
+            add_error("Error while extracting model data from zip archive");
+            return false;
+        }
 
         try
         {
-            mz_file_write_func callback = [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
-                CallbackData* data = (CallbackData*)pOpaque;
-                if (!XML_Parse(data->parser, (const char*)pBuf, (int)n, (file_ofs + n == data->stat.m_uncomp_size) ? 1 : 0) || data->importer.parse_error()) {
-                    char error_buf[1024];
-                    ::snprintf(error_buf, 1024, "Error (%s) while parsing '%s' at line %d", data->importer.parse_error_message(), data->stat.m_filename, (int)XML_GetCurrentLineNumber(data->parser));
-                    throw Slic3r::FileIOError(error_buf);
-                }
-                return n;
-            };
-            void* opaque = &data;
-            res = mz_zip_reader_extract_to_callback(&archive, stat.m_file_index, callback, opaque, 0);
+            bbs_parse_model_xml(m_xml_parser, xml, stat.m_filename, [this]() { return parse_error(); }, [this]() { return parse_error_message(); });
         }
         catch (const version_error& e)
         {
             // rethrow the exception
+            m_mesh_blocks.reset();
             throw Slic3r::FileIOError(e.what());
         }
         catch (std::exception& e)
         {
+            m_mesh_blocks.reset();
             add_error(e.what());
             return false;
         }
-
-        if (res == 0) {
-            add_error("Error while extracting model data from zip archive");
-            return false;
-        }
+        m_mesh_blocks.reset();
 
         return true;
     }
@@ -3588,7 +3972,14 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
     bool _BBS_3MF_Importer::_handle_end_vertices()
     {
-        // do nothing
+        if (m_mesh_blocks) {
+            // expat only saw an empty block, pick up the vertices parsed by the fast path
+            BBS3MFVerticesBlock *block = m_mesh_blocks->pop_vertices();
+            if (block == nullptr)
+                return false;
+            if (m_curr_object)
+                bbs_apply_vertices_block(*block, m_unit_factor, m_curr_object->geometry);
+        }
         return true;
     }
 
@@ -3620,7 +4011,14 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
     bool _BBS_3MF_Importer::_handle_end_triangles()
     {
-        // do nothing
+        if (m_mesh_blocks) {
+            // expat only saw an empty block, pick up the triangles parsed by the fast path
+            BBS3MFTrianglesBlock *block = m_mesh_blocks->pop_triangles();
+            if (block == nullptr)
+                return false;
+            if (m_curr_object)
+                bbs_apply_triangles_block(*block, m_curr_object->geometry);
+        }
         return true;
     }
 
@@ -5219,7 +5617,14 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
     bool _BBS_3MF_Importer::ObjectImporter::_handle_object_end_vertices()
     {
-        // do nothing
+        if (object_mesh_blocks) {
+            // expat only saw an empty block, pick up the vertices parsed by the fast path
+            BBS3MFVerticesBlock *block = object_mesh_blocks->pop_vertices();
+            if (block == nullptr)
+                return false;
+            if (current_object)
+                bbs_apply_vertices_block(*block, object_unit_factor, current_object->geometry);
+        }
         return true;
     }
 
@@ -5251,7 +5656,14 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
     bool _BBS_3MF_Importer::ObjectImporter::_handle_object_end_triangles()
     {
-        // do nothing
+        if (object_mesh_blocks) {
+            // expat only saw an empty block, pick up the triangles parsed by the fast path
+            BBS3MFTrianglesBlock *block = object_mesh_blocks->pop_triangles();
+            if (block == nullptr)
+                return false;
+            if (current_object)
+                bbs_apply_triangles_block(*block, current_object->geometry);
+        }
         return true;
     }
 
@@ -5470,50 +5882,31 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         XML_SetElementHandler(object_xml_parser, _BBS_3MF_Importer::ObjectImporter::_handle_object_start_model_xml_element, _BBS_3MF_Importer::ObjectImporter::_handle_object_end_model_xml_element);
         XML_SetCharacterDataHandler(object_xml_parser, _BBS_3MF_Importer::ObjectImporter::_handle_object_xml_characters);
 
-        struct CallbackData
-        {
-            XML_Parser& parser;
-            _BBS_3MF_Importer::ObjectImporter& importer;
-            const mz_zip_archive_file_stat& stat;
-
-            CallbackData(XML_Parser& parser, _BBS_3MF_Importer::ObjectImporter& importer, const mz_zip_archive_file_stat& stat) : parser(parser), importer(importer), stat(stat) {}
-        };
-
-        CallbackData data(object_xml_parser, *this, stat);
-
-        mz_bool res = 0;
+        std::string xml;
+        if (!bbs_extract_model_xml(archive, stat, xml, object_mesh_blocks)) {
+            top_importer->add_error("Error while extracting model data from zip archive for "+object_path);
+            return false;
+        }
 
         try
         {
-            mz_file_write_func callback = [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
-                CallbackData* data = (CallbackData*)pOpaque;
-                if (!XML_Parse(data->parser, (const char*)pBuf, (int)n, (file_ofs + n == data->stat.m_uncomp_size) ? 1 : 0) || data->importer.object_parse_error()) {
-                    char error_buf[1024];
-                    ::snprintf(error_buf, 1024, "Error (%s) while parsing '%s' at line %d", data->importer.object_parse_error_message(), data->stat.m_filename, (int)XML_GetCurrentLineNumber(data->parser));
-                    throw Slic3r::FileIOError(error_buf);
-                }
-                return n;
-            };
-            void* opaque = &data;
-            res = mz_zip_reader_extract_to_callback(&archive, stat.m_file_index, callback, opaque, 0);
+            bbs_parse_model_xml(object_xml_parser, xml, stat.m_filename, [this]() { return object_parse_error(); }, [this]() { return object_parse_error_message(); });
         }
         catch (const version_error& e)
         {
             // rethrow the exception
+            object_mesh_blocks.reset();
             std::string error_message = std::string(e.what()) + " for " + object_path;
             throw Slic3r::FileIOError(error_message);
         }
         catch (std::exception& e)
         {
+            object_mesh_blocks.reset();
             std::string error_message = std::string(e.what()) + " for " + object_path;
             top_importer->add_error(error_message);
             return false;
         }
-
-        if (res == 0) {
-            top_importer->add_error("Error while extracting model data from zip archive for "+object_path);
-            return false;
-        }
+        object_mesh_blocks.reset();
 
         return true;
     }
@@ -5583,6 +5976,13 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         std::string m_thumbnail_small  = PRINTER_THUMBNAIL_SMALL_FILE;
         std::map<void const *, std::pair<ObjectData*, ModelVolume const *>> m_shared_meshes;
         std::map<ModelVolume const *, std::pair<std::string, int>> m_volume_paths;
+        //BBS: png streams of the thumbnails, encoded in parallel before they are written to the archive
+        struct EncodedThumbnail
+        {
+            std::string png;
+            std::string small_png;
+        };
+        std::map<ThumbnailData const *, EncodedThumbnail> m_encoded_thumbnails;
     public:
         //BBS: add plate data related logic
 
@@ -5613,6 +6013,8 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
         bool _add_content_types_file_to_archive(mz_zip_archive& archive);
 
+        static EncodedThumbnail _encode_thumbnail(const ThumbnailData& thumbnail_data, bool generate_small_thumbnail);
+        void _encode_thumbnails(const std::vector<std::pair<ThumbnailData const *, bool>>& thumbnails);
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data, const char* local_path, int index, bool generate_small_thumbnail = false);
         bool _add_calibration_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data, int index);
         bool _add_bbox_file_to_archive(mz_zip_archive& archive, const PlateBBoxData& id_bboxes, int index);
@@ -5866,6 +6268,18 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
                     return false;
             }
 
+            {
+                //BBS: the png encoding dominates the thumbnail stage, do it for all the plates at once
+                std::vector<std::pair<ThumbnailData const *, bool>> thumbnails;
+                for (ThumbnailData const *data : thumbnail_data)
+                    thumbnails.emplace_back(data, true);
+                for (auto const *datas : { &no_light_thumbnail_data, &top_thumbnail_data, &pick_thumbnail_data })
+                    for (ThumbnailData const *data : *datas)
+                        thumbnails.emplace_back(data, false);
+                _encode_thumbnails(thumbnails);
+            }
+            ScopeGuard encoded_thumbnails_guard([this]() { m_encoded_thumbnails.clear(); });
+
             for (unsigned int index = 0; index < thumbnail_data.size(); index++)
             {
                 if (thumbnail_data[index]->is_valid())
@@ -6271,23 +6685,16 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         return true;
     }
 
-    bool _BBS_3MF_Exporter::_add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data, const char* local_path, int index, bool generate_small_thumbnail)
+    _BBS_3MF_Exporter::EncodedThumbnail _BBS_3MF_Exporter::_encode_thumbnail(const ThumbnailData& thumbnail_data, bool generate_small_thumbnail)
     {
-        bool res = false;
-
+        EncodedThumbnail encoded;
         size_t png_size = 0;
         void* png_data = tdefl_write_image_to_png_file_in_memory_ex((const void*)thumbnail_data.pixels.data(), thumbnail_data.width, thumbnail_data.height, 4, &png_size, MZ_DEFAULT_COMPRESSION, 1);
         if (png_data != nullptr) {
-            std::string thumbnail_name = (boost::format("%1%_%2%.png")%local_path % (index + 1)).str();
-            res = mz_zip_writer_add_mem(&archive, thumbnail_name.c_str(), (const void*)png_data, png_size, MZ_NO_COMPRESSION);
+            encoded.png.assign((const char*)png_data, png_size);
             mz_free(png_data);
         }
 
-        if (!res) {
-            add_error("Unable to add thumbnail file to archive");
-            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Unable to add thumbnail file to archive\n");
-        }
-
         if (generate_small_thumbnail && thumbnail_data.is_valid()) {
             //generate small size of thumbnail
             std::vector<unsigned char> small_pixels;
@@ -6322,11 +6729,54 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
             }
             size_t small_png_size = 0;
             void* small_png_data = tdefl_write_image_to_png_file_in_memory_ex((const void*)small_pixels.data(), PLATE_THUMBNAIL_SMALL_WIDTH, PLATE_THUMBNAIL_SMALL_HEIGHT, 4, &small_png_size, MZ_DEFAULT_COMPRESSION, 1);
-            if (png_data != nullptr) {
-                std::string thumbnail_name = (boost::format("%1%_%2%_small.png") % local_path % (index + 1)).str();
-                res = mz_zip_writer_add_mem(&archive, thumbnail_name.c_str(), (const void*)small_png_data, small_png_size, MZ_NO_COMPRESSION);
+            if (small_png_data != nullptr) {
+                encoded.small_png.assign((const char*)small_png_data, small_png_size);
                 mz_free(small_png_data);
             }
+        }
+        return encoded;
+    }
+
+    void _BBS_3MF_Exporter::_encode_thumbnails(const std::vector<std::pair<ThumbnailData const *, bool>>& thumbnails)
+    {
+        std::vector<std::pair<ThumbnailData const *, bool>> valid_thumbnails;
+        for (auto const &thumbnail : thumbnails)
+            if (thumbnail.first != nullptr && thumbnail.first->is_valid() && m_encoded_thumbnails.find(thumbnail.first) == m_encoded_thumbnails.end())
+                valid_thumbnails.push_back(thumbnail);
+
+        std::vector<EncodedThumbnail> encoded(valid_thumbnails.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, valid_thumbnails.size(), 1), [&valid_thumbnails, &encoded](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i)
+                encoded[i] = _encode_thumbnail(*valid_thumbnails[i].first, valid_thumbnails[i].second);
+        });
+        for (size_t i = 0; i < valid_thumbnails.size(); ++i)
+            m_encoded_thumbnails[valid_thumbnails[i].first] = std::move(encoded[i]);
+    }
+
+    bool _BBS_3MF_Exporter::_add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data, const char* local_path, int index, bool generate_small_thumbnail)
+    {
+        bool res = false;
+
+        auto it = m_encoded_thumbnails.find(&thumbnail_data);
+        if (it == m_encoded_thumbnails.end() || (generate_small_thumbnail && it->second.small_png.empty()))
+            it = m_encoded_thumbnails.insert_or_assign(&thumbnail_data, _encode_thumbnail(thumbnail_data, generate_small_thumbnail)).first;
+        const EncodedThumbnail& encoded = it->second;
+
+        if (!encoded.png.empty()) {
+            std::string thumbnail_name = (boost::format("%1%_%2%.png")%local_path % (index + 1)).str();
+            res = mz_zip_writer_add_mem(&archive, thumbnail_name.c_str(), (const void*)encoded.png.data(), encoded.png.size(), MZ_NO_COMPRESSION);
+        }
+
+        if (!res) {
+            add_error("Unable to add thumbnail file to archive");
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", Unable to add thumbnail file to archive\n");
+        }
+
+        if (generate_small_thumbnail && thumbnail_data.is_valid()) {
+            if (!encoded.small_png.empty()) {
+                std::string thumbnail_name = (boost::format("%1%_%2%_small.png") % local_path % (index + 1)).str();
+                res = mz_zip_writer_add_mem(&archive, thumbnail_name.c_str(), (const void*)encoded.small_png.data(), encoded.small_png.size(), MZ_NO_COMPRESSION);
+            }
 
             if (!res) {
                 add_error("Unable to add small thumbnail file to archive");
@@ -8070,36 +8520,28 @@ bool _BBS_3MF_Exporter::_add_gcode_file_to_archive(mz_zip_archive& archive, cons
             std::string gcode_in_3mf = (boost::format(GCODE_FILE_FORMAT) % (plate_data->plate_index + 1)).str();
 
             plate_data->gcode_file = gcode_in_3mf;
-            mz_zip_archive archive;
-            mz_zip_writer_staged_context context;
-            mz_zip_zero_struct(&archive);
-            mz_zip_writer_init_heap(&archive, 0, 1024 * 1024);
-            {
-                mz_zip_writer_add_staged_open(&archive, &context, gcode_in_3mf.c_str(), m_zip64 ? (uint64_t(1) << 30) * 16 : (uint64_t(1) << 32) - 1, nullptr, nullptr, 0,
-                    MZ_DEFAULT_COMPRESSION, nullptr, 0, nullptr, 0);
-                boost::filesystem::path src_gcode_path(src_gcode_file);
-                if (!boost::filesystem::exists(src_gcode_path)) {
-                    BOOST_LOG_TRIVIAL(error) << "Gcode is missing, filename = " << PathSanitizer::sanitize(src_gcode_file);
-                    result = false;
-                }
-                boost::filesystem::ifstream ifs(src_gcode_file, std::ios::binary);
-                std::string buf(64 * 1024, 0);
-                while (ifs) {
-                    ifs.read(buf.data(), buf.size());
-                    mz_zip_writer_add_staged_data(&context, buf.data(), ifs.gcount());
-                }
-                mz_zip_writer_add_staged_finish(&context);
+            boost::filesystem::path src_gcode_path(src_gcode_file);
+            if (!boost::filesystem::exists(src_gcode_path)) {
+                BOOST_LOG_TRIVIAL(error) << "Gcode is missing, filename = " << PathSanitizer::sanitize(src_gcode_file);
+                result = false;
+                continue;
+            }
+            //BBS: the gcode is deflated in blocks in parallel outside of the lock,
+            // only the already compressed stream is appended to the root archive under the lock.
+            MZ_DeflatedData deflated;
+            if (!deflate_file_parallel(src_gcode_file, MZ_DEFAULT_COMPRESSION, deflated)) {
+                BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ":" << __LINE__ << boost::format(", failed to compress gcode %1%\n") % PathSanitizer::sanitize(src_gcode_file);
+                result = false;
+                continue;
             }
-            void *ppBuf; size_t pSize;
-            mz_zip_writer_finalize_heap_archive(&archive, &ppBuf, &pSize);
-            mz_zip_writer_end(&archive);
-            mz_zip_zero_struct(&archive);
-            mz_zip_reader_init_mem(&archive, ppBuf, pSize, 0);
             {
                 boost::unique_lock l(mutex);
-                mz_zip_writer_add_from_zip_reader(&root_archive, &archive, 0);
+                if (!add_deflated_to_zip(&root_archive, gcode_in_3mf.c_str(), deflated, MZ_DEFAULT_COMPRESSION)) {
+                    add_error("Unable to add gcode file to archive");
+                    result = false;
+                    continue;
+                }
             }
-            mz_zip_reader_end(&archive);
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ":" << __LINE__ << boost::format(", store  %1% to 3mf %2%\n") % PathSanitizer::sanitize(src_gcode_file) % PathSanitizer::sanitize(gcode_in_3mf);
         }
     });
@@ -13,6 +13,7 @@
 #include "ClipperUtils.hpp"
 #include "libslic3r.h"
 #include "LocalesUtils.hpp"
+#include "Profiler.hpp"
 #include "libslic3r/format.hpp"
 
 #include <algorithm>
@@ -2981,6 +2982,69 @@ void GCode::set_extrude_acceleration(bool is_first_layer)
     }
 }
 
+// Order of the islands of a layer to test for containment: increasing bounding box size, so that the islands inside
+// another islands are tested first, so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
+static std::vector<size_t> layer_islands_test_order(const Layer &layer)
+{
+    const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
+    std::vector<size_t> slices_test_order;
+    slices_test_order.reserve(layer.lslices.size());
+    for (size_t i = 0; i < layer.lslices.size(); ++ i)
+        slices_test_order.emplace_back(i);
+    std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
+        const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
+        const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
+        return s1.x() * s1.y() < s2.x() * s2.y();
+    });
+    return slices_test_order;
+}
+
+// Index of the island of layer.lslices containing point, layer.lslices.size() if the point does not fit inside any island.
+static size_t layer_island_of(const Layer &layer, const std::vector<size_t> &slices_test_order, const Point &point)
+{
+    for (size_t island_idx : slices_test_order) {
+        const BoundingBox &bbox = layer.lslices_bboxes[island_idx];
+        if (point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
+            point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
+            layer.lslices[island_idx].contour.contains(point))
+            return island_idx;
+    }
+    return layer.lslices.size();
+}
+
+// BBS: The island lookup of the extrusions does not depend on the state of the G-code generator,
+// thus it is done for all layers in parallel ahead of the serial generator stage of the pipeline.
+void GCode::collect_layer_islands(const std::vector<const Layer*> &layers)
+{
+    SLIC3R_PROFILE_ZONE("GCode::collect_layer_islands");
+    m_layer_islands.clear();
+    std::vector<std::pair<const Layer*, std::unordered_map<const ExtrusionEntityCollection*, size_t>*>> jobs;
+    jobs.reserve(layers.size());
+    for (const Layer *layer : layers) {
+        auto [it, inserted] = m_layer_islands.try_emplace(layer);
+        if (inserted)
+            jobs.emplace_back(layer, &it->second);
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, jobs.size()), [&jobs](const tbb::blocked_range<size_t> &range) {
+        for (size_t job_idx = range.begin(); job_idx < range.end(); ++ job_idx) {
+            const Layer &layer = *jobs[job_idx].first;
+            std::unordered_map<const ExtrusionEntityCollection*, size_t> &islands = *jobs[job_idx].second;
+            const std::vector<size_t> slices_test_order = layer_islands_test_order(layer);
+            for (const LayerRegion *layerm : layer.regions()) {
+                if (layerm == nullptr)
+                    continue;
+                for (const ExtrusionEntityCollection *collection : { &layerm->fills, &layerm->perimeters })
+                    for (const ExtrusionEntity *ee : collection->entities) {
+                        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
+                        if (! extrusions->entities.empty())
+                            islands.emplace(extrusions, layer_island_of(layer, slices_test_order, extrusions->first_point()));
+                    }
+            }
+        }
+    });
+}
+
 // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
 // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
 // and export G-code into file.
@@ -2991,6 +3055,15 @@ void GCode::process_layers(
     const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
     GCodeOutputStream                                                   &output_stream)
 {
+    if (m_collect_layer_islands) {
+        std::vector<const Layer*> object_layers;
+        for (const std::pair<coordf_t, std::vector<LayerToPrint>> &layer_to_print : layers_to_print)
+            for (const LayerToPrint &ltp : layer_to_print.second)
+                if (ltp.object_layer != nullptr)
+                    object_layers.emplace_back(ltp.object_layer);
+        this->collect_layer_islands(object_layers);
+    }
+
     //BBS: get object label id
     size_t layer_to_print_idx = 0;
     std::vector<int> object_label;
@@ -3002,6 +3075,8 @@ void GCode::process_layers(
     layers_results.resize(layers_to_print.size());
 
     // The pipeline is variable: The vase mode filter is optional.
+    // BBS: The generator stays serial, process_layer() reads and updates the writer state (position, extruder, retraction, wipe)
+    // left by the previous layer. Only the island lookup of collect_layer_islands() runs in parallel ahead of it.
     const auto generator = tbb::make_filter<void, GCode::LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> GCode::LayerResult {
             if (layer_to_print_idx == layers_to_print.size()) {
@@ -3028,6 +3103,7 @@ void GCode::process_layers(
     }
     const auto spiral_mode = tbb::make_filter<GCode::LayerResult, GCode::LayerResult>(
         slic3r_tbb_filtermode::serial_in_order, [&spiral_mode = *this->m_spiral_vase.get(), & layers_to_print](GCode::LayerResult in) -> GCode::LayerResult {
+            SLIC3R_PROFILE_ZONE("GCode::spiral_vase");
             spiral_mode.enable(in.spiral_vase_enable);
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
             return {spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush, in.gcode_store_pos};
@@ -3035,8 +3111,11 @@ void GCode::process_layers(
 
     std::vector<std::vector<PerExtruderAdjustments>> layers_extruder_adjustments(layers_to_print.size());
 
+    // BBS: The layer G-code is passed between the filters as text: the vase mode filter rewrites it,
+    // then GCodeEditor::parse_layer_gcode() tokenizes it again into the CoolingLine records used by the cooling stages.
     const auto parsing = tbb::make_filter<GCode::LayerResult, GCode::LayerResult>(slic3r_tbb_filtermode::serial_in_order,
     [&gcode_editer = *this->m_gcode_editer.get(), &layers_extruder_adjustments, object_label](GCode::LayerResult in) -> GCode::LayerResult{
+        SLIC3R_PROFILE_ZONE("GCode::editor_process_layer");
         //record gcode
         in.gcode = gcode_editer.process_layer(std::move(in.gcode), in.layer_id, layers_extruder_adjustments[in.gcode_store_pos], object_label, in.cooling_buffer_flush, false);
          return std::move(in);
@@ -3049,6 +3128,7 @@ void GCode::process_layers(
 
     const auto cooling = tbb::make_filter<GCode::LayerResult, GCode::LayerResult>(slic3r_tbb_filtermode::serial_in_order,
     [&cooling_processor, &layers_extruder_adjustments](GCode::LayerResult in) -> GCode::LayerResult {
+        SLIC3R_PROFILE_ZONE("GCode::cooling");
         in.layer_time = cooling_processor.calculate_layer_slowdown(layers_extruder_adjustments[in.gcode_store_pos]);
          return std::move(in);
     });
@@ -3058,6 +3138,7 @@ void GCode::process_layers(
 
     const auto build_node = tbb::make_filter<GCode::LayerResult, void>(slic3r_tbb_filtermode::serial_in_order,
     [&smooth_calculator, &layers_wall_collection, &layers_extruder_adjustments, object_label, &layers_results](GCode::LayerResult in){
+         SLIC3R_PROFILE_ZONE("GCode::smooth_build_node");
          smooth_calculator.build_node(layers_wall_collection[in.gcode_store_pos], object_label, layers_extruder_adjustments[in.gcode_store_pos]);
          layers_results[in.gcode_store_pos] = std::move(in);
          return;
@@ -3066,6 +3147,7 @@ void GCode::process_layers(
     // step 5: rewite
     const auto write_gocde= tbb::make_filter<GCode::LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
     [&gcode_editer = *this->m_gcode_editer.get(), &layers_extruder_adjustments](GCode::LayerResult in) -> std::string {
+         SLIC3R_PROFILE_ZONE("GCode::write_layer_gcode");
          return gcode_editer.write_layer_gcode(std::move(in.gcode), in.layer_id, in.layer_time, layers_extruder_adjustments[in.gcode_store_pos]);
     });
 
@@ -3087,7 +3169,10 @@ void GCode::process_layers(
 
 
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-    [&output_stream](std::string s) { output_stream.write(s); });
+    [&output_stream](std::string s) {
+        SLIC3R_PROFILE_ZONE("GCode::output");
+        output_stream.write(s);
+    });
 
     // BBS: apply cooling
     // The pipeline elements are joined using const references, thus no copying is performed.
@@ -3114,6 +3199,7 @@ void GCode::process_layers(
         m_print->set_status(90, message);
         tbb::parallel_pipeline(12, calculate_layer_time & write_gocde & output);
     }
+    m_layer_islands.clear();
 }
 
 // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
@@ -3132,6 +3218,14 @@ void GCode::process_layers(
     // generatotr + (spira) + parse + (cooling) + (smoothing) + rewrite
     // rewrite pipeline to get better schu
 
+    if (m_collect_layer_islands) {
+        std::vector<const Layer*> object_layers;
+        for (const LayerToPrint &ltp : layers_to_print)
+            if (ltp.object_layer != nullptr)
+                object_layers.emplace_back(ltp.object_layer);
+        this->collect_layer_islands(object_layers);
+    }
+
     // BBS: get object label id
     size_t           layer_to_print_idx = 0;
     std::vector<int> object_label;
@@ -3166,6 +3260,7 @@ void GCode::process_layers(
     }
     const auto spiral_mode = tbb::make_filter<GCode::LayerResult, GCode::LayerResult>(
         slic3r_tbb_filtermode::serial_in_order, [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](GCode::LayerResult in) -> GCode::LayerResult {
+            SLIC3R_PROFILE_ZONE("GCode::spiral_vase");
             spiral_mode.enable(in.spiral_vase_enable);
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
             return {spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush, in.gcode_store_pos};
@@ -3179,6 +3274,7 @@ void GCode::process_layers(
 
     const auto parsing = tbb::make_filter<GCode::LayerResult, GCode::LayerResult>(slic3r_tbb_filtermode::serial_in_order,
     [&gcode_editer = *this->m_gcode_editer.get(), &layers_extruder_adjustments, object_label](GCode::LayerResult in) -> GCode::LayerResult{
+        SLIC3R_PROFILE_ZONE("GCode::editor_process_layer");
         //record gcode
         in.gcode = gcode_editer.process_layer(std::move(in.gcode), in.layer_id, layers_extruder_adjustments[in.gcode_store_pos], object_label, in.cooling_buffer_flush, false);
          return std::move(in);
@@ -3190,6 +3286,7 @@ void GCode::process_layers(
 
     const auto cooling = tbb::make_filter<GCode::LayerResult, GCode::LayerResult>(slic3r_tbb_filtermode::serial_in_order,
     [&cooling_processor, &layers_extruder_adjustments](GCode::LayerResult in) -> GCode::LayerResult {
+        SLIC3R_PROFILE_ZONE("GCode::cooling");
         in.layer_time = cooling_processor.calculate_layer_slowdown(layers_extruder_adjustments[in.gcode_store_pos]);
          return std::move(in);
     });
@@ -3199,6 +3296,7 @@ void GCode::process_layers(
 
     const auto build_node = tbb::make_filter<GCode::LayerResult, void>(slic3r_tbb_filtermode::serial_in_order,
     [&smooth_calculator, &layers_wall_collection, &layers_extruder_adjustments, object_label, &layers_results](GCode::LayerResult in){
+         SLIC3R_PROFILE_ZONE("GCode::smooth_build_node");
          smooth_calculator.build_node(layers_wall_collection[in.gcode_store_pos], object_label, layers_extruder_adjustments[in.gcode_store_pos]);
          layers_results[in.gcode_store_pos] = std::move(in);
          return;
@@ -3207,6 +3305,7 @@ void GCode::process_layers(
     // step 5: rewite
     const auto write_gocde= tbb::make_filter<GCode::LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
     [&gcode_editer = *this->m_gcode_editer.get(), &layers_extruder_adjustments](GCode::LayerResult in) -> std::string {
+         SLIC3R_PROFILE_ZONE("GCode::write_layer_gcode");
          return gcode_editer.write_layer_gcode(std::move(in.gcode), in.layer_id, in.layer_time, layers_extruder_adjustments[in.gcode_store_pos]);
     });
 
@@ -3229,7 +3328,10 @@ void GCode::process_layers(
 
 
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-    [&output_stream](std::string s) { output_stream.write(s); });
+    [&output_stream](std::string s) {
+        SLIC3R_PROFILE_ZONE("GCode::output");
+        output_stream.write(s);
+    });
 
     // BBS: apply cooling
     // The pipeline elements are joined using const references, thus no copying is performed.
@@ -3254,6 +3356,7 @@ void GCode::process_layers(
 
         tbb::parallel_pipeline(12, calculate_layer_time & write_gocde & output);
     }
+    m_layer_islands.clear();
 }
 
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, unsigned int current_filament_id, const DynamicConfig *config_override)
@@ -3677,6 +3780,7 @@ GCode::LayerResult GCode::process_layer(
     assert(! layers.empty());
     // Either printing all copies of all objects, or just a single copy of a single object.
     assert(single_object_instance_idx == size_t(-1) || layers.size() == 1);
+    SLIC3R_PROFILE_ZONE_DETAIL("GCode::process_layer", (boost::format("z %1%") % layers.front().print_z()).str());
 
     // First object, support and raft layer, if available.
     const Layer         *object_layer  = nullptr;
@@ -4038,23 +4142,19 @@ GCode::LayerResult GCode::process_layer(
             //   option
             // (Still, we have to keep track of regions because we need to apply their config)
             size_t n_slices = layer.lslices.size();
-            const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
-            // Traverse the slices in an increasing order of bounding box size, so that the islands inside another islands are tested first,
-            // so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
+            // BBS: The islands were usually assigned by collect_layer_islands() ahead of the generator,
+            // look them up here only for the layers, which were not collected.
+            auto layer_islands = m_layer_islands.find(&layer);
             std::vector<size_t> slices_test_order;
-            slices_test_order.reserve(n_slices);
-            for (size_t i = 0; i < n_slices; ++ i)
-                slices_test_order.emplace_back(i);
-            std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
-                const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
-                const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
-                return s1.x() * s1.y() < s2.x() * s2.y();
-            });
-            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) {
-                const BoundingBox &bbox = layer_surface_bboxes[i];
-                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
-                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
-                       layer.lslices[i].contour.contains(point);
+            auto island_of = [this, &layer, &layer_islands, &slices_test_order](const ExtrusionEntityCollection *extrusions) {
+                if (layer_islands != m_layer_islands.end()) {
+                    auto it = layer_islands->second.find(extrusions);
+                    if (it != layer_islands->second.end())
+                        return it->second;
+                }
+                if (slices_test_order.size() != layer.lslices.size())
+                    slices_test_order = layer_islands_test_order(layer);
+                return layer_island_of(layer, slices_test_order, extrusions->first_point());
             };
 
             for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
@@ -4106,6 +4206,8 @@ GCode::LayerResult GCode::process_layer(
                         } else
                             printing_extruders.emplace_back(correct_extruder_id);
 
+                        // Island of the extrusions, n_slices if extrusions->first_point does not fit inside any slice.
+                        const size_t island_idx = island_of(extrusions);
                         // Now we must add this extrusion into the by_extruder map, once for each extruder that will print it:
                         for (unsigned int extruder : printing_extruders)
                         {
@@ -4114,19 +4216,9 @@ GCode::LayerResult GCode::process_layer(
                                 extruder,
                                 &layer_to_print - layers.data(),
                                 layers.size(), n_slices+1);
-                            for (size_t i = 0; i <= n_slices; ++ i) {
-                                bool   last = i == n_slices;
-                                size_t island_idx = last ? n_slices : slices_test_order[i];
-                                if (// extrusions->first_point does not fit inside any slice
-                                    last ||
-                                    // extrusions->first_point fits inside ith slice
-                                    point_inside_surface(island_idx, extrusions->first_point())) {
-                                    if (islands[island_idx].by_region.empty())
-                                        islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
-                                    islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
-                                    break;
-                                }
-                            }
+                            if (islands[island_idx].by_region.empty())
+                                islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
+                            islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
                         }
                     }
                 }
@@ -4403,10 +4495,15 @@ GCode::LayerResult GCode::process_layer(
 
                     ExtrusionRole support_extrusion_role = instance_to_print.object_by_extruder.support_extrusion_role;
                     bool is_overridden = support_extrusion_role == erSupportMaterialInterface ? support_intf_overridden : support_overridden;
-                    if (is_overridden == (print_wipe_extrusions != 0))
-                        gcode += this->extrude_support(
-                            // support_extrusion_role is erSupportMaterial, erSupportTransition, erSupportMaterialInterface or erMixed for all extrusion paths.
-                            instance_to_print.object_by_extruder.support->chained_path_from(m_last_pos, support_extrusion_role));
+                    if (is_overridden == (print_wipe_extrusions != 0)) {
+                        // BBS: The instances of an object print the support in the order chained for the first one.
+                        std::shared_ptr<ExtrusionEntityCollection> &support_chained = instance_to_print.object_by_extruder.support_chained;
+                        if (! support_chained)
+                            support_chained = std::make_shared<ExtrusionEntityCollection>(
+                                // support_extrusion_role is erSupportMaterial, erSupportTransition, erSupportMaterialInterface or erMixed for all extrusion paths.
+                                instance_to_print.object_by_extruder.support->chained_path_from(m_last_pos, support_extrusion_role));
+                        gcode += this->extrude_support(*support_chained);
+                    }
 
                     m_layer = layer_to_print.layer();
                     m_object_layer_over_raft = object_layer_over_raft;
@@ -5100,6 +5197,18 @@ std::string GCode::extrude_infill(const Print &print, const std::vector<ObjectBy
     const char*          extrusion_name = ironing ? "ironing" : "infill";
     for (const ObjectByExtruder::Island::Region &region : by_region)
         if (! region.infills.empty()) {
+            using ExtrusionOrder = ObjectByExtruder::Island::Region::ExtrusionOrder;
+            std::shared_ptr<ExtrusionOrder> &order = region.infill_order[ironing ? 1 : 0];
+            if (order) {
+                // BBS: Another instance of this object was already printed, replay its order.
+                if (! order->entities.empty()) {
+                    m_config.apply(print.get_print_region(&region - &by_region.front()).config());
+                    for (const ExtrusionEntity *ee : order->entities)
+                        gcode += this->extrude_entity(*ee, extrusion_name);
+                }
+                continue;
+            }
+            order = std::make_shared<ExtrusionOrder>();
             extrusions.clear();
             extrusions.reserve(region.infills.size());
             for (ExtrusionEntity *ee : region.infills)
@@ -5111,10 +5220,15 @@ std::string GCode::extrude_infill(const Print &print, const std::vector<ObjectBy
                 for (const ExtrusionEntity *fill : extrusions) {
                     auto *eec = dynamic_cast<const ExtrusionEntityCollection*>(fill);
                     if (eec) {
-                        for (ExtrusionEntity *ee : eec->chained_path_from(m_last_pos).entities)
+                        order->chained.emplace_back(eec->chained_path_from(m_last_pos));
+                        for (const ExtrusionEntity *ee : order->chained.back().entities) {
+                            order->entities.emplace_back(ee);
                             gcode += this->extrude_entity(*ee, extrusion_name);
-                    } else
+                        }
+                    } else {
+                        order->entities.emplace_back(fill);
                         gcode += this->extrude_entity(*fill, extrusion_name);
+                    }
                 }
             }
         }
@@ -5167,14 +5281,25 @@ bool GCode::GCodeOutputStream::is_error() const
     return ::ferror(this->f);
 }
 
+void GCode::GCodeOutputStream::flush_buffer()
+{
+    if (! m_buffer.empty()) {
+        ::fwrite(m_buffer.data(), 1, m_buffer.size(), this->f);
+        m_processor.process_buffer(m_buffer);
+        m_buffer.clear();
+    }
+}
+
 void GCode::GCodeOutputStream::flush()
 {
+    this->flush_buffer();
     ::fflush(this->f);
 }
 
 void GCode::GCodeOutputStream::close()
 {
     if (this->f) {
+        this->flush_buffer();
         ::fclose(this->f);
         this->f = nullptr;
     }
@@ -5183,11 +5308,9 @@ void GCode::GCodeOutputStream::close()
 void GCode::GCodeOutputStream::write(const char *what)
 {
     if (what != nullptr) {
-        const char* gcode = what;
-        // writes string to file
-        fwrite(gcode, 1, ::strlen(gcode), this->f);
-        //FIXME don't allocate a string, maybe process a batch of lines?
-        m_processor.process_buffer(std::string(gcode));
+        m_buffer += what;
+        if (m_buffer.size() >= buffer_size)
+            this->flush_buffer();
     }
 }
 
@@ -22,9 +22,11 @@
 #include "GCode/TimelapsePosPicker.hpp"
 
 #include <cfloat>
+#include <deque>
 #include <memory>
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <string>
 
 #ifdef HAS_PRESSURE_EQUALIZER
@@ -189,6 +191,8 @@ public:
     void            export_layer_filaments(GCodeProcessorResult* result);
     //BBS: set offset for gcode writer
     void set_gcode_offset(double x, double y) { m_writer.set_xy_offset(x, y); m_processor.set_xy_offset(x, y);}
+    // BBS: For the unit tests and the benchmark: assign the islands in process_layer() only, without collect_layer_islands().
+    void set_collect_layer_islands(bool enable) { m_collect_layer_islands = enable; }
 
     // Exported for the helper classes (OozePrevention, Wipe) and for the Perl binding for unit tests.
     const Vec2d&    origin() const { return m_origin; }
@@ -271,9 +275,14 @@ public:
     };
 
 private:
+    // BBS: The written G-code is collected into a pre-sized buffer, which is written to the file and passed to the G-code processor
+    // in chunks of about buffer_size bytes, instead of a fwrite() and a processor call with a temporary copy of each written string.
+    // The chunks always end at the end of a write() call.
     class GCodeOutputStream {
     public:
-        GCodeOutputStream(FILE *f, GCodeProcessor &processor) : f(f), m_processor(processor) {}
+        static constexpr const size_t buffer_size = 1024 * 1024;
+
+        GCodeOutputStream(FILE *f, GCodeProcessor &processor) : f(f), m_processor(processor) { m_buffer.reserve(buffer_size + 4096); }
         ~GCodeOutputStream() { this->close(); }
 
         bool is_open() const { return f; }
@@ -295,8 +304,12 @@ private:
         void write_format(const char* format, ...);
 
     private:
+        // Write the buffered G-code into the file and process it.
+        void flush_buffer();
+
         FILE *f = nullptr;
         GCodeProcessor &m_processor;
+        std::string     m_buffer;
     };
     void            _do_export(Print &print, GCodeOutputStream &file, ThumbnailsGeneratorCallback thumbnail_cb);
 
@@ -376,6 +389,10 @@ private:
         // BBS
         const bool                               prime_extruder = false);
 
+    // BBS: Find the island (index into Layer::lslices) of every perimeter and infill collection of the object layers
+    // in parallel, before the serial G-code generation consumes them in process_layer().
+    void collect_layer_islands(const std::vector<const Layer*> &layers);
+
     //BBS
     void check_placeholder_parser_failed();
     size_t cur_extruder_index() const;
@@ -410,6 +427,8 @@ private:
         const ExtrusionEntityCollection  *support;
         // erSupportMaterial / erSupportMaterialInterface / erSupportTransition or erMixed.
         ExtrusionRole                     support_extrusion_role;
+        // BBS: support chained for the first printed instance of the object, replayed by the other instances.
+        std::shared_ptr<ExtrusionEntityCollection> support_chained;
 
         struct Island
         {
@@ -422,6 +441,16 @@ private:
                 std::vector<const WipingExtrusions::ExtruderPerCopy*> infills_overrides;
                 std::vector<const WipingExtrusions::ExtruderPerCopy*> perimeters_overrides;
 
+                // BBS: Infill (index 0) and ironing (index 1) extrusions in their printing order, chained for the first printed
+                // instance of the object and replayed by its other instances, which are identical in the object coordinate system.
+                struct ExtrusionOrder {
+                    std::vector<const ExtrusionEntity*>    entities;
+                    // Owns the chained copies of the nested collections referenced by entities.
+                    // A deque does not relocate its elements when growing, entities keeps pointing into them.
+                    std::deque<ExtrusionEntityCollection>  chained;
+                };
+                mutable std::shared_ptr<ExtrusionOrder> infill_order[2];
+
 	            enum Type {
 	            	PERIMETERS,
 	            	INFILL,
@@ -537,6 +566,10 @@ private:
     bool                                m_last_scarf_seam_flag;
     std::unique_ptr<GCodeEditor>        m_gcode_editer;
     std::unique_ptr<SpiralVase>         m_spiral_vase;
+    // Island index of the perimeter / infill collections of a layer, Layer::lslices.size() if outside of all islands.
+    // Filled by collect_layer_islands(), read only while generating the layers.
+    std::unordered_map<const Layer*, std::unordered_map<const ExtrusionEntityCollection*, size_t>> m_layer_islands;
+    bool                                m_collect_layer_islands { true };
 #ifdef HAS_PRESSURE_EQUALIZER
     std::unique_ptr<PressureEqualizer>  m_pressure_equalizer;
 #endif /* HAS_PRESSURE_EQUALIZER */
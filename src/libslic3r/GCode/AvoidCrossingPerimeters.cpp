@@ -1210,6 +1210,7 @@ void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons &&bound
     // FIXME 1mm grid?
     boundary->grid.create(boundary->boundaries, coord_t(scale_(1.)));
     init_boundary_distances(boundary);
+    boundary->initialized = true;
 }
 
 static void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons &&boundary_polygons, const std::vector<Point>& merge_poins)
@@ -1227,6 +1228,7 @@ static void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons
     // FIXME 1mm grid?
     boundary->grid.create(boundary->boundaries, coord_t(scale_(1.)));
     init_boundary_distances(boundary);
+    boundary->initialized = true;
 }
 
 // Plan travel, which avoids perimeter crossings by following the boundaries of the layer.
@@ -1244,38 +1246,47 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     Vec2d startf = start.cast<double>();
     Vec2d endf   = end  .cast<double>();
 
-    const ExPolygons               &lslices          = gcodegen.layer()->lslices;
-    const std::vector<BoundingBox> &lslices_bboxes   = gcodegen.layer()->lslices_bboxes;
+    LayerBoundaries                &layer_boundaries = this->current_layer();
+    const ExPolygons               &lslices_offset   = layer_boundaries.lslices_offset;
     bool                            is_support_layer = (dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr);
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslice, travel)))) {
-        // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty()) {
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer(), get_perimeter_spacing(*gcodegen.layer()))), {start, end});
-        } else if (!(m_internal.bbox.contains(startf) && m_internal.bbox.contains(endf))) {
+    if (!use_external && (is_support_layer || (!lslices_offset.empty() && !any_expolygon_contains(lslices_offset, layer_boundaries.lslices_offset_bboxes, layer_boundaries.grid_lslice, travel)))) {
+        Boundary &internal = layer_boundaries.internal;
+        // Initialize internal only when it is necessary.
+        if (! internal.initialized) {
+            init_boundary(&internal, to_polygons(get_boundary(*gcodegen.layer(), get_perimeter_spacing(*gcodegen.layer()))), {start, end});
+        } else if (!(internal.bbox.contains(startf) && internal.bbox.contains(endf))) {
             // check if start and end are in bbox, if not, merge start and end points to bbox
-            m_internal.clear();
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer(), get_perimeter_spacing(*gcodegen.layer()))), {start, end});
+            Polygons boundaries = std::move(internal.boundaries);
+            internal.clear();
+            init_boundary(&internal, std::move(boundaries), {start, end});
         }
 
-        if (!m_internal.boundaries.empty()) {
-            travel_intersection_count = avoid_perimeters(m_internal, start, end, *gcodegen.layer(), result_pl);
+        if (!internal.boundaries.empty()) {
+            travel_intersection_count = avoid_perimeters(internal, start, end, *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
     } else if (use_external) {
-        // Initialize m_external only when exist any external travel for the current layer.
-        if (m_external.boundaries.empty()) {
-            init_boundary(&m_external, get_boundary_external(*gcodegen.layer()), {start, end});
-        } else if (!(m_external.bbox.contains(startf) && m_external.bbox.contains(endf))) {
+        // The boundary of a support layer also contains the holes of the object layers below, which depend on the object.
+        if (is_support_layer && m_external_support_object != gcodegen.layer()->object()) {
+            m_external_support.clear();
+            m_external_support_object = gcodegen.layer()->object();
+        }
+        Boundary &external = is_support_layer ? m_external_support : m_external;
+        // Initialize external only when exist any external travel for the current layer.
+        if (! external.initialized) {
+            init_boundary(&external, get_boundary_external(*gcodegen.layer()), {start, end});
+        } else if (!(external.bbox.contains(startf) && external.bbox.contains(endf))) {
             // check if start and end are in bbox
-            m_external.clear();
-            init_boundary(&m_external, get_boundary_external(*gcodegen.layer()), {start, end});
+            Polygons boundaries = std::move(external.boundaries);
+            external.clear();
+            init_boundary(&external, std::move(boundaries), {start, end});
         }
         
         // Trim the travel line by the bounding box.
-        if (!m_external.boundaries.empty()) 
+        if (!external.boundaries.empty())
         {
-            travel_intersection_count = avoid_perimeters(m_external, start, end, *gcodegen.layer(), result_pl);
+            travel_intersection_count = avoid_perimeters(external, start, end, *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
             
@@ -1308,7 +1319,7 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslice, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, lslices_offset, layer_boundaries.lslices_offset_bboxes, layer_boundaries.grid_lslice, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
@@ -1317,24 +1328,48 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
 
 void AvoidCrossingPerimeters::init_layer(const Layer &layer)
 {
-    m_internal.clear();
-    m_external.clear();
+    // The boundary for the travels between the objects only depends on print_z, thus it is shared by all objects and instances
+    // printed at the same height. The instances of an object share the data of its layer.
+    if (layer.print_z != m_print_z) {
+        m_print_z = layer.print_z;
+        m_layers.clear();
+        m_external.clear();
+        m_external_support.clear();
+        m_external_support_object = nullptr;
+    }
+    if (auto it = std::find_if(m_layers.begin(), m_layers.end(), [&layer](const auto &l) { return l.first == &layer; }); it != m_layers.end()) {
+        m_current = it->second.get();
+        return;
+    }
 
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
+    auto layer_boundaries = std::make_unique<LayerBoundaries>();
+    ExPolygons &lslices_offset = layer_boundaries->lslices_offset;
     for (auto coeff : {0.6f, 0.5f, 0.45f}) {
-        m_lslices_offset = offset_ex(layer.lslices, -get_external_perimeter_width(layer) * coeff);
-        if (!m_lslices_offset.empty()) break;
+        lslices_offset = offset_ex(layer.lslices, -get_external_perimeter_width(layer) * coeff);
+        if (!lslices_offset.empty()) break;
     }    
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const auto &ex_polygon : m_lslices_offset) m_lslices_offset_bboxes.emplace_back(get_extents(ex_polygon));
+    layer_boundaries->lslices_offset_bboxes.reserve(lslices_offset.size());
+    for (const auto &ex_polygon : lslices_offset) layer_boundaries->lslices_offset_bboxes.emplace_back(get_extents(ex_polygon));
 
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslice.set_bbox(bbox_slice);
+    layer_boundaries->grid_lslice.set_bbox(bbox_slice);
     //FIXME 1mm grid?
-    m_grid_lslice.create(m_lslices_offset, coord_t(scale_(1.)));
+    layer_boundaries->grid_lslice.create(lslices_offset, coord_t(scale_(1.)));
+
+    m_current = layer_boundaries.get();
+    m_layers.emplace_back(&layer, std::move(layer_boundaries));
+}
+
+AvoidCrossingPerimeters::LayerBoundaries& AvoidCrossingPerimeters::current_layer()
+{
+    if (m_current == nullptr) {
+        // Travel planned before any layer was initialized, nothing to avoid yet.
+        m_layers.emplace_back(nullptr, std::make_unique<LayerBoundaries>());
+        m_current = m_layers.back().second.get();
+    }
+    return *m_current;
 }
 
 #if 0
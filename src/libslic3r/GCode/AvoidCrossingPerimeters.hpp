@@ -5,12 +5,15 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <memory>
+
 namespace Slic3r {
 
 // Forward declarations.
 class GCode;
 class Layer;
 class Point;
+class PrintObject;
 
 class AvoidCrossingPerimeters
 {
@@ -43,14 +46,28 @@ public:
         std::vector<std::vector<float>> boundaries_params;
         // Used for detection of intersection between line and any polygon from boundaries
         EdgeGrid::Grid                  grid;
+        // The boundaries were collected for the current layer, though they may be empty.
+        bool                            initialized { false };
 
         void clear()
         {
             boundaries.clear();
             boundaries_params.clear();
+            initialized = false;
         }
     };
 
+    // Data of a single object layer in the coordinate system of the object, shared by all instances of the object.
+    struct LayerBoundaries {
+        // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid           grid_lslice;
+        // Store all needed data for travels inside object
+        Boundary                 internal;
+    };
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -59,15 +76,18 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid m_grid_lslice;
-    // Store all needed data for travels inside object
-    Boundary m_internal;
+    LayerBoundaries& current_layer();
+
+    // init_layer() is called for every printed instance. The data below is kept for all layers printed at m_print_z,
+    // so that it is built once per object layer and once per print_z for the travels between the objects.
+    double                   m_print_z { -1. };
+    std::vector<std::pair<const Layer*, std::unique_ptr<LayerBoundaries>>> m_layers;
+    LayerBoundaries         *m_current { nullptr };
     // Store all needed data for travels outside object
-    Boundary m_external;
+    Boundary                 m_external;
+    // The same for a support layer, which also avoids the holes of the object layers below.
+    Boundary                 m_external_support;
+    const PrintObject       *m_external_support_object { nullptr };
 };
 
 } // namespace Slic3r
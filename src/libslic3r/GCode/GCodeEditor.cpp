@@ -1,6 +1,5 @@
 #include "../GCode.hpp"
 #include "GCodeEditor.hpp"
-#include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/log/trivial.hpp>
 #include <iostream>
@@ -31,7 +30,7 @@ GCodeEditor::GCodeEditor(GCode &gcodegen) : m_config(gcodegen.config()), m_toolc
 void GCodeEditor::reset(const Vec3d &position)
 {
     // BBS: add I and J axis to store center of arc
-    m_current_pos.assign(7, 0.f);
+    m_current_pos.fill(0.f);
     m_current_pos[0] = float(position.x());
     m_current_pos[1] = float(position.y());
     m_current_pos[2] = float(position.z());
@@ -87,18 +86,30 @@ std::string GCodeEditor::process_layer(std::string &&                       gcod
         // and one object layer.
         // record parse gcode info to per_extruder_adjustments
         per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_current_pos, object_label, spiral_vase, layer_id > 0);
-        out = m_gcode;
+        // The parsed lines refer to the G-code by offsets, thus the cached G-code is handed over, not copied.
+        out = std::move(m_gcode);
         m_gcode.clear();
     }
     return out;
 }
 
+static inline bool line_starts_with(std::string_view str, std::string_view prefix)
+{
+    return str.size() >= prefix.size() && str.compare(0, prefix.size(), prefix) == 0;
+}
+
+static inline bool line_contains(std::string_view str, std::string_view what)
+{
+    return str.find(what) != std::string_view::npos;
+}
+
 //native-resource://sandbox_fs/webcontent/resource/assets/img/41ecc25c56.png
 // Parse the layer G-code for the moves, which could be adjusted.
 // Return the list of parsed lines, bucketed by an extruder.
+// BBS: The lines are tokenized in place, the parser does not allocate per G-code line.
 std::vector<PerExtruderAdjustments> GCodeEditor::parse_layer_gcode(
     const std::string &gcode,
-                                                                     std::vector<float> &            current_pos,
+                                                                     std::array<float, 7> &          current_pos,
                                                                      const std::vector<int> &        object_label,
                                                                      bool                            spiral_vase,
                                                                      bool                            join_z_smooth)
@@ -136,39 +147,40 @@ std::vector<PerExtruderAdjustments> GCodeEditor::parse_layer_gcode(
         while (*line_end != '\n' && *line_end != 0)
             ++ line_end;
         // sline will not contain the trailing '\n'.
-        std::string sline(line_start, line_end);
+        std::string_view sline(line_start, line_end - line_start);
         // CoolingLine will contain the trailing '\n'.
         if (*line_end == '\n')
             ++ line_end;
         CoolingLine line(0, line_start - gcode.c_str(), line_end - gcode.c_str());
-        if (boost::starts_with(sline, "G0 "))
+        if (line_starts_with(sline, "G0 "))
             line.type = CoolingLine::TYPE_G0;
-        else if (boost::starts_with(sline, "G1 "))
+        else if (line_starts_with(sline, "G1 "))
             line.type = CoolingLine::TYPE_G1;
-        else if (boost::starts_with(sline, "G92 "))
+        else if (line_starts_with(sline, "G92 "))
             line.type = CoolingLine::TYPE_G92;
-        else if (boost::starts_with(sline, "G2 "))
+        else if (line_starts_with(sline, "G2 "))
             line.type = CoolingLine::TYPE_G2;
-        else if (boost::starts_with(sline, "G3 "))
+        else if (line_starts_with(sline, "G3 "))
             line.type = CoolingLine::TYPE_G3;
          //BBS: parse object id & node id
-        else if (boost::starts_with(sline, object_id_string)) {
-            std::string sub = sline.substr(object_id_string.size());
+        else if (line_starts_with(sline, object_id_string)) {
+            std::string sub(sline.substr(object_id_string.size()));
             object_id       = std::stoi(sub);
-        } else if (boost::starts_with(sline, cooling_node_label)) {
-            std::string sub = sline.substr(cooling_node_label.size());
+        } else if (line_starts_with(sline, cooling_node_label)) {
+            std::string sub(sline.substr(cooling_node_label.size()));
             cooling_node_id = std::stoi(sub);
         }
 
         if (line.type) {
             // G0, G1 or G92
             // Parse the G-code line.
-            std::vector<float> new_pos(current_pos);
-            const char *c = sline.data() + 3;
+            std::array<float, 7> new_pos = current_pos;
+            const char *c     = sline.data() + 3;
+            const char *c_end = sline.data() + sline.size();
             for (;;) {
                 // Skip whitespaces.
-                for (; *c == ' ' || *c == '\t'; ++ c);
-                if (*c == 0 || *c == ';')
+                for (; c != c_end && (*c == ' ' || *c == '\t'); ++ c);
+                if (c == c_end || *c == ';')
                     break;
 
                 assert(is_decimal_separator_point()); // for atof
@@ -190,16 +202,16 @@ std::vector<PerExtruderAdjustments> GCodeEditor::parse_layer_gcode(
                     }
                 }
                 // Skip this word.
-                for (; *c != ' ' && *c != '\t' && *c != 0; ++ c);
+                for (; c != c_end && *c != ' ' && *c != '\t'; ++ c);
             }
-            bool external_perimeter = boost::contains(sline, ";_EXTERNAL_PERIMETER");
-            bool wipe               = boost::contains(sline, ";_WIPE");
+            bool external_perimeter = line_contains(sline, ";_EXTERNAL_PERIMETER");
+            bool wipe               = line_contains(sline, ";_WIPE");
 
             record_wall_lines(append_inner_wall_ptr, line_idx, adjustment, node_pos);
 
             if (wipe)
                 line.type |= CoolingLine::TYPE_WIPE;
-            if (boost::contains(sline, ";_EXTRUDE_SET_SPEED") && !wipe && !not_join_cooling) {
+            if (line_contains(sline, ";_EXTRUDE_SET_SPEED") && !wipe && !not_join_cooling) {
                 line.type |= CoolingLine::TYPE_ADJUSTABLE;
                 active_speed_modifier = adjustment->lines.size();
             }
@@ -278,16 +290,16 @@ std::vector<PerExtruderAdjustments> GCodeEditor::parse_layer_gcode(
                     line.type = 0;
                 }
             }
-            current_pos = std::move(new_pos);
-        } else if (boost::starts_with(sline, "; Slow Down Start")) {
+            current_pos = new_pos;
+        } else if (line_starts_with(sline, "; Slow Down Start")) {
             not_join_cooling = true;
-        } else if (boost::starts_with(sline, "; Slow Down End")) {
+        } else if (line_starts_with(sline, "; Slow Down End")) {
             not_join_cooling = false;
-        } else if (boost::starts_with(sline, ";_EXTRUDE_END")) {
+        } else if (line_starts_with(sline, ";_EXTRUDE_END")) {
             line.type = CoolingLine::TYPE_EXTRUDE_END;
             active_speed_modifier = size_t(-1);
-        } else if (boost::starts_with(sline, m_toolchange_prefix)) {
-            unsigned int new_extruder = (unsigned int)atoi(sline.c_str() + m_toolchange_prefix.size());
+        } else if (line_starts_with(sline, m_toolchange_prefix)) {
+            unsigned int new_extruder = (unsigned int)atoi(sline.data() + m_toolchange_prefix.size());
             // Only change extruder in case the number is meaningful. User could provide an out-of-range index through custom gcodes - those shall be ignored.
             if (new_extruder < map_extruder_to_per_extruder_adjustment.size()) {
                 if (new_extruder != current_extruder) {
@@ -303,27 +315,27 @@ std::vector<PerExtruderAdjustments> GCodeEditor::parse_layer_gcode(
                     BOOST_LOG_TRIVIAL(error) << "CoolingBuffer encountered an invalid toolchange, maybe from a custom gcode: " << sline;
             }
 
-        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_START")) {
+        } else if (line_starts_with(sline, ";_OVERHANG_FAN_START")) {
             line.type = CoolingLine::TYPE_OVERHANG_FAN_START;
-        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_END")) {
+        } else if (line_starts_with(sline, ";_OVERHANG_FAN_END")) {
             line.type = CoolingLine::TYPE_OVERHANG_FAN_END;
-        } else if (boost::starts_with(sline, "G4 ")) {
+        } else if (line_starts_with(sline, "G4 ")) {
             // Parse the wait time.
             line.type = CoolingLine::TYPE_G4;
             size_t pos_S = sline.find('S', 3);
             size_t pos_P = sline.find('P', 3);
             assert(is_decimal_separator_point()); // for atof
             line.time = line.time_max = float(
-                (pos_S > 0) ? atof(sline.c_str() + pos_S + 1) :
-                (pos_P > 0) ? atof(sline.c_str() + pos_P + 1) * 0.001 : 0.);
+                (pos_S > 0) ? atof(sline.data() + pos_S + 1) :
+                (pos_P > 0) ? atof(sline.data() + pos_P + 1) * 0.001 : 0.);
             line.origin_time_max      = line.time_max;
-        } else if (boost::starts_with(sline, ";_FORCE_RESUME_FAN_SPEED")) {
+        } else if (line_starts_with(sline, ";_FORCE_RESUME_FAN_SPEED")) {
             line.type = CoolingLine::TYPE_FORCE_RESUME_FAN;
-        } else if (boost::starts_with(sline, ";_SET_FAN_SPEED_CHANGING_LAYER")) {
+        } else if (line_starts_with(sline, ";_SET_FAN_SPEED_CHANGING_LAYER")) {
             line.type = CoolingLine::TYPE_SET_FAN_CHANGING_LAYER;
-        } else if (boost::starts_with(sline, "M624")) {
+        } else if (line_starts_with(sline, "M624")) {
             line.type = CoolingLine::TYPE_OBJECT_START;
-        } else if (boost::starts_with(sline, "M625")) {
+        } else if (line_starts_with(sline, "M625")) {
             line.type = CoolingLine::TYPE_OBJECT_END;
         }
         if (line.type != 0)
@@ -2,8 +2,10 @@
 #define slic3r_GCodeEditer_hpp_
 
 #include "../libslic3r.h"
+#include <array>
 #include <map>
 #include <string>
+#include <string_view>
 #include <cfloat>
 #include <libslic3r/Point.hpp>
 #include <libslic3r/Slicing.hpp>
@@ -259,7 +261,7 @@ public:
 private :
 	GCodeEditor& operator=(const GCodeEditor&) = delete;
     std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &                       gcode,
-                                                          std::vector<float> &                      current_pos,
+                                                          std::array<float, 7> &                    current_pos,
                                                           const std::vector<int> &                  object_label,
                                                           bool                                      spiral_vase,
                                                           bool                                      join_z_smooth);
@@ -269,7 +271,7 @@ private :
     // Internal data.
     // BBS: X,Y,Z,E,F,I,J
     std::vector<char>           m_axis;
-    std::vector<float>          m_current_pos;
+    std::array<float, 7>        m_current_pos;
     // Current known fan speed or -1 if not known yet.
     int                         m_fan_speed;
     int                         m_additional_fan_speed;
@@ -3,6 +3,7 @@
 #include "libslic3r/Print.hpp"
 #include "libslic3r/LocalesUtils.hpp"
 #include "libslic3r/format.hpp"
+#include "libslic3r/Profiler.hpp"
 #include "GCodeProcessor.hpp"
 
 #include <boost/log/trivial.hpp>
@@ -11,6 +12,7 @@
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
 
 #include <fast_float/fast_float.h>
 
@@ -312,7 +314,7 @@ void GCodeProcessor::TimeMachine::reset()
     prev.reset();
     gcode_time.reset();
     blocks = std::vector<TimeBlock>();
-    g1_times_cache = std::vector<G1LinesCacheItem>();
+    g1_times_cache.reset();
     std::fill(moves_time.begin(), moves_time.end(), 0.0f);
     std::fill(roles_time.begin(), roles_time.end(), 0.0f);
     layers_time = std::vector<float>();
@@ -320,6 +322,98 @@ void GCodeProcessor::TimeMachine::reset()
     m_additional_time_buffer.clear();
 }
 
+void GCodeProcessor::TimeMachine::G1LinesCache::reset()
+{
+    m_tail = std::vector<G1LinesCacheItem>();
+    m_spilled_count = 0;
+    if (m_spill_file != nullptr) {
+        ::fclose(m_spill_file);
+        m_spill_file = nullptr;
+        boost::nowide::remove(m_spill_filename.c_str());
+    }
+    m_spill_filename.clear();
+    m_spill_disabled = false;
+}
+
+void GCodeProcessor::TimeMachine::G1LinesCache::add(unsigned int id, float elapsed_time)
+{
+    if (!m_tail.empty() && m_tail.back().id == id)
+        m_tail.back().elapsed_time = elapsed_time;
+    else {
+        if (!m_spill_disabled && m_tail.size() >= m_block_size)
+            this->spill();
+        m_tail.push_back({ id, elapsed_time });
+    }
+}
+
+void GCodeProcessor::TimeMachine::G1LinesCache::spill()
+{
+    if (m_spill_file == nullptr) {
+        m_spill_filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("bbs_g1_times_%%%%-%%%%-%%%%-%%%%.bin")).string();
+        m_spill_file = boost::nowide::fopen(m_spill_filename.c_str(), "wb+");
+        if (m_spill_file == nullptr) {
+            // Keep everything in memory if no temporary file may be created.
+            BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": can not create %1%, keep the G1 times in memory") % m_spill_filename;
+            m_spill_filename.clear();
+            m_spill_disabled = true;
+            return;
+        }
+    }
+    if (::fwrite(m_tail.data(), sizeof(G1LinesCacheItem), m_tail.size(), m_spill_file) != m_tail.size())
+        throw Slic3r::RuntimeError(std::string("Time estimator failed.\nError while writing the temporary file.\nIs the disk full?\n"));
+    m_spilled_count += m_tail.size();
+    m_tail.clear();
+}
+
+GCodeProcessor::TimeMachine::G1LinesCache::Reader::Reader(G1LinesCache& cache) : m_cache(cache)
+{
+    if (m_cache.m_spill_file != nullptr) {
+        ::fflush(m_cache.m_spill_file);
+        std::fseek(m_cache.m_spill_file, 0, SEEK_SET);
+    }
+    this->load_block();
+}
+
+bool GCodeProcessor::TimeMachine::G1LinesCache::Reader::load_block()
+{
+    if (m_spilled_read < m_cache.m_spilled_count) {
+        size_t count = std::min(m_cache.m_block_size, m_cache.m_spilled_count - m_spilled_read);
+        size_t old_size = m_window.size();
+        m_window.resize(old_size + count);
+        if (::fread(m_window.data() + old_size, sizeof(G1LinesCacheItem), count, m_cache.m_spill_file) != count)
+            throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nError while reading the temporary file.\n"));
+        m_spilled_read += count;
+        return true;
+    }
+    if (!m_tail_loaded) {
+        m_tail_loaded = true;
+        m_window.insert(m_window.end(), m_cache.m_tail.begin(), m_cache.m_tail.end());
+        return !m_cache.m_tail.empty();
+    }
+    return false;
+}
+
+const GCodeProcessor::TimeMachine::G1LinesCacheItem* GCodeProcessor::TimeMachine::G1LinesCache::Reader::next()
+{
+    if (m_pos + 1 >= m_window.size() && !this->load_block())
+        return nullptr;
+    return m_pos + 1 < m_window.size() ? &m_window[m_pos + 1] : nullptr;
+}
+
+void GCodeProcessor::TimeMachine::G1LinesCache::Reader::advance()
+{
+    if (m_pos >= m_window.size())
+        return;
+    if (++ m_pos == m_window.size()) {
+        // Drop the consumed block before reading the next one.
+        m_window.clear();
+        m_pos = 0;
+        if (!this->load_block())
+            // Keep current() returning nullptr.
+            m_pos = m_window.size();
+    }
+}
+
 void GCodeProcessor::TimeMachine::simulate_st_synchronize(float additional_time, ExtrusionRole target_role, block_handler_t block_handler)
 {
     if (!enabled)
@@ -403,7 +497,7 @@ void GCodeProcessor::TimeMachine::handle_time_block(const TimeBlock& block, floa
 {
     if (block.skippable_type != SkipType::stNone)
         result.skippable_part_time[block.skippable_type] += block.time();
-    result.moves[block.move_id].time[activate_machine_idx] = time;
+    result.moves.set_time(block.move_id, activate_machine_idx, time);
 }
 
 GCodeProcessor::TimeMachine::AdditionalBuffer GCodeProcessor::TimeMachine::merge_adjacent_addtional_time_blocks(const AdditionalBuffer& buffer)
@@ -491,10 +585,7 @@ void GCodeProcessor::TimeMachine::calculate_time(size_t keep_last_n_blocks, floa
         if (block.flags.prepare_stage)
             prepare_time += block_time;
 
-        if(!g1_times_cache.empty() && g1_times_cache.back().id == block.g1_line_id)
-            g1_times_cache.back().elapsed_time = time;
-        else
-            g1_times_cache.push_back({ block.g1_line_id, time });
+        g1_times_cache.add(block.g1_line_id, time);
         // update times for remaining time to printer stop placeholders
         auto it_stop_time = std::lower_bound(stop_times.begin(), stop_times.end(), block.g1_line_id,
             [](const StopTime& t, unsigned int value) { return t.g1_line_id < value; });
@@ -528,15 +619,16 @@ void GCodeProcessor::TimeProcessor::reset()
     machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].enabled = true;
 }
 
-void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, std::vector<GCodeProcessorResult::MoveVertex>& moves, std::vector<size_t>& lines_ends, const TimeProcessContext& context)
+void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, GCodeProcessorResult::Moves& moves, std::vector<size_t>& lines_ends, const TimeProcessContext& context)
 {
+    SLIC3R_PROFILE_ZONE("GCodeProcessor::post_process");
     using namespace ExtruderPreHeating;
     FilePtr in{ boost::nowide::fopen(filename.c_str(), "rb") };
     if (in.f == nullptr)
         throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nCannot open file for reading.\n"));
 
     std::string filename_safe = PathSanitizer::sanitize(filename);
-    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before process %1%") % filename_safe;
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before process %1%") % filename_safe << log_memory_info();
     // temporary file to contain modified gcode
     std::string filename_in = filename;
     std::string filename_out = filename + ".postprocess";
@@ -770,10 +862,12 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
         return false;
     };
 
-    // Iterators for the normal and silent cached time estimate entry recently processed, used by process_line_G1.
-    auto g1_times_cache_it = Slic3r::reserve_vector<std::vector<TimeMachine::G1LinesCacheItem>::const_iterator>(machines.size());
-    for (const auto& machine : machines)
-        g1_times_cache_it.emplace_back(machine.g1_times_cache.begin());
+    // Cursors for the normal and silent cached time estimate entry recently processed, used by process_line_G1.
+    // The G1 times are streamed from the caches, which may have been spilled to disk.
+    std::vector<TimeMachine::G1LinesCache::Reader> g1_times_cache_it;
+    g1_times_cache_it.reserve(machines.size());
+    for (auto& machine : machines)
+        g1_times_cache_it.emplace_back(machine.g1_times_cache);
 
     // add lines M73 to exported gcode
     auto process_line_move = [
@@ -790,12 +884,15 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
             if (machine.enabled) {
                 // export pair <percent, remaining time>
                 // Skip all machine.g1_times_cache below g1_lines_counter.
-                auto& it = g1_times_cache_it[i];
-                while (it != machine.g1_times_cache.end() && it->id < g1_lines_counter)
-                    ++it;
-                if (it != machine.g1_times_cache.end() && it->id == g1_lines_counter) {
-                    std::pair<int, int> to_export_main = { int(100.0f * it->elapsed_time / machine.time),
-                                                            time_in_minutes(machine.time - it->elapsed_time) };
+                auto& reader = g1_times_cache_it[i];
+                while (reader.current() != nullptr && reader.current()->id < g1_lines_counter)
+                    reader.advance();
+                const TimeMachine::G1LinesCacheItem* current = reader.current();
+                if (current != nullptr && current->id == g1_lines_counter) {
+                    // reader.next() may load the next block and move the items read, work on a copy.
+                    const TimeMachine::G1LinesCacheItem it = *current;
+                    std::pair<int, int> to_export_main = { int(100.0f * it.elapsed_time / machine.time),
+                                                            time_in_minutes(machine.time - it.elapsed_time) };
 
                     if (last_exported_main[i] != to_export_main) {
                         gcode_buffer += format_line_M73_main(machine.line_m73_main_mask.c_str(),
@@ -804,10 +901,10 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
                         ++exported_lines_count;
                     }
                     // export remaining time to next printer stop
-                    auto it_stop = std::upper_bound(machine.stop_times.begin(), machine.stop_times.end(), it->elapsed_time,
+                    auto it_stop = std::upper_bound(machine.stop_times.begin(), machine.stop_times.end(), it.elapsed_time,
                         [](float value, const TimeMachine::StopTime& t) { return value < t.elapsed_time; });
                     if (it_stop != machine.stop_times.end()) {
-                        int to_export_stop = time_in_minutes(it_stop->elapsed_time - it->elapsed_time);
+                        int to_export_stop = time_in_minutes(it_stop->elapsed_time - it.elapsed_time);
                         if (last_exported_stop[i] != to_export_stop) {
                             if (to_export_stop > 0) {
                                 if (last_exported_stop[i] != to_export_stop) {
@@ -818,15 +915,15 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
                             }
                             else {
                                 bool is_last = false;
-                                auto next_it = it + 1;
-                                is_last |= (next_it == machine.g1_times_cache.end());
+                                const TimeMachine::G1LinesCacheItem* next_it = reader.next();
+                                is_last |= (next_it == nullptr);
 
-                                if (next_it != machine.g1_times_cache.end()) {
+                                if (next_it != nullptr) {
                                     auto next_it_stop = std::upper_bound(machine.stop_times.begin(), machine.stop_times.end(), next_it->elapsed_time,
                                         [](float value, const TimeMachine::StopTime& t) { return value < t.elapsed_time; });
                                     is_last |= (next_it_stop != it_stop);
 
-                                    std::string time_float_str = format_time_float(time_in_last_minute(it_stop->elapsed_time - it->elapsed_time));
+                                    std::string time_float_str = format_time_float(time_in_last_minute(it_stop->elapsed_time - it.elapsed_time));
                                     std::string next_time_float_str = format_time_float(time_in_last_minute(it_stop->elapsed_time - next_it->elapsed_time));
                                     is_last |= (string_to_double_decimal_point(time_float_str) > 0. && string_to_double_decimal_point(next_time_float_str) == 0.);
                                 }
@@ -835,7 +932,7 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
                                     if (std::distance(machine.stop_times.begin(), it_stop) == static_cast<ptrdiff_t>(machine.stop_times.size() - 1))
                                         gcode_buffer += format_line_M73_stop_int(machine.line_m73_stop_mask.c_str(), to_export_stop);
                                     else
-                                        gcode_buffer += format_line_M73_stop_float(machine.line_m73_stop_mask.c_str(), time_in_last_minute(it_stop->elapsed_time - it->elapsed_time));
+                                        gcode_buffer += format_line_M73_stop_float(machine.line_m73_stop_mask.c_str(), time_in_last_minute(it_stop->elapsed_time - it.elapsed_time));
 
                                     last_exported_stop[i] = to_export_stop;
                                     ++exported_lines_count;
@@ -1022,17 +1119,12 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
 
     // If not initialized, use the time from the previous move.
     {
-        std::optional<decltype(moves.begin())>iter;
-        for (auto niter = moves.begin(); niter != moves.end(); ++niter) {
-            if (!iter) {
-                iter = niter;
-                continue;
-            }
-            if (niter->time[0] == 0 && niter->time[1] == 0) {
-                niter->time[0] = (*iter)->time[0];
-                niter->time[1] = (*iter)->time[1];
+        for (size_t i = 1; i < moves.size(); ++i) {
+            if (moves.time(i)[0] == 0 && moves.time(i)[1] == 0) {
+                const std::array<float, 2> time = moves.time(i - 1);
+                moves.set_time(i, 0, time[0]);
+                moves.set_time(i, 1, time[1]);
             }
-            ++(*iter);
         }
     }
 
@@ -1164,7 +1256,11 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
     in.close();
     out.close();
 
-    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  after process %1%") % filename_safe;
+    // the G1 times were consumed by the first pass, release them and their temporary files
+    for (TimeMachine& machine : machines)
+        machine.g1_times_cache.reset();
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  after process %1%") % filename_safe << log_memory_info();
 
     if (boost::nowide::remove(filename_in.c_str()) != 0) {
         BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  Failed to remove the temporary G-code file %1%") % filename_in_safe;
@@ -1180,7 +1276,7 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
 
 void GCodeProcessor::TimeProcessor::handle_offsets_of_first_process(
     const std::vector<std::pair<unsigned int, unsigned int>>& offsets,
-    std::vector<GCodeProcessorResult::MoveVertex>& moves,
+    GCodeProcessorResult::Moves& moves,
     std::vector<ExtruderPreHeating::FilamentUsageBlock>& filament_blocks,
     std::vector<ExtruderPreHeating::ExtruderUsageBlcok>& extruder_blocks,
     std::vector<std::pair<unsigned int, unsigned int>>& skippable_blocks,
@@ -1190,12 +1286,13 @@ void GCodeProcessor::TimeProcessor::handle_offsets_of_first_process(
     // process moves
     {
         unsigned int curr_offset_id = 0, total_offset = 0;
-        for (GCodeProcessorResult::MoveVertex& move : moves) {
-            while (curr_offset_id < static_cast<unsigned int>(offsets.size()) && offsets[curr_offset_id].first <= move.gcode_id) {
+        for (size_t i = 0; i < moves.size(); ++i) {
+            const unsigned int gcode_id = moves.gcode_id(i);
+            while (curr_offset_id < static_cast<unsigned int>(offsets.size()) && offsets[curr_offset_id].first <= gcode_id) {
                 total_offset += offsets[curr_offset_id].second;
                 ++curr_offset_id;
             }
-            move.gcode_id += total_offset;
+            moves.set_gcode_id(i, gcode_id + total_offset);
         }
     }
 
@@ -1238,16 +1335,17 @@ void GCodeProcessor::TimeProcessor::handle_offsets_of_first_process(
     machine_end_gcode_start_line_id += get_offset_before_line_id(machine_end_gcode_start_line_id);
 }
 
-void GCodeProcessor::TimeProcessor::handle_offsets_of_second_process(const InsertedLinesMap& inserted_operation_lines, std::vector<GCodeProcessorResult::MoveVertex>& moves)
+void GCodeProcessor::TimeProcessor::handle_offsets_of_second_process(const InsertedLinesMap& inserted_operation_lines, GCodeProcessorResult::Moves& moves)
 {
     int total_offset = 0;
     auto iter = inserted_operation_lines.begin();
-    for (GCodeProcessorResult::MoveVertex& move : moves) {
-        while (iter != inserted_operation_lines.end() && iter->first < move.gcode_id) {
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const unsigned int gcode_id = moves.gcode_id(i);
+        while (iter != inserted_operation_lines.end() && iter->first < gcode_id) {
             total_offset += iter->second.size();
             ++iter;
         }
-        move.gcode_id += total_offset;
+        moves.set_gcode_id(i, gcode_id + total_offset);
     }
 }
 
@@ -1399,12 +1497,155 @@ void GCodeProcessor::UsedFilaments::process_caches(GCodeProcessor* processor)
     process_total_volume_cache(processor);
 }
 
+const GCodeProcessorResult::MoveVertex GCodeProcessorResult::Moves::operator[](size_t idx) const
+{
+    const Flags& flags = m_flags[idx];
+    const State& state = m_states[m_state[idx]];
+    MoveVertex   out;
+    out.type            = flags.type;
+    out.extrusion_role  = flags.extrusion_role;
+    out.move_path_type  = flags.move_path_type;
+    out.extruder_id     = flags.extruder_id;
+    out.cp_color_id     = flags.cp_color_id;
+    out.gcode_id        = m_gcode_id[idx];
+    out.delta_extruder  = m_delta_extruder[idx];
+    out.feedrate        = m_feedrate[idx];
+    out.width           = static_cast<float>(m_width_height[idx][0]);
+    out.height          = static_cast<float>(m_width_height[idx][1]);
+    out.mm3_per_mm      = m_mm3_per_mm[idx];
+    out.fan_speed       = state.fan_speed;
+    out.temperature     = state.temperature;
+    out.layer_duration  = state.layer_duration;
+    out.time            = m_time[idx];
+    out.position        = m_position[idx];
+    out.object_label_id = state.object_label_id;
+    out.print_z         = state.print_z;
+    out.interpolation_points = this->interpolation_points(idx);
+    return out;
+}
+
+void GCodeProcessorResult::Moves::push_back(const MoveVertex& move)
+{
+    m_position.emplace_back(move.position);
+    m_flags.push_back({ move.type, move.extrusion_role, move.move_path_type, move.extruder_id, move.cp_color_id });
+    m_gcode_id.emplace_back(move.gcode_id);
+    m_delta_extruder.emplace_back(move.delta_extruder);
+    m_feedrate.emplace_back(move.feedrate);
+    m_mm3_per_mm.emplace_back(move.mm3_per_mm);
+    m_width_height.push_back({ Eigen::half(move.width), Eigen::half(move.height) });
+    m_time.emplace_back(move.time);
+
+    // Consecutive moves mostly share their state, a new state is only stored if it differs from the state of the previous move.
+    const State state { move.print_z, move.layer_duration, move.temperature, move.fan_speed, move.object_label_id };
+    if (m_state.empty() || !(m_states[m_state.back()] == state)) {
+        m_state.emplace_back(uint32_t(m_states.size()));
+        m_states.emplace_back(state);
+    } else
+        m_state.emplace_back(m_state.back());
+
+    if (move.interpolation_points.empty())
+        m_arc.emplace_back(NoArc);
+    else {
+        const Vec3f* pool = m_interpolation_points.data();
+        if (move.interpolation_points.begin() >= pool && move.interpolation_points.end() <= pool + m_interpolation_points.size()) {
+            // A move of this container appended once more, share its points.
+            m_arcs.push_back({ uint32_t(move.interpolation_points.begin() - pool), uint32_t(move.interpolation_points.size()) });
+        } else {
+            m_arcs.push_back({ uint32_t(m_interpolation_points.size()), uint32_t(move.interpolation_points.size()) });
+            m_interpolation_points.insert(m_interpolation_points.end(), move.interpolation_points.begin(), move.interpolation_points.end());
+        }
+        m_arc.emplace_back(uint32_t(m_arcs.size() - 1));
+    }
+}
+
+void GCodeProcessorResult::Moves::erase(size_t idx)
+{
+    // The states are referenced by runs of consecutive moves in increasing order, release the state of the move
+    // if it is the only move of its run.
+    const uint32_t state = m_state[idx];
+    if ((idx == 0 || m_state[idx - 1] != state) && (idx + 1 == m_state.size() || m_state[idx + 1] != state)) {
+        m_states.erase(m_states.begin() + state);
+        for (uint32_t &s : m_state)
+            if (s > state)
+                -- s;
+    }
+    // Each arc is referenced by a single move, its points may be shared with the arc of another move.
+    if (const uint32_t arc_idx = m_arc[idx]; arc_idx != NoArc) {
+        const Arc arc = m_arcs[arc_idx];
+        m_arcs.erase(m_arcs.begin() + arc_idx);
+        for (uint32_t &a : m_arc)
+            if (a != NoArc && a > arc_idx)
+                -- a;
+        const bool shared = std::any_of(m_arcs.begin(), m_arcs.end(), [&arc](const Arc &other) {
+            return other.first < arc.first + arc.size && arc.first < other.first + other.size; });
+        if (! shared && arc.size > 0) {
+            m_interpolation_points.erase(m_interpolation_points.begin() + arc.first, m_interpolation_points.begin() + arc.first + arc.size);
+            for (Arc &other : m_arcs)
+                if (other.first >= arc.first + arc.size)
+                    other.first -= arc.size;
+        }
+    }
+    m_position.erase(m_position.begin() + idx);
+    m_flags.erase(m_flags.begin() + idx);
+    m_gcode_id.erase(m_gcode_id.begin() + idx);
+    m_delta_extruder.erase(m_delta_extruder.begin() + idx);
+    m_feedrate.erase(m_feedrate.begin() + idx);
+    m_mm3_per_mm.erase(m_mm3_per_mm.begin() + idx);
+    m_width_height.erase(m_width_height.begin() + idx);
+    m_time.erase(m_time.begin() + idx);
+    m_state.erase(m_state.begin() + idx);
+    m_arc.erase(m_arc.begin() + idx);
+}
+
+void GCodeProcessorResult::Moves::clear()
+{
+    m_position.clear();
+    m_flags.clear();
+    m_gcode_id.clear();
+    m_delta_extruder.clear();
+    m_feedrate.clear();
+    m_mm3_per_mm.clear();
+    m_width_height.clear();
+    m_time.clear();
+    m_state.clear();
+    m_arc.clear();
+    m_states.clear();
+    m_arcs.clear();
+    m_interpolation_points.clear();
+}
+
+void GCodeProcessorResult::Moves::shrink_to_fit()
+{
+    m_position.shrink_to_fit();
+    m_flags.shrink_to_fit();
+    m_gcode_id.shrink_to_fit();
+    m_delta_extruder.shrink_to_fit();
+    m_feedrate.shrink_to_fit();
+    m_mm3_per_mm.shrink_to_fit();
+    m_width_height.shrink_to_fit();
+    m_time.shrink_to_fit();
+    m_state.shrink_to_fit();
+    m_arc.shrink_to_fit();
+    m_states.shrink_to_fit();
+    m_arcs.shrink_to_fit();
+    m_interpolation_points.shrink_to_fit();
+}
+
+size_t GCodeProcessorResult::Moves::memsize() const
+{
+    return SLIC3R_STDVEC_MEMSIZE(m_position, Vec3f) + SLIC3R_STDVEC_MEMSIZE(m_flags, Flags) + SLIC3R_STDVEC_MEMSIZE(m_gcode_id, unsigned int) +
+           SLIC3R_STDVEC_MEMSIZE(m_delta_extruder, float) + SLIC3R_STDVEC_MEMSIZE(m_feedrate, float) + SLIC3R_STDVEC_MEMSIZE(m_mm3_per_mm, float) +
+           SLIC3R_STDVEC_MEMSIZE(m_width_height, HalfPair) + SLIC3R_STDVEC_MEMSIZE(m_time, FloatPair) +
+           SLIC3R_STDVEC_MEMSIZE(m_state, uint32_t) + SLIC3R_STDVEC_MEMSIZE(m_arc, uint32_t) + SLIC3R_STDVEC_MEMSIZE(m_states, State) +
+           SLIC3R_STDVEC_MEMSIZE(m_arcs, Arc) + SLIC3R_STDVEC_MEMSIZE(m_interpolation_points, Vec3f);
+}
+
 #if ENABLE_GCODE_VIEWER_STATISTICS
 void GCodeProcessorResult::reset() {
     //BBS: add mutex for protection of gcode result
     lock();
 
-    moves = std::vector<GCodeProcessorResult::MoveVertex>();
+    moves = Moves();
     printable_area = Pointfs();
     //BBS: add bed exclude area
     bed_exclude_area = Pointfs();
@@ -1652,17 +1893,20 @@ bool GCodeProcessor::check_multi_extruder_gcode_valid(const std::vector<Polygons
         float max_print_z;
     };
     std::map<int, std::map<int, GCodePosInfo>> gcode_path_pos; // object_id, filament_id, pos
-    for (const GCodeProcessorResult::MoveVertex &move : m_result.moves) {
-        if (move.type == EMoveType::Extrude/* || move.type == EMoveType::Travel*/) {
-            if (move.is_arc_move_with_interpolation_points()) {
-                for (int i = 0; i < move.interpolation_points.size(); i++) {
-                    gcode_path_pos[move.object_label_id][int(move.extruder_id)].pos.emplace_back(to_2d(move.interpolation_points[i].cast<double>()));
+    const GCodeProcessorResult::Moves &moves = m_result.moves;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        if (moves.type(i) == EMoveType::Extrude/* || moves.type(i) == EMoveType::Travel*/) {
+            GCodePosInfo &pos_info = gcode_path_pos[moves.object_label_id(i)][int(moves.extruder_id(i))];
+            if (moves.is_arc_move_with_interpolation_points(i)) {
+                const auto interpolation_points = moves.interpolation_points(i);
+                for (int j = 0; j < interpolation_points.size(); j++) {
+                    pos_info.pos.emplace_back(to_2d(interpolation_points[j].cast<double>()));
                 }
             }
             else {
-                gcode_path_pos[move.object_label_id][int(move.extruder_id)].pos.emplace_back(to_2d(move.position.cast<double>()));
+                pos_info.pos.emplace_back(to_2d(moves.position(i).cast<double>()));
             }
-            gcode_path_pos[move.object_label_id][int(move.extruder_id)].max_print_z = std::max(gcode_path_pos[move.object_label_id][int(move.extruder_id)].max_print_z, move.print_z);
+            pos_info.max_print_z = std::max(pos_info.max_print_z, moves.print_z(i));
         }
     }
 
@@ -2184,6 +2428,20 @@ void GCodeProcessor::enable_stealth_time_estimator(bool enabled)
     m_time_processor.machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Stealth)].enabled = enabled;
 }
 
+void GCodeProcessor::set_g1_times_block_size(size_t block_size)
+{
+    for (TimeMachine& machine : m_time_processor.machines)
+        machine.g1_times_cache.set_block_size(block_size);
+}
+
+size_t GCodeProcessor::g1_times_spilled_count() const
+{
+    size_t count = 0;
+    for (const TimeMachine& machine : m_time_processor.machines)
+        count += machine.g1_times_cache.spilled_count();
+    return count;
+}
+
 void GCodeProcessor::reset()
 {
     m_units = EUnits::Millimeters;
@@ -2293,6 +2551,7 @@ DynamicConfig GCodeProcessor::export_config_for_render() const
 // throws CanceledException through print->throw_if_canceled() (sent by the caller as callback).
 void GCodeProcessor::process_file(const std::string& filename, std::function<void()> cancel_callback)
 {
+    SLIC3R_PROFILE_ZONE("GCodeProcessor::process_file");
     CNumericLocalesSetter locales_setter;
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
@@ -2349,9 +2608,10 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     m_result.filename = filename;
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
+    m_result.moves.emplace_back();
     size_t parse_line_callback_cntr = 10000;
-    m_parser.parse_file(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
+    //BBS: tokenize the file in parallel, the machine state is updated serially on this thread, under the numeric locale set above
+    m_parser.parse_file_parallel(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (-- parse_line_callback_cntr == 0) {
             // Don't call the cancel_callback() too often, do it every at every 10000'th line.
             parse_line_callback_cntr = 10000;
@@ -2390,13 +2650,14 @@ void GCodeProcessor::process_buffer(const std::string &buffer)
 
 void GCodeProcessor::finalize(bool post_process)
 {
+    SLIC3R_PROFILE_ZONE("GCodeProcessor::finalize");
+    // no more moves will be added, release the slack left by the vector growth
+    m_result.moves.shrink_to_fit();
+
     // update width/height of wipe moves
-    for (GCodeProcessorResult::MoveVertex& move : m_result.moves) {
-        if (move.type == EMoveType::Wipe) {
-            move.width = Wipe_Width;
-            move.height = Wipe_Height;
-        }
-    }
+    for (size_t i = 0; i < m_result.moves.size(); ++i)
+        if (m_result.moves.type(i) == EMoveType::Wipe)
+            m_result.moves.set_width_height(i, Wipe_Width, Wipe_Height);
 
     // process the time blocks
     for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
@@ -2418,15 +2679,15 @@ void GCodeProcessor::finalize(bool post_process)
     auto prepare_time = (it != time_mode.roles_times.end()) ? it->second : 0.0f;
 
     //update times for results
-    for (size_t i = 0; i < m_result.moves.size(); i++) {
+    const std::vector<float>& layer_times = m_result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].layers_times;
+    m_result.moves.transform_layer_duration([&layer_times, prepare_time](float layer_duration) {
         //field layer_duration contains the layer id for the move in which the layer_duration has to be set.
-        size_t layer_id = size_t(m_result.moves[i].layer_duration);
-        std::vector<float>& layer_times = m_result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].layers_times;
+        size_t layer_id = size_t(layer_duration);
         if (layer_times.size() > layer_id - 1 && layer_id > 0)
-            m_result.moves[i].layer_duration = layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
+            return layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
         else
-            m_result.moves[i].layer_duration = 0;
-    }
+            return 0.f;
+    });
 
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     std::cout << "\n";
@@ -3970,12 +4231,12 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
     if (m_seams_detector.is_active()) {
         // check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter && !m_seams_detector.has_first_vertex()) {
-            //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f real_first_pos = Vec3f(m_result.moves.back().position.x() - m_x_offset, m_result.moves.back().position.y() - m_y_offset, m_result.moves.back().position.z());
+            //BBS: m_result.moves.back_position() has plate offset, must minus plate offset before calculate the real seam position
+            const Vec3f real_first_pos = Vec3f(m_result.moves.back_position().x() - m_x_offset, m_result.moves.back_position().y() - m_y_offset, m_result.moves.back_position().z());
             m_seams_detector.set_first_vertex(real_first_pos - m_extruder_offsets[filament_id]);
         } else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter && m_detect_layer_based_on_tag) {
-            const Vec3f real_last_pos = Vec3f(m_result.moves.back().position.x() - m_x_offset, m_result.moves.back().position.y() - m_y_offset,
-                                              m_result.moves.back().position.z());
+            const Vec3f real_last_pos = Vec3f(m_result.moves.back_position().x() - m_x_offset, m_result.moves.back_position().y() - m_y_offset,
+                                              m_result.moves.back_position().z());
             const Vec3f new_pos       = real_last_pos - m_extruder_offsets[filament_id];
             // We may have sloped loop, drop any previous start pos if we have z increment
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
@@ -3990,8 +4251,8 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
             };
 
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f real_last_pos = Vec3f(m_result.moves.back().position.x() - m_x_offset, m_result.moves.back().position.y() - m_y_offset, m_result.moves.back().position.z());
+            //BBS: m_result.moves.back_position() has plate offset, must minus plate offset before calculate the real seam position
+            const Vec3f real_last_pos = Vec3f(m_result.moves.back_position().x() - m_x_offset, m_result.moves.back_position().y() - m_y_offset, m_result.moves.back_position().z());
             const Vec3f new_pos = real_last_pos - m_extruder_offsets[filament_id];
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             // the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
@@ -4008,7 +4269,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
         Vec3f plate_offset = {(float) m_x_offset, (float) m_y_offset, 0.0f};
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[filament_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.back_position() - m_extruder_offsets[filament_id] - plate_offset);
     }
 
     if (m_detect_layer_based_on_tag && !m_result.spiral_vase_layers.empty()) {
@@ -4760,10 +5021,10 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     if (m_seams_detector.is_active()) {
         //BBS: check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter && !m_seams_detector.has_first_vertex()) {
-            m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[get_filament_id()] - plate_offset);
+            m_seams_detector.set_first_vertex(m_result.moves.back_position() - m_extruder_offsets[get_filament_id()] - plate_offset);
         } else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter && m_detect_layer_based_on_tag) {
-            const Vec3f real_last_pos = Vec3f(m_result.moves.back().position.x() - m_x_offset, m_result.moves.back().position.y() - m_y_offset,
-                                              m_result.moves.back().position.z());
+            const Vec3f real_last_pos = Vec3f(m_result.moves.back_position().x() - m_x_offset, m_result.moves.back_position().y() - m_y_offset,
+                                              m_result.moves.back_position().z());
             const Vec3f new_pos       = real_last_pos - m_extruder_offsets[filament_id];
             // We may have sloped loop, drop any previous start pos if we have z increment
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
@@ -4775,7 +5036,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
                 m_end_position[X] = pos.x(); m_end_position[Y] = pos.y(); m_end_position[Z] = pos.z();
             };
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[filament_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.back_position() - m_extruder_offsets[filament_id] - plate_offset;
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             //BBS: the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
 
@@ -4790,7 +5051,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     }
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[filament_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.back_position() - m_extruder_offsets[filament_id] - plate_offset);
     }
 
     //BBS: some layer may only has G3/G3, update right layer height
@@ -5549,10 +5810,11 @@ void GCodeProcessor::store_move_vertex(EMoveType type, EMovePathType path_type)
         {0.f,0.f}, // prefix sum of move time to this move : set later
         //BBS: add plate's offset to the rendering vertices
         Vec3f(m_end_position[X] + m_x_offset, m_end_position[Y] + m_y_offset, m_processing_start_custom_gcode ? m_first_layer_height : m_end_position[Z]) + m_extruder_offsets[filament_id],
-        Vec3f(m_arc_center(0, 0) + m_x_offset, m_arc_center(1, 0) + m_y_offset, m_arc_center(2, 0)) + m_extruder_offsets[filament_id],
-        m_interpolation_points,
         m_object_label_id,
-        m_print_z
+        m_print_z,
+        //BBS: only the arc moves keep their interpolation points, they are copied into the storage of the moves
+        (path_type == EMovePathType::Arc_move_cw || path_type == EMovePathType::Arc_move_ccw) ?
+            GCodeProcessorResult::InterpolationPoints(m_interpolation_points) : GCodeProcessorResult::InterpolationPoints()
     });
 
     if (type == EMoveType::Seam) {
@@ -6002,8 +6264,27 @@ void GCodeProcessor::PreCoolingInjector::inject_cooling_heating_command(TimeProc
         return nozzle_temps[idx] - (float)(pre_cooling_temps[idx]);
         };
 
-    auto gcode_move_comp = [](const GCodeProcessorResult::MoveVertex& a, unsigned int gcode_id) {
-        return a.gcode_id < gcode_id;
+    // The moves are searched through their gcode_id and time columns, without decoding whole moves.
+    auto gcode_id_lower_bound = [&moves = this->moves](size_t first, size_t last, unsigned int gcode_id) {
+        while (first < last) {
+            size_t mid = first + (last - first) / 2;
+            if (moves.gcode_id(mid) < gcode_id)
+                first = mid + 1;
+            else
+                last = mid;
+        }
+        return first;
+        };
+
+    auto time_upper_bound = [&moves = this->moves, valid_machine_id = this->valid_machine_id](size_t first, size_t last, float time) {
+        while (first < last) {
+            size_t mid = first + (last - first) / 2;
+            if (!(time < moves.time(mid)[valid_machine_id]))
+                first = mid + 1;
+            else
+                last = mid;
+        }
+        return first;
         };
 
     auto find_skip_block_end = [&skippable_blocks = this->skippable_blocks](unsigned int gcode_id) -> unsigned int{
@@ -6032,30 +6313,27 @@ void GCodeProcessor::PreCoolingInjector::inject_cooling_heating_command(TimeProc
         return 0;
     };
 
-    auto adjust_iter = [&](std::vector<GCodeProcessorResult::MoveVertex>::const_iterator iter,
-                       const std::vector<GCodeProcessorResult::MoveVertex>::const_iterator& begin,
-                       const std::vector<GCodeProcessorResult::MoveVertex>::const_iterator& end,
-                       bool forward) -> std::vector<GCodeProcessorResult::MoveVertex>::const_iterator
+    auto adjust_iter = [&](size_t iter, size_t begin, size_t end, bool forward) -> size_t
     {
         if (forward) {
             while (iter != end) {
-                unsigned current_id = iter->gcode_id;
+                unsigned current_id = moves.gcode_id(iter);
                 unsigned skip_block_end = find_skip_block_end(current_id);
                 if(skip_block_end == 0)
                     break;
-                iter = std::lower_bound(iter, end, skip_block_end + 1, gcode_move_comp);
+                iter = gcode_id_lower_bound(iter, end, skip_block_end + 1);
             }
         }
         else {
             while (iter != begin) {
-                unsigned current_id = iter->gcode_id;
+                unsigned current_id = moves.gcode_id(iter);
                 unsigned skip_block_start = find_skip_block_start(current_id);
                 if(skip_block_start == 0)
                     break;
-                auto new_iter = std::lower_bound(begin, iter, skip_block_start, gcode_move_comp);
+                size_t new_iter = gcode_id_lower_bound(begin, iter, skip_block_start);
                 if(new_iter == begin)
                     break;
-                iter = std::prev(new_iter);
+                iter = new_iter - 1;
             }
         }
         return iter;
@@ -6064,17 +6342,18 @@ void GCodeProcessor::PreCoolingInjector::inject_cooling_heating_command(TimeProc
     if (!pre_cooling && !pre_heating && block.free_upper_gcode_id <= block.free_lower_gcode_id)
         return;
 
-    auto move_iter_lower = std::lower_bound(moves.begin(), moves.end(), block.free_lower_gcode_id, gcode_move_comp);
-    auto move_iter_upper = std::lower_bound(moves.begin(), moves.end(), block.free_upper_gcode_id, gcode_move_comp); // closed iter
+    const size_t moves_end = moves.size();
+    size_t move_iter_lower = gcode_id_lower_bound(0, moves_end, block.free_lower_gcode_id);
+    size_t move_iter_upper = gcode_id_lower_bound(0, moves_end, block.free_upper_gcode_id); // closed iter
 
-    if (move_iter_lower == moves.end() || move_iter_upper == moves.begin())
+    if (move_iter_lower == moves_end || move_iter_upper == 0)
         return;
     --move_iter_upper;
 
-    auto partial_free_move_lower = std::lower_bound(moves.begin(), moves.end(), block.partial_free_lower_id, gcode_move_comp);
-    auto partial_free_move_upper = std::lower_bound(moves.begin(), moves.end(), block.partial_free_upper_id, gcode_move_comp); // closed iter
+    size_t partial_free_move_lower = gcode_id_lower_bound(0, moves_end, block.partial_free_lower_id);
+    size_t partial_free_move_upper = gcode_id_lower_bound(0, moves_end, block.partial_free_upper_id); // closed iter
 
-    if (partial_free_move_lower == moves.end() || partial_free_move_upper == moves.begin())
+    if (partial_free_move_lower == moves_end || partial_free_move_upper == 0)
         return;
     --partial_free_move_upper;
 
@@ -6083,8 +6362,8 @@ void GCodeProcessor::PreCoolingInjector::inject_cooling_heating_command(TimeProc
 
     bool apply_cooling_when_partial_free = is_pre_cooling_valid(block.last_filament_id) && pre_cooling;
 
-    float partial_free_time_gap = partial_free_move_upper->time[valid_machine_id] - partial_free_move_lower->time[valid_machine_id]; // time of partial free
-    float complete_free_time_gap = move_iter_upper->time[valid_machine_id] - move_iter_lower->time[valid_machine_id]; // time of complete free
+    float partial_free_time_gap = moves.time(partial_free_move_upper)[valid_machine_id] - moves.time(partial_free_move_lower)[valid_machine_id]; // time of partial free
+    float complete_free_time_gap = moves.time(move_iter_upper)[valid_machine_id] - moves.time(move_iter_lower)[valid_machine_id]; // time of complete free
 
     if (apply_cooling_when_partial_free && partial_free_time_gap + complete_free_time_gap < inject_time_threshold)
         return;
@@ -6112,35 +6391,35 @@ void GCodeProcessor::PreCoolingInjector::inject_cooling_heating_command(TimeProc
         // only perform heating
         if (target_temp <= curr_temp)
             return;
-        float heating_start_time = move_iter_upper->time[valid_machine_id] - (target_temp - curr_temp) / ext_heating_rate;
-        auto heating_move_iter = std::upper_bound(move_iter_lower, move_iter_upper + 1, heating_start_time, [valid_machine_id = this->valid_machine_id](float time, const GCodeProcessorResult::MoveVertex& a) {return time < a.time[valid_machine_id]; });
+        float heating_start_time = moves.time(move_iter_upper)[valid_machine_id] - (target_temp - curr_temp) / ext_heating_rate;
+        size_t heating_move_iter = time_upper_bound(move_iter_lower, move_iter_upper + 1, heating_start_time);
         if (heating_move_iter == move_iter_lower) {
             inserted_operation_lines[block.free_lower_gcode_id].emplace_back(format_line_M104(target_temp, block.extruder_id, "Multi extruder pre heating"), TimeProcessor::InsertLineType::PreHeating);
         }
         else {
             --heating_move_iter;
             heating_move_iter = adjust_iter(heating_move_iter, move_iter_lower, move_iter_upper, false);
-            inserted_operation_lines[heating_move_iter->gcode_id].emplace_back(format_line_M104(target_temp, block.extruder_id, "Multi extruder pre heating"), TimeProcessor::InsertLineType::PreHeating);
+            inserted_operation_lines[moves.gcode_id(heating_move_iter)].emplace_back(format_line_M104(target_temp, block.extruder_id, "Multi extruder pre heating"), TimeProcessor::InsertLineType::PreHeating);
         }
         return;
     }
     // perform cooling first and then perform heating
     float mid_temp = std::max(0.f, (curr_temp * ext_heating_rate + target_temp * ext_cooling_rate - complete_free_time_gap * ext_cooling_rate * ext_heating_rate) / (ext_cooling_rate + ext_heating_rate));
     float heating_temp = target_temp - mid_temp;
-    float heating_start_time = move_iter_upper->time[valid_machine_id] - heating_temp / ext_heating_rate;
-    auto heating_move_iter = std::upper_bound(move_iter_lower, move_iter_upper + 1, heating_start_time, [valid_machine_id = this->valid_machine_id](float time, const GCodeProcessorResult::MoveVertex& a) {return time < a.time[valid_machine_id]; });
+    float heating_start_time = moves.time(move_iter_upper)[valid_machine_id] - heating_temp / ext_heating_rate;
+    size_t heating_move_iter = time_upper_bound(move_iter_lower, move_iter_upper + 1, heating_start_time);
     if (heating_move_iter == move_iter_lower)
         return;
     --heating_move_iter;
     heating_move_iter = adjust_iter(heating_move_iter, move_iter_lower, move_iter_upper, false);
 
     // get the insert pos of heat cmd and recalculate time gap and delta temp
-    float real_cooling_time = heating_move_iter->time[valid_machine_id] - move_iter_lower->time[valid_machine_id];
+    float real_cooling_time = moves.time(heating_move_iter)[valid_machine_id] - moves.time(move_iter_lower)[valid_machine_id];
     int real_delta_temp = std::min((int)(real_cooling_time * ext_cooling_rate), (int)curr_temp);
     if (real_delta_temp == 0)
         return;
     inserted_operation_lines[block.free_lower_gcode_id].emplace_back(format_line_M104(curr_temp - real_delta_temp, block.extruder_id, "Multi extruder pre cooling"), TimeProcessor::InsertLineType::PreCooling);
-    inserted_operation_lines[heating_move_iter->gcode_id].emplace_back(format_line_M104(target_temp, block.extruder_id, "Multi extruder pre heating"), TimeProcessor::InsertLineType::PreHeating);
+    inserted_operation_lines[moves.gcode_id(heating_move_iter)].emplace_back(format_line_M104(target_temp, block.extruder_id, "Multi extruder pre heating"), TimeProcessor::InsertLineType::PreHeating);
 }
 
 void GCodeProcessor::PreCoolingInjector::build_by_filament_blocks(const std::vector<ExtruderPreHeating::FilamentUsageBlock>& filament_usage_blocks_)
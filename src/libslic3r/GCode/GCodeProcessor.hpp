@@ -9,7 +9,10 @@
 #include "libslic3r/Extruder.hpp"
 
 #include <cstdint>
+#include <algorithm>
+#include <iterator>
 #include <array>
+#include <memory>
 #include <vector>
 #include <mutex>
 #include <string>
@@ -185,6 +188,27 @@ namespace Slic3r {
             }
         };
 
+        // BBS: Interpolation points of an arc move, a view into the storage of GCodeProcessorResult::Moves,
+        // valid until the next move is appended. Empty for the moves which are not arcs.
+        class InterpolationPoints
+        {
+        public:
+            InterpolationPoints() = default;
+            InterpolationPoints(const Vec3f* data, size_t size) : m_data(data), m_size(uint32_t(size)) {}
+            InterpolationPoints(const std::vector<Vec3f>& points) : m_data(points.data()), m_size(uint32_t(points.size())) {}
+
+            size_t       size() const  { return m_size; }
+            bool         empty() const { return m_size == 0; }
+            const Vec3f* begin() const { return m_data; }
+            const Vec3f* end() const   { return m_data + m_size; }
+            const Vec3f& operator[](size_t idx) const { return m_data[idx]; }
+
+        private:
+            const Vec3f* m_data { nullptr };
+            uint32_t     m_size { 0 };
+        };
+
+        // A single move, as stored into and decoded from GCodeProcessorResult::Moves.
         struct MoveVertex
         {
             EMoveType type{ EMoveType::Noop };
@@ -207,10 +231,9 @@ namespace Slic3r {
             std::array<float, 2>time{ 0.f,0.f }; // prefix sum of time, assigned during finalize()
 
             Vec3f position{ Vec3f::Zero() }; // mm
-            Vec3f arc_center_position{ Vec3f::Zero() };      // mm
-            std::vector<Vec3f> interpolation_points;     // interpolation points of arc for drawing
             int  object_label_id{-1};
             float print_z{0.0f};
+            InterpolationPoints interpolation_points;     // interpolation points of arc for drawing, empty for the other moves
 
             float volumetric_rate() const { return feedrate * mm3_per_mm; }
             //BBS: new function to support arc move
@@ -222,6 +245,159 @@ namespace Slic3r {
             }
         };
 
+        // BBS: Storage of the moves. There is one move per G-code move, thus the moves dominate the memory of the result.
+        // The fields are stored column by column (structure of arrays):
+        // - width and height as half floats,
+        // - print_z, layer_duration, temperature, fan_speed and object_label_id, which stay constant over long runs of moves,
+        //   in a table of states, each move referencing its state by index,
+        // - the interpolation points of the arc moves in a single pool.
+        // The moves are read as decoded MoveVertex values, they are modified through the setters.
+        class Moves
+        {
+        public:
+            class const_iterator
+            {
+            public:
+                using iterator_category = std::random_access_iterator_tag;
+                using value_type        = MoveVertex;
+                using difference_type   = std::ptrdiff_t;
+                using reference         = const MoveVertex;
+                struct pointer {
+                    MoveVertex        move;
+                    const MoveVertex* operator->() const { return &move; }
+                };
+
+                const_iterator() = default;
+                const_iterator(const Moves* moves, size_t idx) : m_moves(moves), m_idx(idx) {}
+
+                reference       operator*() const                   { return (*m_moves)[m_idx]; }
+                pointer         operator->() const                  { return { (*m_moves)[m_idx] }; }
+                reference       operator[](difference_type n) const { return (*m_moves)[m_idx + n]; }
+                size_t          index() const                       { return m_idx; }
+
+                const_iterator& operator++()                        { ++ m_idx; return *this; }
+                const_iterator  operator++(int)                     { const_iterator out(*this); ++ m_idx; return out; }
+                const_iterator& operator--()                        { -- m_idx; return *this; }
+                const_iterator  operator--(int)                     { const_iterator out(*this); -- m_idx; return out; }
+                const_iterator& operator+=(difference_type n)       { m_idx += n; return *this; }
+                const_iterator& operator-=(difference_type n)       { m_idx -= n; return *this; }
+                const_iterator  operator+(difference_type n) const  { return { m_moves, size_t(m_idx + n) }; }
+                const_iterator  operator-(difference_type n) const  { return { m_moves, size_t(m_idx - n) }; }
+                difference_type operator-(const const_iterator& rhs) const { return difference_type(m_idx) - difference_type(rhs.m_idx); }
+
+                bool operator==(const const_iterator& rhs) const { return m_idx == rhs.m_idx; }
+                bool operator!=(const const_iterator& rhs) const { return m_idx != rhs.m_idx; }
+                bool operator< (const const_iterator& rhs) const { return m_idx <  rhs.m_idx; }
+                bool operator> (const const_iterator& rhs) const { return m_idx >  rhs.m_idx; }
+                bool operator<=(const const_iterator& rhs) const { return m_idx <= rhs.m_idx; }
+                bool operator>=(const const_iterator& rhs) const { return m_idx >= rhs.m_idx; }
+
+            private:
+                const Moves* m_moves { nullptr };
+                size_t       m_idx   { 0 };
+            };
+
+            size_t         size() const  { return m_position.size(); }
+            bool           empty() const { return m_position.empty(); }
+            const_iterator begin() const { return { this, 0 }; }
+            const_iterator end() const   { return { this, this->size() }; }
+
+            // The move is returned by value, decoded from the columns. Its interpolation points refer to the pool of this container.
+            const MoveVertex operator[](size_t idx) const;
+            const MoveVertex back() const { return (*this)[this->size() - 1]; }
+
+            // Access to the individual fields, decoding only the column read. Loops over many moves should use these
+            // instead of operator[], which decodes all the fields of a move.
+            EMoveType                   type(size_t idx) const            { return m_flags[idx].type; }
+            ExtrusionRole               extrusion_role(size_t idx) const  { return m_flags[idx].extrusion_role; }
+            EMovePathType               move_path_type(size_t idx) const  { return m_flags[idx].move_path_type; }
+            unsigned char               extruder_id(size_t idx) const     { return m_flags[idx].extruder_id; }
+            unsigned char               cp_color_id(size_t idx) const     { return m_flags[idx].cp_color_id; }
+            const Vec3f&                position(size_t idx) const        { return m_position[idx]; }
+            const Vec3f&                back_position() const             { return m_position.back(); }
+            unsigned int                gcode_id(size_t idx) const        { return m_gcode_id[idx]; }
+            float                       delta_extruder(size_t idx) const  { return m_delta_extruder[idx]; }
+            float                       feedrate(size_t idx) const        { return m_feedrate[idx]; }
+            float                       mm3_per_mm(size_t idx) const      { return m_mm3_per_mm[idx]; }
+            float                       volumetric_rate(size_t idx) const { return m_feedrate[idx] * m_mm3_per_mm[idx]; }
+            float                       width(size_t idx) const           { return static_cast<float>(m_width_height[idx][0]); }
+            float                       height(size_t idx) const          { return static_cast<float>(m_width_height[idx][1]); }
+            const std::array<float, 2>& time(size_t idx) const            { return m_time[idx]; }
+            float                       print_z(size_t idx) const         { return m_states[m_state[idx]].print_z; }
+            float                       layer_duration(size_t idx) const  { return m_states[m_state[idx]].layer_duration; }
+            float                       temperature(size_t idx) const     { return m_states[m_state[idx]].temperature; }
+            float                       fan_speed(size_t idx) const       { return m_states[m_state[idx]].fan_speed; }
+            int                         object_label_id(size_t idx) const { return m_states[m_state[idx]].object_label_id; }
+            InterpolationPoints         interpolation_points(size_t idx) const {
+                return m_arc[idx] == NoArc ? InterpolationPoints() : InterpolationPoints(m_interpolation_points.data() + m_arcs[m_arc[idx]].first, m_arcs[m_arc[idx]].size);
+            }
+            bool is_arc_move(size_t idx) const {
+                return m_flags[idx].move_path_type == EMovePathType::Arc_move_ccw || m_flags[idx].move_path_type == EMovePathType::Arc_move_cw;
+            }
+            bool is_arc_move_with_interpolation_points(size_t idx) const { return this->is_arc_move(idx) && m_arc[idx] != NoArc; }
+
+            // Appends a move together with its interpolation points.
+            void push_back(const MoveVertex& move);
+            void emplace_back() { this->push_back(MoveVertex()); }
+            // Removes a move, keeping the order of the others. Its state and interpolation points are released
+            // unless they are shared with another move.
+            void erase(size_t idx);
+            void clear();
+            void shrink_to_fit();
+            // Bytes allocated on the heap.
+            size_t memsize() const;
+
+            void set_gcode_id(size_t idx, unsigned int gcode_id)  { m_gcode_id[idx] = gcode_id; }
+            void set_time(size_t idx, size_t mode, float time)     { m_time[idx][mode] = time; }
+            void set_width_height(size_t idx, float width, float height) { m_width_height[idx] = { Eigen::half(width), Eigen::half(height) }; }
+            // Replaces layer_duration of all the moves by fn(layer_duration).
+            template<typename Fn> void transform_layer_duration(Fn fn) { for (State& state : m_states) state.layer_duration = fn(state.layer_duration); }
+
+        private:
+            struct Flags
+            {
+                EMoveType     type;
+                ExtrusionRole extrusion_role;
+                EMovePathType move_path_type;
+                unsigned char extruder_id;
+                unsigned char cp_color_id;
+            };
+            struct State
+            {
+                float print_z;
+                float layer_duration;
+                float temperature;
+                float fan_speed;
+                int   object_label_id;
+                bool operator==(const State& rhs) const {
+                    return print_z == rhs.print_z && layer_duration == rhs.layer_duration && temperature == rhs.temperature &&
+                           fan_speed == rhs.fan_speed && object_label_id == rhs.object_label_id;
+                }
+            };
+            struct Arc
+            {
+                uint32_t first;
+                uint32_t size;
+            };
+            static constexpr const uint32_t NoArc = uint32_t(-1);
+            using HalfPair  = std::array<Eigen::half, 2>;
+            using FloatPair = std::array<float, 2>;
+
+            std::vector<Vec3f>                       m_position;
+            std::vector<Flags>                       m_flags;
+            std::vector<unsigned int>                m_gcode_id;
+            std::vector<float>                       m_delta_extruder;
+            std::vector<float>                       m_feedrate;
+            std::vector<float>                       m_mm3_per_mm;
+            std::vector<HalfPair>                    m_width_height;
+            std::vector<FloatPair>                   m_time;
+            std::vector<uint32_t>                    m_state;
+            std::vector<uint32_t>                    m_arc;
+            std::vector<State>                       m_states;
+            std::vector<Arc>                         m_arcs;
+            std::vector<Vec3f>                       m_interpolation_points;
+        };
+
         struct SliceWarning {
             int         level;                  // 0: normal tips, 1: warning; 2: error
             std::string msg;                    // enum string
@@ -231,7 +407,7 @@ namespace Slic3r {
 
         std::string filename;
         unsigned int id;
-        std::vector<MoveVertex> moves;
+        Moves moves;
         // Positions of ends of lines of the final G-code this->filename after TimeProcessor::post_process() finalizes the G-code.
         std::vector<size_t> lines_ends;
         Pointfs printable_area;
@@ -575,6 +751,65 @@ namespace Slic3r {
                 float elapsed_time;
             };
 
+            // BBS: Elapsed times of the G1 lines, appended while processing and read back sequentially by TimeProcessor::post_process().
+            // To bound the memory used by very long prints, full blocks of items are spilled into a temporary file,
+            // only the block being appended to and the block being read are kept in memory.
+            // The moves and the lines ends updated by post_process() are not spilled, they are the result read by the preview.
+            class G1LinesCache
+            {
+            public:
+                // Default number of items of a block kept in memory.
+                static constexpr size_t DefaultBlockSize = 1 << 20;
+
+                G1LinesCache() = default;
+                G1LinesCache(const G1LinesCache&) = delete;
+                G1LinesCache& operator=(const G1LinesCache&) = delete;
+                ~G1LinesCache() { this->reset(); }
+
+                void reset();
+                // Updates the time of the last item if it belongs to the same line, appends a new item otherwise.
+                void add(unsigned int id, float elapsed_time);
+
+                // Number of items of a block kept in memory, to be set while the cache is empty. Kept by reset().
+                void   set_block_size(size_t block_size) { assert(m_tail.empty() && m_spilled_count == 0); m_block_size = std::max<size_t>(block_size, 1); }
+                size_t block_size() const { return m_block_size; }
+                size_t spilled_count() const { return m_spilled_count; }
+
+                // Forward only cursor, there should be a single reader at a time and no items should be added while reading.
+                class Reader
+                {
+                public:
+                    explicit Reader(G1LinesCache& cache);
+                    // nullptr once all the items were read.
+                    const G1LinesCacheItem* current() const { return m_pos < m_window.size() ? &m_window[m_pos] : nullptr; }
+                    // Item following current(), nullptr if current() is the last one.
+                    // It may load the next block, the pointer returned by current() before is not valid anymore.
+                    const G1LinesCacheItem* next();
+                    void advance();
+
+                private:
+                    // Appends the next block from the file or the in memory tail to m_window, returns false if there is none.
+                    bool load_block();
+
+                    G1LinesCache&                 m_cache;
+                    std::vector<G1LinesCacheItem> m_window;
+                    size_t                        m_pos { 0 };
+                    size_t                        m_spilled_read { 0 };
+                    bool                          m_tail_loaded { false };
+                };
+
+            private:
+                void spill();
+
+                size_t                        m_block_size { DefaultBlockSize };
+                std::vector<G1LinesCacheItem> m_tail;
+                std::string                   m_spill_filename;
+                FILE*                         m_spill_file { nullptr };
+                size_t                        m_spilled_count { 0 };
+                // Set if the temporary file could not be created, all the items are kept in m_tail then.
+                bool                          m_spill_disabled { false };
+            };
+
             bool enabled;
             float acceleration; // mm/s^2
             // hard limit for the acceleration, to which the firmware will clamp.
@@ -599,7 +834,7 @@ namespace Slic3r {
             State prev;
             CustomGCodeTime gcode_time;
             std::vector<TimeBlock> blocks;
-            std::vector<G1LinesCacheItem> g1_times_cache;
+            G1LinesCache g1_times_cache;
             std::array<float, static_cast<size_t>(EMoveType::Count)> moves_time;
             std::array<float, static_cast<size_t>(ExtrusionRole::erCount)> roles_time;
             std::vector<float> layers_time;
@@ -776,12 +1011,13 @@ namespace Slic3r {
             void reset();
 
             // post process the file with the given filename to add remaining time lines M73
-            // and updates moves' gcode ids accordingly
-            void post_process(const std::string& filename, std::vector<GCodeProcessorResult::MoveVertex>& moves, std::vector<size_t>& lines_ends, const TimeProcessContext& context);
+            // and updates moves' gcode ids accordingly.
+            // The G1 times are streamed from g1_times_cache, while moves and lines_ends are kept whole in memory.
+            void post_process(const std::string& filename, GCodeProcessorResult::Moves& moves, std::vector<size_t>& lines_ends, const TimeProcessContext& context);
         private:
             void handle_offsets_of_first_process(
                 const std::vector<std::pair<unsigned int, unsigned int>>& offsets,
-                std::vector<GCodeProcessorResult::MoveVertex>& moves,
+                GCodeProcessorResult::Moves& moves,
                 std::vector<ExtruderPreHeating::FilamentUsageBlock>& filament_blocks,
                 std::vector<ExtruderPreHeating::ExtruderUsageBlcok>& extruder_blocks,
                 std::vector<std::pair<unsigned int, unsigned int>>& skippable_blocks,
@@ -791,7 +1027,7 @@ namespace Slic3r {
 
             void handle_offsets_of_second_process(
                 const InsertedLinesMap& inserted_operation_lines,
-                std::vector<GCodeProcessorResult::MoveVertex>& moves
+                GCodeProcessorResult::Moves& moves
             );
         };
 
@@ -811,7 +1047,7 @@ namespace Slic3r {
             void build_extruder_free_blocks(const std::vector<ExtruderPreHeating::FilamentUsageBlock>& filament_usage_blocks, const std::vector<ExtruderPreHeating::ExtruderUsageBlcok>& extruder_usage_blocks);
 
             PreCoolingInjector(
-                const std::vector<GCodeProcessorResult::MoveVertex>& moves_,
+                const GCodeProcessorResult::Moves& moves_,
                 const std::vector<std::string>& filament_types_,
                 const std::vector<int>& filament_maps_,
                 const std::vector<int>& filament_nozzle_temps_,
@@ -843,7 +1079,7 @@ namespace Slic3r {
 
         private:
             std::vector<ExtruderFreeBlock> m_extruder_free_blocks;
-            const std::vector<GCodeProcessorResult::MoveVertex>& moves;
+            const GCodeProcessorResult::Moves& moves;
             const std::vector<std::string>& filament_types;
             const std::vector<int>& filament_maps;
             const std::vector<int>& filament_nozzle_temps;
@@ -914,12 +1150,13 @@ namespace Slic3r {
                 if (!m_move_id.has_value() || !m_custom_gcode_per_print_z_id.has_value())
                     return;
 
-                const Vec3f position = m_result.moves.back().position;
+                const Vec3f position = m_result.moves.back_position();
 
-                GCodeProcessorResult::MoveVertex& move = m_result.moves.emplace_back(m_result.moves[*m_move_id]);
+                GCodeProcessorResult::MoveVertex move = m_result.moves[*m_move_id];
                 move.position = position;
                 move.height = height;
-                m_result.moves.erase(m_result.moves.begin() + *m_move_id);
+                m_result.moves.push_back(move);
+                m_result.moves.erase(*m_move_id);
                 m_result.custom_gcode_per_print_z[*m_custom_gcode_per_print_z_id].print_z = position.z();
                 reset();
             }
@@ -1118,6 +1355,10 @@ namespace Slic3r {
             return m_time_processor.machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Stealth)].enabled;
         }
         void enable_machine_envelope_processing(bool enabled) { m_time_processor.machine_envelope_processing_enabled = enabled; }
+        // BBS: number of G1 lines of the time estimators kept in memory per block before spilling to disk, to be set before processing.
+        void set_g1_times_block_size(size_t block_size);
+        // Number of G1 lines of the time estimators spilled to disk, for tests and benchmarks.
+        size_t g1_times_spilled_count() const;
         void reset();
 
         const GCodeProcessorResult& get_result() const { return m_result; }
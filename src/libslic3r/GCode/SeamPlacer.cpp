@@ -15,6 +15,7 @@
 #include "libslic3r/BoundingBox.hpp"
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Profiler.hpp"
 
 #include "libslic3r/Geometry/Curves.hpp"
 #include "libslic3r/ShortEdgeCollapse.hpp"
@@ -137,7 +138,8 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                                       const TriangleSetSamples &              samples,
                                       size_t                                  negative_volumes_start_index)
 {
-    BOOST_LOG_TRIVIAL(debug) << "SeamPlacer: raycast visibility of " << samples.positions.size() << " samples over " << triangles.indices.size() << " triangles: end";
+    SLIC3R_PROFILE_ZONE("SeamPlacer::raycast_visibility");
+    BOOST_LOG_TRIVIAL(debug) << "SeamPlacer: raycast visibility of " << samples.positions.size() << " samples over " << triangles.indices.size() << " triangles: start";
 
     // prepare uniform samples of a hemisphere
     float              step_size = 1.0f / SeamPlacer::sqr_rays_per_sample_point;
@@ -158,6 +160,7 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                                                                      &raycasting_tree, &result, &samples](tbb::blocked_range<size_t> r) {
         // Maintaining hits memory outside of the loop, so it does not have to be reallocated for each query.
         std::vector<igl::Hit> hits;
+        std::vector<Vec3d>    ray_dirs;
         for (size_t s_idx = r.begin(); s_idx < r.end(); ++s_idx) {
             result[s_idx]                 = 1.0f;
             constexpr float decrease_step = 1.0f / (SeamPlacer::sqr_rays_per_sample_point * SeamPlacer::sqr_rays_per_sample_point);
@@ -168,41 +171,44 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
             Frame f;
             f.set_from_z(normal);
 
+            if (!model_contains_negative_parts) {
+                // All the rays of a sample start at the same point and they are coherent, trace them together as ray packets.
+                ray_dirs.clear();
+                for (const auto &dir : precomputed_sample_directions)
+                    ray_dirs.emplace_back(f.to_world(dir).cast<double>());
+                Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                AABBTreeIndirect::intersect_rays_first_hit(triangles.vertices, triangles.indices, raycasting_tree, ray_origin_d, ray_dirs, hits);
+                for (size_t ray_idx = 0; ray_idx < hits.size(); ++ray_idx)
+                    if (hits[ray_idx].id >= 0 && its_face_normal(triangles, hits[ray_idx].id).dot(ray_dirs[ray_idx].cast<float>()) <= 0) { result[s_idx] -= decrease_step; }
+                continue;
+            }
+
             for (const auto &dir : precomputed_sample_directions) {
                 Vec3f final_ray_dir = (f.to_world(dir));
-                if (!model_contains_negative_parts) {
-                    igl::Hit hitpoint;
-                    // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                    // direction.
-                    Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                    Vec3d ray_origin_d    = (center + normal * 0.01f).cast<double>(); // start above surface.
-                    bool  hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices, triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
-                    if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) { result[s_idx] -= decrease_step; }
-                } else { // TODO improve logic for order based boolean operations - consider order of volumes
-                    bool casting_from_negative_volume = samples.triangle_indices[s_idx] >= negative_volumes_start_index;
-
-                    Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                    if (casting_from_negative_volume) {                            // if casting from negative volume face, invert direction, change start pos
-                        final_ray_dir = -1.0 * final_ray_dir;
-                        ray_origin_d  = (center - normal * 0.01f).cast<double>();
-                    }
-                    Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                    bool  some_hit        = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices, triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hits);
-                    if (some_hit) {
-                        int counter = 0;
-                        // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
-                        //  It cannot be inside model, and it cannot be inside negative volume
-                        for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
-                            Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
-                            if (hits[hit_index].id >= int(negative_volumes_start_index)) { // negative volume hit
-                                counter -= sgn(face_normal.dot(final_ray_dir));            // if volume face aligns with ray dir, we are leaving negative space
-                                // which in reverse hit analysis means, that we are entering negative space :) and vice versa
-                            } else {
-                                counter += sgn(face_normal.dot(final_ray_dir));
-                            }
+                // TODO improve logic for order based boolean operations - consider order of volumes
+                bool casting_from_negative_volume = samples.triangle_indices[s_idx] >= negative_volumes_start_index;
+
+                Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                if (casting_from_negative_volume) {                            // if casting from negative volume face, invert direction, change start pos
+                    final_ray_dir = -1.0 * final_ray_dir;
+                    ray_origin_d  = (center - normal * 0.01f).cast<double>();
+                }
+                Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
+                bool  some_hit        = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices, triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hits);
+                if (some_hit) {
+                    int counter = 0;
+                    // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
+                    //  It cannot be inside model, and it cannot be inside negative volume
+                    for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
+                        Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
+                        if (hits[hit_index].id >= int(negative_volumes_start_index)) { // negative volume hit
+                            counter -= sgn(face_normal.dot(final_ray_dir));            // if volume face aligns with ray dir, we are leaving negative space
+                            // which in reverse hit analysis means, that we are entering negative space :) and vice versa
+                        } else {
+                            counter += sgn(face_normal.dot(final_ray_dir));
                         }
-                        if (counter == 0) { result[s_idx] -= decrease_step; }
                     }
+                    if (counter == 0) { result[s_idx] -= decrease_step; }
                 }
             }
         }
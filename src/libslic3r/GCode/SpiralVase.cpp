@@ -93,12 +93,19 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
     float layer_height = 0;
     float z = 0.f;
     
+    // BBS: Tokenize the layer once. The look-ahead pass runs while tokenizing, the rewrite pass below runs over the stored lines
+    // with the reader position each line was parsed with, instead of parsing the layer text a second time.
+    size_t num_lines = 0;
     {
-        //FIXME Performance warning: This copies the GCodeConfig of the reader.
-        GCodeReader r = m_reader;  // clone
         bool set_z = false;
-        r.parse_buffer(gcode, [&total_layer_length, &layer_height, &z, &set_z]
+        m_reader.parse_buffer(gcode, [this, &num_lines, &total_layer_length, &layer_height, &z, &set_z]
             (GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+            if (num_lines == m_layer_lines.size())
+                m_layer_lines.emplace_back();
+            // Assigning to the retained lines reuses their buffers.
+            LayerLine &layer_line = m_layer_lines[num_lines ++];
+            layer_line.line       = line;
+            layer_line.position   = reader.position();
             if (line.cmd_is("G1")) {
                 if (line.extruding(reader)) {
                     total_layer_length += line.dist_XY(reader);
@@ -112,6 +119,7 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
             }
         });
     }
+    const std::array<float, NUM_AXES> end_position = m_reader.position();
 
     // Remove layer height from initial Z.
     z -= layer_height;
@@ -122,6 +130,7 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
     bool smooth_spiral = m_smooth_spiral;
     std::string new_gcode;
     std::string transition_gcode;
+    new_gcode.reserve(gcode.size() + gcode.size() / 8);
     float max_xy_dist_for_smoothing = m_max_xy_smoothing;
     //FIXME Tapering of the transition layer only works reliably with relative extruder distances.
     // For absolute extruder distances it will be switched off.
@@ -133,15 +142,16 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
     //set initial point
     SpiralVase::SpiralPoint last_point = previous_layer != NULL && previous_layer->size() > 0 ? previous_layer->at(previous_layer->size()-1): SpiralVase::SpiralPoint(0,0);
 
-    m_reader.parse_buffer(gcode, [&new_gcode, &z, total_layer_length, layer_height, transition_in, &len, &current_layer, &previous_layer, &transition_gcode, transition_out,
-                                  smooth_spiral, &max_xy_dist_for_smoothing, &last_point]
-        (GCodeReader &reader, GCodeReader::GCodeLine line) {
+    auto process_line = [&new_gcode, &z, total_layer_length, layer_height, transition_in, &len, &current_layer, &previous_layer, &transition_gcode, transition_out,
+                         smooth_spiral, &max_xy_dist_for_smoothing, &last_point]
+        (GCodeReader &reader, GCodeReader::GCodeLine &line) {
         if (line.cmd_is("G1")) {
             if (line.has_z()) {
                 // If this is the initial Z move of the layer, replace it with a
                 // (redundant) move to the last Z of previous layer.
                 line.set(reader, Z, z);
-                new_gcode += line.raw() + '\n';
+                new_gcode += line.raw();
+                new_gcode += '\n';
                 return;
             } else {
                 float dist_XY = line.dist_XY(reader);
@@ -158,7 +168,8 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
                             // We add this new layer at the very end
                             GCodeReader::GCodeLine transitionLine(line);
                             transitionLine.set(reader, E, line.e() * (1 - factor), 5 /*decimal_digits*/);
-                            transition_gcode += transitionLine.raw() + '\n';
+                            transition_gcode += transitionLine.raw();
+                            transition_gcode += '\n';
                         }
                         // This line is the core of Spiral Vase mode, ramp up the Z smoothly
                         line.set(reader, Z, z + factor * layer_height);
@@ -191,7 +202,8 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
                                 }
                             }
                         }
-                        new_gcode += line.raw() + '\n';
+                        new_gcode += line.raw();
+                        new_gcode += '\n';
                     }
                     return;
                     /*  Skip travel moves: the move to first perimeter point will
@@ -204,15 +216,25 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
                 }
             }
         }
-        new_gcode += line.raw() + '\n';
+        new_gcode += line.raw();
+        new_gcode += '\n';
         if(transition_out) {
-            transition_gcode += line.raw() + '\n';
+            transition_gcode += line.raw();
+            transition_gcode += '\n';
         }
-    });
+    };
+    GCodeReader::GCodeLine line;
+    for (size_t i = 0; i < num_lines; ++ i) {
+        m_reader.set_position(m_layer_lines[i].position);
+        line = m_layer_lines[i].line;
+        process_line(m_reader, line);
+    }
+    m_reader.set_position(end_position);
 
     m_previous_layer = current_layer;
 
-    return new_gcode + transition_gcode;
+    new_gcode += transition_gcode;
+    return new_gcode;
 }
 
 }
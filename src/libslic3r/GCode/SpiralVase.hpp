@@ -47,6 +47,13 @@ private:
     // Whether to interpolate XY coordinates with the previous layer. Results in no seam at layer changes
     bool                m_smooth_spiral = false;
     std::shared_ptr<std::vector<SpiralPoint>> m_previous_layer;
+    // BBS: Lines of the layer being processed together with the reader position before each line.
+    // Kept between the layers, so that their buffers are reused.
+    struct LayerLine {
+        GCodeReader::GCodeLine      line;
+        std::array<float, NUM_AXES> position;
+    };
+    std::vector<LayerLine>      m_layer_lines;
 };
 }
 
@@ -4,12 +4,32 @@
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <memory>
+#include <thread>
 #include "Utils.hpp"
 
 #include "LocalesUtils.hpp"
+#include "Thread.hpp"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
+#include <tbb/concurrent_queue.h>
 
 #include <Shiny/Shiny.h>
 #include <fast_float/fast_float.h>
@@ -31,11 +51,23 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
     PROFILE_FUNC();
 
     assert(is_decimal_separator_point());
-    
+
+    const char *c = tokenize_line(ptr, end, gline, command);
+
+    if (gline.has(E) && m_config.use_relative_e_distances)
+        m_position[E] = 0;
+
+    if (m_verbose)
+        std::cout << gline.m_raw << std::endl;
+
+    return c;
+}
+
+const char* GCodeReader::tokenize_line(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
+{
     // command and args
     const char *c = ptr;
     {
-        PROFILE_BLOCK(command_and_args);
         // Skip the whitespaces.
         command.first = skip_whitespaces(c);
         // Skip the command.
@@ -82,18 +114,13 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 c = skip_word(c);
         }
     }
-    
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
 
     // Skip the rest of the line.
     for (; ! is_end_of_line(*c); ++ c);
 
     // Copy the raw string including the comment, without the trailing newlines.
-    if (c > ptr) {
-        PROFILE_BLOCK(copy_raw_string);
+    if (c > ptr)
         gline.m_raw.assign(ptr, c);
-    }
 
     // Skip the trailing newlines.
 	if (*c == '\r')
@@ -101,9 +128,6 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
 	if (*c == '\n')
 		++ c;
 
-    if (m_verbose)
-        std::cout << gline.m_raw << std::endl;
-
     return c;
 }
 
@@ -222,6 +246,159 @@ bool GCodeReader::parse_file_raw(const std::string &filename, raw_line_callback_
         [](size_t){});
 }
 
+namespace {
+    // Lines of a memory mapped G-code file tokenized by a single task of GCodeReader::parse_file_parallel().
+    struct GCodeChunk
+    {
+        const char                       *begin { nullptr };
+        const char                       *end { nullptr };
+        std::vector<GCodeReader::GCodeLine> lines;
+        // Offsets from the start of the file just behind each '\n'.
+        std::vector<size_t>               lines_ends;
+    };
+}
+
+bool GCodeReader::parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends)
+{
+    lines_ends.clear();
+    boost::iostreams::mapped_file_source mapped_file;
+    try {
+        // Empty files can not be mapped.
+        if (boost::filesystem::file_size(file) == 0)
+            return true;
+        mapped_file.open(file);
+    } catch (const std::exception &err) {
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": failed to map %1%, %2%, falling back to the sequential reader") % file % err.what();
+        return this->parse_file(file, callback, lines_ends);
+    }
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before parse_file %1%") % file.c_str();
+    const char *file_begin = mapped_file.data();
+    const char *file_end   = file_begin + mapped_file.size();
+    const char *next_chunk = file_begin;
+    // The callback may request to quit parsing, while the chunks are split and tokenized on other threads.
+    std::atomic<bool> parsing { true };
+    m_parsing = true;
+
+    const auto split = tbb::make_filter<void, std::shared_ptr<GCodeChunk>>(slic3r_tbb_filtermode::serial_in_order,
+        [&next_chunk, file_end, &parsing](tbb::flow_control &fc) -> std::shared_ptr<GCodeChunk> {
+            if (next_chunk == file_end || ! parsing) {
+                fc.stop();
+                return {};
+            }
+            auto chunk = std::make_shared<GCodeChunk>();
+            chunk->begin = next_chunk;
+            chunk->end   = (size_t(file_end - next_chunk) <= parallel_chunk_size) ? file_end : next_chunk + parallel_chunk_size;
+            // Extend the chunk up to the end of the line, including its "\r\n".
+            for (; chunk->end != file_end && *chunk->end != '\r' && *chunk->end != '\n'; ++ chunk->end);
+            if (chunk->end != file_end && *chunk->end == '\r')
+                ++ chunk->end;
+            if (chunk->end != file_end && *chunk->end == '\n')
+                ++ chunk->end;
+            next_chunk = chunk->end;
+            return chunk;
+        });
+
+    const auto tokenize = tbb::make_filter<std::shared_ptr<GCodeChunk>, std::shared_ptr<GCodeChunk>>(slic3r_tbb_filtermode::parallel,
+        [file_begin, file_end](std::shared_ptr<GCodeChunk> chunk) -> std::shared_ptr<GCodeChunk> {
+            // The last line of the file may miss its end of line, it is copied into a zero terminated buffer to not read past the mapped memory.
+            std::string last_line;
+            std::pair<const char*, const char*> command;
+            for (const char *it = chunk->begin; it != chunk->end;) {
+                const char *line_end = it;
+                for (; line_end != chunk->end && *line_end != '\r' && *line_end != '\n'; ++ line_end);
+                const char *begin = it;
+                const char *end   = line_end;
+                if (line_end == file_end) {
+                    last_line.assign(it, line_end);
+                    begin = last_line.c_str();
+                    end   = begin + last_line.size();
+                }
+                // Same as parse_file_internal(), skip the line number.
+                begin = skip_whitespaces(begin);
+                if (std::toupper(*begin) == 'N')
+                    begin = skip_word(begin);
+                begin = skip_whitespaces(begin);
+                chunk->lines.emplace_back();
+                tokenize_line(begin, end, chunk->lines.back(), command);
+                // Skip EOL.
+                it = line_end;
+                if (it != chunk->end && *it == '\r')
+                    ++ it;
+                if (it != chunk->end && *it == '\n')
+                    chunk->lines_ends.emplace_back(size_t(++ it - file_begin));
+            }
+            return chunk;
+        });
+
+    // The tokenized chunks are handed over to the calling thread in the order of the file. The callback is called from the calling thread,
+    // so that it runs with the numeric locale set by the caller and it may throw to cancel the parsing.
+    // Limit the number of chunks in flight to bound the memory used by the tokenized lines.
+    const size_t max_chunks = std::max<size_t>(4, 2 * std::thread::hardware_concurrency());
+    tbb::concurrent_bounded_queue<std::shared_ptr<GCodeChunk>> tokenized;
+    tokenized.set_capacity(max_chunks);
+    const auto hand_over = tbb::make_filter<std::shared_ptr<GCodeChunk>, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&tokenized](std::shared_ptr<GCodeChunk> chunk) { tokenized.push(std::move(chunk)); });
+
+    std::exception_ptr tokenizer_exception;
+    boost::thread tokenizer = create_thread([&]() {
+        try {
+            tbb::parallel_pipeline(max_chunks, split & tokenize & hand_over);
+        } catch (...) {
+            tokenizer_exception = std::current_exception();
+        }
+        // Marks the end of the file.
+        tokenized.push(nullptr);
+    });
+    // Stops the tokenizer and waits for it, the chunks already tokenized are dropped.
+    auto stop_tokenizer = [&tokenized, &tokenizer, &parsing]() {
+        parsing = false;
+        for (std::shared_ptr<GCodeChunk> chunk; ; ) {
+            tokenized.pop(chunk);
+            if (! chunk)
+                break;
+        }
+        tokenizer.join();
+    };
+
+    bool end_of_file = false;
+    try {
+        std::pair<const char*, const char*> command;
+        while (m_parsing) {
+            std::shared_ptr<GCodeChunk> chunk;
+            tokenized.pop(chunk);
+            if (! chunk) {
+                end_of_file = true;
+                break;
+            }
+            lines_ends.insert(lines_ends.end(), chunk->lines_ends.begin(), chunk->lines_ends.end());
+            for (GCodeLine &gline : chunk->lines) {
+                // The stateful part of parse_line(), see parse_line_internal().
+                if (gline.has(E) && m_config.use_relative_e_distances)
+                    m_position[E] = 0;
+                callback(*this, gline);
+                command.first  = skip_whitespaces(gline.m_raw.c_str());
+                command.second = skip_word(command.first);
+                update_coordinates(gline, command);
+                if (! m_parsing)
+                    break;
+            }
+        }
+    } catch (...) {
+        stop_tokenizer();
+        throw;
+    }
+    if (end_of_file)
+        tokenizer.join();
+    else
+        stop_tokenizer();
+    if (tokenizer_exception)
+        std::rethrow_exception(tokenizer_exception);
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  finished parse_file %1%") % file.c_str();
+    return true;
+}
+
 bool GCodeReader::GCodeLine::has(char axis) const
 {
     const char *c = m_raw.c_str();
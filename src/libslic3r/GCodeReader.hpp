@@ -2,6 +2,7 @@
 #define slic3r_GCodeReader_hpp_
 
 #include "libslic3r.h"
+#include <array>
 #include <cmath>
 #include <cstdlib>
 #include <functional>
@@ -96,6 +97,9 @@ public:
     
     GCodeReader() : m_verbose(false) { this->reset(); }
     void reset() { memset(m_position, 0, sizeof(m_position)); }
+    // BBS: Position of all axes, to be restored after a look-ahead pass over a G-code buffer.
+    std::array<float, NUM_AXES> position() const { std::array<float, NUM_AXES> out; memcpy(out.data(), m_position, sizeof(m_position)); return out; }
+    void set_position(const std::array<float, NUM_AXES> &position) { memcpy(m_position, position.data(), sizeof(m_position)); }
     void apply_config(const GCodeConfig &config);
     void apply_config(const DynamicPrintConfig &config);
 
@@ -136,6 +140,11 @@ public:
     bool parse_file(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends);
     // Just read the G-code file line by line, calls callback (const char *begin, const char *end). Returns false if reading the file failed.
     bool parse_file_raw(const std::string &file, raw_line_callback_t callback);
+    // BBS: Same as parse_file(file, callback, lines_ends), but the file is memory mapped and tokenized by multiple threads in chunks of lines.
+    // The callback is still called from the calling thread in the order of the lines, with the reader position updated exactly as by parse_file().
+    bool parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends);
+    // Each chunk of parse_file_parallel() holds roughly this many bytes of G-code, always ending at the end of a line.
+    static constexpr size_t parallel_chunk_size = 4 * 1024 * 1024;
 
     // To be called by the callback to stop parsing.
     void quit_parsing() { m_parsing = false; }
@@ -182,6 +191,8 @@ private:
     bool        parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
 
     const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
+    // Stateless part of parse_line_internal(), thus it may be called from multiple threads.
+    static const char* tokenize_line(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
     void        update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command);
 
     GCodeConfig m_config;
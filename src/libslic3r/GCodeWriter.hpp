@@ -4,6 +4,9 @@
 #include "libslic3r.h"
 #include <string>
 #include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include "Extruder.hpp"
 #include "Point.hpp"
 #include "PrintConfig.hpp"
@@ -199,34 +202,64 @@ public:
 //    static constexpr const int E_EXPORT_DIGITS    = 9;
 #endif
 
-    void emit_axis(const char axis, const double v, size_t digits);
+    // BBS: Emit " <axis><v>" with v rounded to Digits decimal places, trailing zeros and the leading zero of |v| < 1 omitted
+    // (0.5 -> ".5", -0.001 -> "-.001", 2.0 -> "2", 0 -> "0").
+    // The number of decimal places is a compile time constant, thus the scaling and the splitting of the rounded fixed point
+    // value into its integer and fractional part compile to multiplications by constants, no generic float to text conversion is involved.
+    template<int Digits>
+    void emit_axis(const char axis, const double v) {
+        static_assert(Digits >= 0 && Digits <= 9, "emit_axis: unsupported number of decimal places");
+        constexpr const uint64_t scale = pow_10(Digits);
+        char *ptr = this->ptr_err.ptr;
+        *ptr ++ = ' '; *ptr ++ = axis;
+        const int64_t v_int = int64_t(std::round(v * double(scale)));
+        if (v_int < 0)
+            *ptr ++ = '-';
+        const uint64_t v_abs     = v_int < 0 ? uint64_t(0) - uint64_t(v_int) : uint64_t(v_int);
+        const uint64_t int_part  = v_abs / scale;
+        uint64_t       frac_part = v_abs % scale;
+        if (int_part > 0)
+            ptr = emit_uint(ptr, int_part);
+        else if (frac_part == 0)
+            *ptr ++ = '0';
+        if (frac_part > 0) {
+            int num_digits = Digits;
+            for (; frac_part % 10 == 0; -- num_digits)
+                frac_part /= 10;
+            *ptr ++ = '.';
+            for (char *p = ptr + num_digits; p != ptr; frac_part /= 10)
+                *-- p = char('0' + frac_part % 10);
+            ptr += num_digits;
+        }
+        this->ptr_err.ptr = ptr;
+    }
 
     void emit_xy(const Vec2d &point) {
-        this->emit_axis('X', point.x(), XYZF_EXPORT_DIGITS);
-        this->emit_axis('Y', point.y(), XYZF_EXPORT_DIGITS);
+        this->emit_axis<XYZF_EXPORT_DIGITS>('X', point.x());
+        this->emit_axis<XYZF_EXPORT_DIGITS>('Y', point.y());
     }
 
     void emit_xyz(const Vec3d &point) {
-        this->emit_axis('X', point.x(), XYZF_EXPORT_DIGITS);
-        this->emit_axis('Y', point.y(), XYZF_EXPORT_DIGITS);
+        this->emit_axis<XYZF_EXPORT_DIGITS>('X', point.x());
+        this->emit_axis<XYZF_EXPORT_DIGITS>('Y', point.y());
         this->emit_z(point.z());
     }
 
     void emit_z(const double z) {
-        this->emit_axis('Z', z, XYZF_EXPORT_DIGITS);
+        this->emit_axis<XYZF_EXPORT_DIGITS>('Z', z);
     }
 
     void emit_e(double v) {
-        this->emit_axis('E', v, E_EXPORT_DIGITS);
+        this->emit_axis<E_EXPORT_DIGITS>('E', v);
     }
 
     void emit_f(double speed) {
-        this->emit_axis('F', speed, XYZF_EXPORT_DIGITS);
+        this->emit_axis<XYZF_EXPORT_DIGITS>('F', speed);
     }
     //BBS
     void emit_ij(const Vec2d &point) {
-        this->emit_axis('I', point.x(), XYZF_EXPORT_DIGITS);
-        this->emit_axis('J', point.y(), XYZF_EXPORT_DIGITS);
+        this->emit_axis<XYZF_EXPORT_DIGITS>('I', point.x());
+        this->emit_axis<XYZF_EXPORT_DIGITS>('J', point.y());
     }
 
     void emit_string(const std::string &s) {
@@ -247,6 +280,21 @@ public:
     }
 
 protected:
+    static constexpr uint64_t pow_10(int n) { return n == 0 ? 1 : 10 * pow_10(n - 1); }
+
+    // Write the decimal digits of v, returns the end of the written digits.
+    static char* emit_uint(char *ptr, uint64_t v) {
+        char  digits[20];
+        char *end = digits + sizeof(digits);
+        char *p   = end;
+        do {
+            *-- p = char('0' + v % 10);
+            v /= 10;
+        } while (v > 0);
+        memcpy(ptr, p, end - p);
+        return ptr + (end - p);
+    }
+
     static constexpr const size_t   buflen = 256;
     char                            buf[buflen];
     char* buf_end;
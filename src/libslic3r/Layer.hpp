@@ -19,6 +19,7 @@ class LayerRegion;
 using LayerRegionPtrs = std::vector<LayerRegion*>;
 class PrintRegion;
 class PrintObject;
+class FillCache;
 struct PerimeterRegion;
 using PerimeterRegions = std::vector<PerimeterRegion>;
 
@@ -196,7 +197,7 @@ public:
     void                    recrod_cooling_node_for_each_extrusion();
     // Phony version of make_fills() without parameters for Perl integration only.
     void                    make_fills() { this->make_fills(nullptr, nullptr); }
-    void                    make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree, FillLightning::Generator* lightning_generator = nullptr);
+    void                    make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree, FillLightning::Generator* lightning_generator = nullptr, FillCache* fill_cache = nullptr);
     Polylines               generate_sparse_infill_polylines_for_anchoring(FillAdaptive::Octree *adaptive_fill_octree,
         FillAdaptive::Octree *support_fill_octree,
         FillLightning::Generator* lightning_generator) const;
@@ -3089,17 +3089,14 @@ std::vector<int> ModelVolume::get_extruders() const
         return std::vector<int>();
 
     if (mmu_segmentation_facets.timestamp() != mmuseg_ts) {
-        std::vector<indexed_triangle_set> its_per_type;
         mmuseg_extruders.clear();
         mmuseg_ts = mmu_segmentation_facets.timestamp();
-        mmu_segmentation_facets.get_facets(*this, its_per_type);
-        for (int idx = 1; idx < its_per_type.size(); idx++) {
-            indexed_triangle_set& its = its_per_type[idx];
-            if (its.indices.empty())
-                continue;
-
-            mmuseg_extruders.push_back(idx);
-        }
+        //BBS: read the painted states from the serialized data, expanding the split trees of a heavily painted volume
+        // just to collect the painted states used to dominate loading of a project.
+        EnforcerBlockerStates used_states = mmu_segmentation_facets.get_used_states();
+        for (int idx = 1; idx < int(used_states.size()); idx++)
+            if (used_states.test(idx))
+                mmuseg_extruders.push_back(idx);
     }
 
     std::vector<int> volume_extruders = mmuseg_extruders;
@@ -4142,9 +4139,14 @@ bool FacetsAnnotation::has_facets(const ModelVolume& mv, EnforcerBlockerType typ
     return TriangleSelector::has_facets(m_data, type);
 }
 
+EnforcerBlockerStates FacetsAnnotation::get_used_states() const
+{
+    return TriangleSelector::get_used_states(m_data);
+}
+
 bool FacetsAnnotation::set(const TriangleSelector& selector)
 {
-    std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> sel_map = selector.serialize();
+    TriangleSplittingData sel_map = selector.serialize();
     if (sel_map != m_data) {
         m_data = std::move(sel_map);
         this->touch();
@@ -4155,8 +4157,7 @@ bool FacetsAnnotation::set(const TriangleSelector& selector)
 
 void FacetsAnnotation::reset()
 {
-    m_data.first.clear();
-    m_data.second.clear();
+    m_data.clear();
     this->touch();
 }
 
@@ -4167,21 +4168,16 @@ std::string FacetsAnnotation::get_triangle_as_string(int triangle_idx) const
 {
     std::string out;
 
-    auto triangle_it = std::lower_bound(m_data.first.begin(), m_data.first.end(), triangle_idx, [](const std::pair<int, int> &l, const int r) { return l.first < r; });
-    if (triangle_it != m_data.first.end() && triangle_it->first == triangle_idx) {
+    auto triangle_it = std::lower_bound(m_data.triangles_to_split.begin(), m_data.triangles_to_split.end(), triangle_idx, [](const std::pair<int, int> &l, const int r) { return l.first < r; });
+    if (triangle_it != m_data.triangles_to_split.end() && triangle_it->first == triangle_idx) {
         int offset = triangle_it->second;
-        int end    = ++ triangle_it == m_data.first.end() ? int(m_data.second.size()) : triangle_it->second;
-        while (offset < end) {
-            int next_code = 0;
-            for (int i=3; i>=0; --i) {
-                next_code = next_code << 1;
-                next_code |= int(m_data.second[offset + i]);
-            }
-            offset += 4;
-
+        int end    = ++ triangle_it == m_data.triangles_to_split.end() ? m_data.num_codes : triangle_it->second;
+        // One hexadecimal digit per code, the first code stored as the last digit.
+        out.resize(size_t(end - offset));
+        for (auto it = out.rbegin(); offset < end; ++ it, ++ offset) {
+            int next_code = m_data.code(offset);
             assert(next_code >=0 && next_code <= 15);
-            char digit = next_code < 10 ? next_code + '0' : (next_code-10)+'A';
-            out.insert(out.begin(), digit);
+            *it = next_code < 10 ? next_code + '0' : (next_code-10)+'A';
         }
     }
     return out;
@@ -4192,8 +4188,8 @@ std::string FacetsAnnotation::get_triangle_as_string(int triangle_idx) const
 void FacetsAnnotation::set_triangle_from_string(int triangle_id, const std::string& str)
 {
     assert(! str.empty());
-    assert(m_data.first.empty() || m_data.first.back().first < triangle_id);
-    m_data.first.emplace_back(triangle_id, int(m_data.second.size()));
+    assert(m_data.triangles_to_split.empty() || m_data.triangles_to_split.back().first < triangle_id);
+    m_data.triangles_to_split.emplace_back(triangle_id, m_data.num_codes);
 
     for (auto it = str.crbegin(); it != str.crend(); ++it) {
         const char ch = *it;
@@ -4205,16 +4201,13 @@ void FacetsAnnotation::set_triangle_from_string(int triangle_id, const std::stri
         else
             assert(false);
 
-        // Convert to binary and append into code.
-        for (int i=0; i<4; ++i)
-            m_data.second.insert(m_data.second.end(), bool(dec & (1 << i)));
+        m_data.push_code(dec);
     }
 }
 
 bool FacetsAnnotation::equals(const FacetsAnnotation &other) const
 {
-    const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>>& data = other.get_data();
-    return (m_data == data);
+    return m_data == other.get_data();
 }
 
 // Test whether the two models contain the same number of ModelObjects with the same set of IDs
@@ -27,6 +27,7 @@
 
 #include "Calib.hpp"
 
+#include <bitset>
 #include <map>
 #include <memory>
 #include <string>
@@ -764,12 +765,48 @@ enum class En3mfType : int {
     From_Other
 };
 
+// Set of EnforcerBlockerType states, indexed by the state.
+using EnforcerBlockerStates = std::bitset<size_t(EnforcerBlockerType::ExtruderMax) + 1>;
+
+// Painting of a volume in the compact form produced by TriangleSelector::serialize().
+// The split tree of each painted triangle of the source mesh is stored depth first as a sequence of 4 bit codes,
+// see TriangleSelector::serialize() for the encoding. All the codes are nibble aligned, thus they are packed
+// two per byte and decoded a whole code at a time instead of bit by bit.
+struct TriangleSplittingData
+{
+    // Pairs of (index of a triangle of the source mesh, index of the first code of its split tree), sorted by the triangle index.
+    std::vector<std::pair<int, int>> triangles_to_split;
+    // Codes packed two per byte, the first code in the low nibble.
+    std::vector<uint8_t>             codes;
+    int                              num_codes { 0 };
+
+    int  code(int idx) const { assert(idx >= 0 && idx < num_codes); return (codes[idx >> 1] >> ((idx & 1) << 2)) & 0x0F; }
+    void push_code(int code)
+    {
+        assert(code >= 0 && code <= 15);
+        if (num_codes & 1)
+            codes.back() |= uint8_t(code << 4);
+        else
+            codes.emplace_back(uint8_t(code));
+        ++ num_codes;
+    }
+
+    bool empty() const { return triangles_to_split.empty(); }
+    void clear() { triangles_to_split.clear(); codes.clear(); num_codes = 0; }
+    void shrink_to_fit() { triangles_to_split.shrink_to_fit(); codes.shrink_to_fit(); }
+
+    bool operator==(const TriangleSplittingData &rhs) const { return num_codes == rhs.num_codes && triangles_to_split == rhs.triangles_to_split && codes == rhs.codes; }
+    bool operator!=(const TriangleSplittingData &rhs) const { return ! (*this == rhs); }
+
+    template<class Archive> void serialize(Archive &ar) { ar(triangles_to_split, codes, num_codes); }
+};
+
 class FacetsAnnotation final : public ObjectWithTimestamp {
 public:
     // Assign the content if the timestamp differs, don't assign an ObjectID.
     void assign(const FacetsAnnotation& rhs) { if (! this->timestamp_matches(rhs)) { m_data = rhs.m_data; this->copy_timestamp(rhs); } }
     void assign(FacetsAnnotation&& rhs) { if (! this->timestamp_matches(rhs)) { m_data = std::move(rhs.m_data); this->copy_timestamp(rhs); } }
-    const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>>& get_data() const throw() { return m_data; }
+    const TriangleSplittingData& get_data() const throw() { return m_data; }
     bool set(const TriangleSelector& selector);
     indexed_triangle_set get_facets(const ModelVolume& mv, EnforcerBlockerType type) const;
     // BBS
@@ -780,7 +817,9 @@ public:
                                                        EnforcerBlockerType replace_filament = EnforcerBlockerType::NONE);
     indexed_triangle_set get_facets_strict(const ModelVolume& mv, EnforcerBlockerType type) const;
     bool has_facets(const ModelVolume& mv, EnforcerBlockerType type) const;
-    bool empty() const { return m_data.first.empty(); }
+    // States painted on any facet, read from the serialized split trees without expanding them.
+    EnforcerBlockerStates get_used_states() const;
+    bool empty() const { return m_data.empty(); }
 
     // Following method clears the config and increases its timestamp, so the deleted
     // state is considered changed from perspective of the undo/redo stack.
@@ -790,11 +829,11 @@ public:
     std::string get_triangle_as_string(int i) const;
 
     // Before deserialization, reserve space for n_triangles.
-    void reserve(int n_triangles) { m_data.first.reserve(n_triangles); }
+    void reserve(int n_triangles) { m_data.triangles_to_split.reserve(n_triangles); }
     // Deserialize triangles one by one, with strictly increasing triangle_id.
     void set_triangle_from_string(int triangle_id, const std::string& str);
     // After deserializing the last triangle, shrink data to fit.
-    void shrink_to_fit() { m_data.first.shrink_to_fit(); m_data.second.shrink_to_fit(); }
+    void shrink_to_fit() { m_data.shrink_to_fit(); }
     bool equals(const FacetsAnnotation &other) const;
 
 private:
@@ -821,7 +860,7 @@ private:
         ar(cereal::base_class<ObjectWithTimestamp>(this), m_data);
     }
 
-    std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> m_data;
+    TriangleSplittingData m_data;
 
     // To access set_new_unique_id() when copy / pasting a ModelVolume.
     friend class ModelVolume;
@@ -8,6 +8,8 @@
 #include "MutablePolygon.hpp"
 #include "format.hpp"
 
+#include <atomic>
+#include <tuple>
 #include <utility>
 #include <unordered_set>
 
@@ -2077,6 +2079,95 @@ static void export_colorized_polygons_to_svg(const std::string &path, const std:
 }
 #endif // MM_SEGMENTATION_DEBUG_COLORIZED_POLYGONS
 
+bool MMUSegmentationCache::find(const LayerInput &input, std::vector<ExPolygons> &regions)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(input.hash);
+    // The hash may collide, a layer is taken from the cache only if its whole input matches.
+    if (it == m_entries.end() || it->second.input.num_extruders != input.num_extruders ||
+        it->second.input.expolygons != input.expolygons || it->second.input.painted_lines != input.painted_lines)
+        return false;
+    it->second.last_run = m_run;
+    regions             = it->second.regions;
+    return true;
+}
+
+void MMUSegmentationCache::insert(LayerInput &&input, const std::vector<ExPolygons> &regions)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // A colliding entry of another input is replaced.
+    const uint64_t hash = input.hash;
+    m_entries[hash] = { std::move(input), regions, m_run };
+}
+
+void MMUSegmentationCache::next_run()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++ m_run;
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+        if (it->second.last_run + MAX_UNUSED_RUNS < m_run)
+            it = m_entries.erase(it);
+        else
+            ++ it;
+}
+
+size_t MMUSegmentationCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+// Input of a layer in MMUSegmentationCache: the segmentation of a layer depends just on its input expolygons
+// (the EdgeGrid contours are built from them) and on the painted lines projected onto the layer.
+static MMUSegmentationCache::LayerInput mmu_segmentation_layer_input(const ExPolygons &input_expolygons, const std::vector<PaintedLine> &painted_lines, const size_t num_extruders)
+{
+    MMUSegmentationCache::LayerInput input;
+    input.num_extruders = num_extruders;
+    input.expolygons    = input_expolygons;
+    // The painted lines are collected in parallel, thus their order is not deterministic.
+    input.painted_lines.reserve(painted_lines.size());
+    for (const PaintedLine &line : painted_lines)
+        input.painted_lines.push_back({ line.contour_idx, line.line_idx, line.projected_line, line.color });
+    auto line_tuple = [](const MMUSegmentationCache::PaintedLine &l) {
+        return std::make_tuple(l.contour_idx, l.line_idx, l.projected_line.a.x(), l.projected_line.a.y(), l.projected_line.b.x(), l.projected_line.b.y(), l.color);
+    };
+    std::sort(input.painted_lines.begin(), input.painted_lines.end(),
+        [&line_tuple](const MMUSegmentationCache::PaintedLine &l, const MMUSegmentationCache::PaintedLine &r) { return line_tuple(l) < line_tuple(r); });
+
+    uint64_t hash = 14695981039346656037ull;
+    auto update = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    auto update_points = [&update](const Points &points) {
+        update(points.size());
+        for (const Point &pt : points) {
+            update(uint64_t(pt.x()));
+            update(uint64_t(pt.y()));
+        }
+    };
+    update(num_extruders);
+    update(input.expolygons.size());
+    for (const ExPolygon &expoly : input.expolygons) {
+        update_points(expoly.contour.points);
+        update(expoly.holes.size());
+        for (const Polygon &hole : expoly.holes)
+            update_points(hole.points);
+    }
+    update(input.painted_lines.size());
+    for (const MMUSegmentationCache::PaintedLine &line : input.painted_lines) {
+        update(line.contour_idx);
+        update(line.line_idx);
+        update(uint64_t(line.projected_line.a.x()));
+        update(uint64_t(line.projected_line.a.y()));
+        update(uint64_t(line.projected_line.b.x()));
+        update(uint64_t(line.projected_line.b.y()));
+        update(uint64_t(line.color));
+    }
+    input.hash = hash;
+    return input;
+}
+
 // Check if all ColoredLine representing a single layer uses the same color.
 static bool has_layer_only_one_color(const std::vector<ColoredLines> &colored_polygons)
 {
@@ -2102,6 +2193,10 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
     std::vector<EdgeGrid::Grid>           edge_grids(num_layers);
     const ConstLayerPtrsAdaptor           layers = print_object.layers();
     std::vector<ExPolygons>               input_expolygons(num_layers);
+    // BBS: layers whose input did not change since the last run are not segmented again.
+    MMUSegmentationCache                 *cache = print_object.shared_regions() != nullptr ? print_object.shared_regions()->mmu_segmentation_cache.get() : nullptr;
+    if (cache != nullptr)
+        cache->next_run();
 
     throw_on_cancel_callback();
 
@@ -2267,10 +2362,20 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                              << std::count_if(painted_lines.begin(), painted_lines.end(), [](const std::vector<PaintedLine> &pl) { return !pl.empty(); });
 
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - layers segmentation in parallel - begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_extruders, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    std::atomic<size_t> num_cached_layers { 0 };
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_extruders, cache, &num_cached_layers, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
             throw_on_cancel_callback();
             if (!painted_lines[layer_idx].empty()) {
+                MMUSegmentationCache::LayerInput cache_input;
+                if (cache != nullptr) {
+                    cache_input = mmu_segmentation_layer_input(input_expolygons[layer_idx], painted_lines[layer_idx], num_extruders);
+                    if (cache->find(cache_input, segmented_regions[layer_idx])) {
+                        ++ num_cached_layers;
+                        continue;
+                    }
+                }
+
 #ifdef MM_SEGMENTATION_DEBUG_PAINTED_LINES
                 export_painted_lines_to_svg(debug_out_path("0-mm-painted-lines-%d-%d.svg", layer_idx, iRun), {painted_lines[layer_idx]}, input_expolygons[layer_idx]);
 #endif // MM_SEGMENTATION_DEBUG_PAINTED_LINES
@@ -2299,6 +2404,8 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                     segmented_regions[layer_idx] = extract_colored_segments(graph, num_extruders);
                     //segmented_regions[layer_idx] = extract_colored_segments(color_poly, num_extruders, layer_idx);
                 }
+                if (cache != nullptr)
+                    cache->insert(std::move(cache_input), segmented_regions[layer_idx]);
 
 #ifdef MM_SEGMENTATION_DEBUG_REGIONS
                 export_regions_to_svg(debug_out_path("3-mm-regions-sides-%d-%d.svg", layer_idx, iRun), segmented_regions[layer_idx], input_expolygons[layer_idx]);
@@ -2306,7 +2413,7 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
             }
         }
     }); // end of parallel_for
-    BOOST_LOG_TRIVIAL(debug) << "MM segmentation - layers segmentation in parallel - end";
+    BOOST_LOG_TRIVIAL(debug) << "MM segmentation - layers segmentation in parallel - end, layers reused from the cache: " << num_cached_layers.load();
     throw_on_cancel_callback();
 
     auto interlocking_beam = print_object.config().interlocking_beam;
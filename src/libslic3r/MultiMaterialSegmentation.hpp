@@ -1,6 +1,9 @@
 #ifndef slic3r_MultiMaterialSegmentation_hpp_
 #define slic3r_MultiMaterialSegmentation_hpp_
 
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -20,6 +23,56 @@ struct ColoredLine
 
 using ColoredLines = std::vector<ColoredLine>;
 
+// BBS: segmentation of the painted layers kept between the slicing runs of an object. A layer is segmented again only
+// if its input slices or the painted lines projected onto it changed, thus a paint stroke on a small area of a tall object
+// segments just the layers touched by the stroke. The entries are keyed by the layer content, so the cache
+// may be shared by all the PrintObjects of a ModelObject and it never needs to be invalidated. Entries unused
+// by the last few segmentation runs are dropped.
+class MMUSegmentationCache
+{
+public:
+    // Painted line projected onto a layer, see PaintedLine in MultiMaterialSegmentation.cpp.
+    struct PaintedLine
+    {
+        size_t contour_idx;
+        size_t line_idx;
+        Line   projected_line;
+        int    color;
+
+        bool operator==(const PaintedLine &rhs) const {
+            return contour_idx == rhs.contour_idx && line_idx == rhs.line_idx && projected_line == rhs.projected_line && color == rhs.color;
+        }
+    };
+    // The segmentation of a layer depends just on its input expolygons and on the painted lines projected onto it.
+    struct LayerInput
+    {
+        size_t                   num_extruders { 0 };
+        ExPolygons               expolygons;
+        // Sorted, as the painted lines are collected in parallel.
+        std::vector<PaintedLine> painted_lines;
+        // Hash of the above, the entries are looked up by the hash and compared as a whole.
+        uint64_t                 hash { 0 };
+    };
+
+    // Regions per extruder of a layer, see multi_material_segmentation_by_painting().
+    bool find(const LayerInput &input, std::vector<ExPolygons> &regions);
+    void insert(LayerInput &&input, const std::vector<ExPolygons> &regions);
+    // To be called at the start of a segmentation run.
+    void next_run();
+    size_t size() const;
+
+private:
+    static constexpr size_t MAX_UNUSED_RUNS = 4;
+    struct Entry {
+        LayerInput              input;
+        std::vector<ExPolygons> regions;
+        size_t                  last_run;
+    };
+    mutable std::mutex                  m_mutex;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    size_t                              m_run { 0 };
+};
+
 // Returns MMU segmentation based on painting in MMU segmentation gizmo
 std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
 
@@ -16,6 +16,8 @@
 #include "Utils.hpp"
 #include "PrintConfig.hpp"
 #include "Model.hpp"
+#include "PrintCache.hpp"
+#include "Profiler.hpp"
 #include <float.h>
 
 #include <algorithm>
@@ -1676,6 +1678,7 @@ std::map<ObjectID, unsigned int> getObjectExtruderMap(const Print& print) {
 // Slicing process, running at a background thread.
 void Print::process(std::unordered_map<std::string, long long>* slice_time, bool use_cache)
 {
+    SLIC3R_PROFILE_ZONE("Print::process");
     long long start_time = 0, end_time = 0;
     if (slice_time) {
         (*slice_time)[TIME_USING_CACHE] = 0;
@@ -1919,6 +1922,7 @@ void Print::process(std::unordered_map<std::string, long long>* slice_time, bool
 
 
     if (this->set_started(psWipeTower)) {
+        SLIC3R_PROFILE_ZONE("Print::wipe_tower");
         {
             std::vector<std::set<int>> geometric_unprintables(m_config.nozzle_diameter.size());
             for (PrintObject* obj : m_objects) {
@@ -1953,6 +1957,7 @@ void Print::process(std::unordered_map<std::string, long long>* slice_time, bool
     }
 
     if (this->set_started(psSkirtBrim)) {
+        SLIC3R_PROFILE_ZONE("Print::skirt_brim");
         this->set_status(70, L("Generating skirt & brim"));
 
         if (slice_time) {
@@ -2110,6 +2115,7 @@ void Print::process(std::unordered_map<std::string, long long>* slice_time, bool
     }
     if(!m_no_check /*&& !has_adaptive_layer_height*/)
     {
+        SLIC3R_PROFILE_ZONE("Print::check_conflicts");
         using Clock                 = std::chrono::high_resolution_clock;
         auto            startTime   = Clock::now();
         std::optional<const FakeWipeTower *> wipe_tower_opt = {};
@@ -2150,6 +2156,7 @@ std::string Print::export_gcode(const std::string& path_template, GCodeProcessor
         message = L("Generating G-code");
     this->set_status(80, message);
 
+    SLIC3R_PROFILE_ZONE("Print::export_gcode");
     // The following line may die for multiple reasons.
     GCode gcode;
     //BBS: compute plate offset for gcode-generator
@@ -3795,6 +3802,7 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
     int count = 0;
     std::vector<std::string> filename_vector;
     std::vector<json> json_vector;
+    std::vector<std::pair<const PrintObject*, size_t>> binary_objects;
     for (PrintObject *obj : m_objects) {
         const ModelObject* model_obj = obj->model_object();
         if (obj->get_shared_object()) {
@@ -3805,6 +3813,13 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         const PrintInstance &print_instance = obj->instances()[0];
         const ModelInstance *model_instance = print_instance.model_instance;
         size_t identify_id = (model_instance->loaded_id > 0)?model_instance->loaded_id: model_instance->id().id;
+
+        //BBS: use the compact binary format by default, the readable json is only dumped for debugging
+        if (!with_space) {
+            binary_objects.emplace_back(obj, identify_id);
+            count ++;
+            continue;
+        }
         std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
 
         BOOST_LOG_TRIVIAL(info) << boost::format("begin to dump object %1%, identify_id %2% to %3%")%model_obj->name %identify_id %file_name;
@@ -3966,6 +3981,13 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         }
     }
 
+    //the binary export is parallel over the layers of each object
+    for (const std::pair<const PrintObject*, size_t>& binary_object : binary_objects) {
+        int object_ret = PrintCache::export_object(*binary_object.first, binary_object.second, PrintCache::binary_file_name(directory, binary_object.second));
+        if (object_ret)
+            ret = object_ret;
+    }
+
     boost::mutex mutex;
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, filename_vector.size()),
@@ -4015,9 +4037,16 @@ int Print::load_cached_data(const std::string& directory)
         }
         return NULL;
     };
+    //BBS: release the layers of an object, which failed to load, instead of leaving a partial slicing result behind
+    auto release_layers = [](PrintObject* object) {
+        object->clear_layers();
+        object->clear_support_layers();
+        object->firstLayerObjGroupsMod().clear();
+    };
 
     int count = 0;
     std::vector<std::pair<std::string, PrintObject*>> object_filenames;
+    std::vector<std::pair<std::string, PrintObject*>> binary_objects;
     for (PrintObject *obj : m_objects) {
         const ModelObject* model_obj = obj->model_object();
         const PrintInstance &print_instance = obj->instances()[0];
@@ -4033,6 +4062,13 @@ int Print::load_cached_data(const std::string& directory)
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": object %1%'s loaded_id is 0, need to use the instance_id %2%")%model_obj->name %identify_id;
             //continue;
         }
+        //BBS: prefer the binary cache, fall back to the json one exported by older versions or in debug mode
+        std::string binary_file_name = PrintCache::binary_file_name(directory, identify_id);
+        if (fs::exists(binary_file_name)) {
+            binary_objects.push_back({binary_file_name, obj});
+            continue;
+        }
+
         std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
 
         if (!fs::exists(file_name)) {
@@ -4042,6 +4078,15 @@ int Print::load_cached_data(const std::string& directory)
         object_filenames.push_back({file_name, obj});
     }
 
+    for (const std::pair<std::string, PrintObject*>& binary_object : binary_objects) {
+        ret = PrintCache::load_object(*binary_object.second, binary_object.first);
+        if (ret) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": load %1% failed, ret=%2%")%binary_object.first %ret;
+            return ret;
+        }
+        count ++;
+    }
+
     boost::mutex mutex;
     std::vector<json> object_jsons(object_filenames.size());
     tbb::parallel_for(
@@ -4095,6 +4140,7 @@ int Print::load_cached_data(const std::string& directory)
                 Layer* new_layer = obj->add_layer(layer_json[JSON_LAYER_ID], layer_json[JSON_LAYER_HEIGHT], layer_json[JSON_LAYER_PRINT_Z], layer_json[JSON_LAYER_SLICE_Z]);
                 if (!new_layer) {
                     BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":create_layer failed, out of memory");
+                    release_layers(obj);
                     return CLI_OUT_OF_MEMORY;
                 }
                 if (previous_layer) {
@@ -4114,7 +4160,7 @@ int Print::load_cached_data(const std::string& directory)
                     if (!print_region){
                         BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":can not find print region of object %1%, layer %2%, print_z %3%, layer_region %4%")
                             %name % index %new_layer->print_z %region_index;
-                        //delete new_layer;
+                        release_layers(obj);
                         return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
                     }
 
@@ -4145,6 +4191,7 @@ int Print::load_cached_data(const std::string& directory)
                 SupportLayer* new_support_layer = obj->add_support_layer(layer_json[JSON_LAYER_ID], layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID], layer_json[JSON_LAYER_HEIGHT], layer_json[JSON_LAYER_PRINT_Z]);
                 if (!new_support_layer) {
                     BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":add_support_layer failed, out of memory");
+                    release_layers(obj);
                     return CLI_OUT_OF_MEMORY;
                 }
                 if (previous_support_layer) {
@@ -4185,6 +4232,7 @@ int Print::load_cached_data(const std::string& directory)
                     else {
                         BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": can not find volume_id %1% from object file %2% in firstlayer groups, volume_count %3%!")
                             %obj_id.id %object_filenames[obj_index].first %volume_count;
+                        release_layers(obj);
                         return CLI_IMPORT_CACHE_LOAD_FAILED;
                     }
                 }
@@ -4196,10 +4244,12 @@ int Print::load_cached_data(const std::string& directory)
         }
         catch(nlohmann::detail::parse_error &err) {
             BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": parse "<<object_filenames[obj_index].first<<" got a nlohmann::detail::parse_error, reason = " << err.what();
+            release_layers(obj);
             return CLI_IMPORT_CACHE_LOAD_FAILED;
         }
         catch(std::exception &err) {
             BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": load from "<<object_filenames[obj_index].first<<" got a generic exception, reason = " << err.what();
+            release_layers(obj);
             ret = CLI_IMPORT_CACHE_LOAD_FAILED;
         }
     }
@@ -4210,6 +4260,115 @@ int Print::load_cached_data(const std::string& directory)
     return ret;
 }
 
+int Print::export_step_cache(const std::string& directory)
+{
+    boost::filesystem::path directory_path(directory);
+    try {
+        if (!fs::exists(directory_path) && !fs::create_directories(directory_path)) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": create directory %1% failed")%directory;
+            return CLI_EXPORT_CACHE_DIRECTORY_CREATE_FAILED;
+        }
+    }
+    catch (...)
+    {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": create directory %1% failed")%directory;
+        return CLI_EXPORT_CACHE_DIRECTORY_CREATE_FAILED;
+    }
+
+    std::vector<std::pair<const PrintObject*, std::string>> objects;
+    for (const PrintObject *obj : m_objects) {
+        if (obj->get_shared_object() || !obj->is_step_done(posSlice))
+            continue;
+        objects.emplace_back(obj, PrintCache::step_cache_file_name(directory, PrintCache::object_geometry_hash(*obj)));
+    }
+
+    int ret = 0;
+    for (const std::pair<const PrintObject*, std::string>& object : objects) {
+        //write into a temporary file first, so that a concurrent reader never sees a partially written entry
+        std::string temp_file_name = object.second + ".tmp";
+        const ModelInstance *model_instance = object.first->instances()[0].model_instance;
+        size_t identify_id = (model_instance->loaded_id > 0)?model_instance->loaded_id: model_instance->id().id;
+        ret = PrintCache::export_object(*object.first, identify_id, temp_file_name);
+        if (ret == 0) {
+            boost::system::error_code ec;
+            fs::rename(temp_file_name, object.second, ec);
+            if (ec) {
+                BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": rename %1% failed, %2%")%temp_file_name %ec.message();
+                ret = CLI_EXPORT_CACHE_WRITE_FAILED;
+            }
+        }
+        if (ret) {
+            boost::system::error_code ec;
+            fs::remove(temp_file_name, ec);
+            return ret;
+        }
+    }
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": exported %1% objects into step cache %2%")%objects.size() %directory;
+    return ret;
+}
+
+int Print::load_step_cache(const std::string& directory)
+{
+    if (!fs::exists(boost::filesystem::path(directory))) {
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": directory %1% not exist.")%directory;
+        return CLI_IMPORT_CACHE_NOT_FOUND;
+    }
+
+    int count = 0;
+    std::set<uint64_t> loaded_hashes;
+    for (PrintObject *obj : m_objects) {
+        uint64_t geometry_hash = PrintCache::object_geometry_hash(*obj);
+        //objects with the same geometry are usually shared by process(), only load the first one
+        if (obj->is_step_done(posSlice) || !loaded_hashes.insert(geometry_hash).second)
+            continue;
+        std::string file_name = PrintCache::step_cache_file_name(directory, geometry_hash);
+        if (!fs::exists(file_name))
+            continue;
+
+        obj->clear_layers();
+        obj->clear_support_layers();
+        PrintCache::CachedState state;
+        int ret = PrintCache::load_object(*obj, file_name, false, &state);
+        if (ret || !state.is_step_done(posSlice)) {
+            BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": can not reuse %1%, ret=%2%, slice from scratch")%file_name %ret;
+            obj->clear_layers();
+            obj->clear_support_layers();
+            continue;
+        }
+
+        for (int step = 0; step < posCount; ++ step)
+            if (state.is_step_done(PrintObjectStep(step)) && obj->set_started(PrintObjectStep(step)))
+                obj->set_done(PrintObjectStep(step));
+        obj->m_typed_slices = state.is_step_done(posPrepareInfill);
+        obj->m_prepare_infill_from_cache = state.is_step_done(posPrepareInfill);
+
+        //invalidate whatever depends on the configuration values changed since the cache was written
+        {
+            std::scoped_lock<std::mutex> lock(this->state_mutex());
+            t_config_option_keys diff = obj->config().diff(state.object_config);
+            if (!diff.empty())
+                obj->invalidate_state_by_config_options(state.object_config, obj->config(), diff);
+            for (size_t region_id = 0; region_id < obj->num_printing_regions(); ++ region_id) {
+                const PrintRegionConfig &region_config = obj->printing_region(region_id).config();
+                diff = region_config.diff(state.region_configs[region_id]);
+                if (!diff.empty())
+                    obj->invalidate_state_by_config_options(state.region_configs[region_id], region_config, diff);
+            }
+            diff = m_config.diff(state.print_config);
+            if (!diff.empty())
+                this->invalidate_state_by_config_options(m_config, diff);
+            // posInfill needs the infill data of posPrepareInfill, which is not cached.
+            if (obj->is_step_done(posPrepareInfill) && !obj->is_step_done(posInfill))
+                obj->invalidate_step(posPrepareInfill);
+        }
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": object %1% restored from %2%, steps done: posSlice %3%, posPerimeters %4%, posInfill %5%, posSupportMaterial %6%")
+            %obj->model_object()->name %file_name %obj->is_step_done(posSlice) %obj->is_step_done(posPerimeters) %obj->is_step_done(posInfill) %obj->is_step_done(posSupportMaterial);
+        count ++;
+    }
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": reused %1% of %2% objects from step cache %3%")%count %m_objects.size() %directory;
+    return 0;
+}
+
 BoundingBoxf3 PrintInstance::get_bounding_box() const {
     return print_object->model_object()->instance_bounding_box(*model_instance, false);
 }
@@ -37,6 +37,7 @@ class SupportLayer;
 class TreeSupportData;
 class TreeSupport;
 class ExtrusionLayers;
+class MMUSegmentationCache;
 
 #define MARGIN_HEIGHT   1.5
 #define MAX_OUTER_NOZZLE_RADIUS   4
@@ -301,6 +302,8 @@ public:
     // This transformation is used to calculate VolumeExtents.
     Transform3d                                 trafo_bboxes;
     std::vector<ObjectID>                       cached_volume_ids;
+    // BBS: segmentation of the painted layers kept over paint edits, allocated by Print::apply() for MMU painted objects only.
+    std::shared_ptr<MMUSegmentationCache>       mmu_segmentation_cache;
 
     void ref_cnt_inc() { ++ m_ref_cnt; }
     void ref_cnt_dec() { if (-- m_ref_cnt == 0) delete this; }
@@ -610,6 +613,9 @@ private:
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
     bool                    				m_typed_slices = false;
+    // BBS: set if posPrepareInfill was restored from the step cache. The cache does not contain the adaptive / support cubic
+    // octrees and the lightning generator built by prepare_infill(), thus posPrepareInfill is invalidated together with posInfill.
+    bool                                    m_prepare_infill_from_cache = false;
 
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
     FillLightning::GeneratorPtr m_lightning_generator;
@@ -846,6 +852,11 @@ public:
     //return 0 means successful
     int                 export_cached_data(const std::string& dir_path, bool with_space=false);
     int                 load_cached_data(const std::string& directory);
+    //BBS: content addressed step cache shared between CLI invocations, see PrintCache.hpp
+    //export_step_cache() is expected to be called after process(), load_step_cache() after apply() and before process(),
+    //the steps affected by the configuration differences to the cached ones are invalidated and recomputed by process()
+    int                 export_step_cache(const std::string& directory);
+    int                 load_step_cache(const std::string& directory);
 
     // methods for handling state
     bool                is_step_done(PrintStep step) const { return Inherited::is_step_done(step); }
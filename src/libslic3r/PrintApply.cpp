@@ -1,5 +1,6 @@
 #include "ClipperUtils.hpp"
 #include "Model.hpp"
+#include "MultiMaterialSegmentation.hpp"
 #include "Print.hpp"
 
 #include <cfloat>
@@ -1746,7 +1747,12 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
             //FIXME be more specific! Don't enumerate extruders that are not used for painting!
             painting_extruders.assign(num_extruders , 0);
             std::iota(painting_extruders.begin(), painting_extruders.end(), 1);
-        }
+            //BBS: keep the MMU segmentation of the unchanged layers over paint edits.
+            if (! print_object_regions->mmu_segmentation_cache)
+                print_object_regions->mmu_segmentation_cache = std::make_shared<MMUSegmentationCache>();
+        } else
+            // Painting removed, the object's steps were invalidated by the change of the painting data.
+            print_object_regions->mmu_segmentation_cache.reset();
         if (model_object_status.print_object_regions_status == ModelObjectStatus::PrintObjectRegionsStatus::Valid) {
             // Verify that the trafo for regions & volume bounding boxes thus for regions is still applicable.
             auto invalidate = [it_print_object, it_print_object_end, update_apply_status]() {
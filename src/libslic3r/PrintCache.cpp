@@ -0,0 +1,853 @@
+#include "PrintCache.hpp"
+
+#include "Exception.hpp"
+#include "Layer.hpp"
+#include "Model.hpp"
+#include "Print.hpp"
+#include "Utils.hpp"
+#include "libslic3r_version.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace Slic3r {
+namespace PrintCache {
+
+static constexpr uint32_t MAGIC = 0x43534242; // "BBSC"
+
+static_assert(sizeof(Point) == 2 * sizeof(coord_t), "Points are stored as a contiguous coord_t array");
+
+namespace {
+
+enum class EntityType : uint8_t {
+    Path,
+    MultiPath,
+    Loop,
+    Collection
+};
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t content_hash;
+    uint64_t geometry_hash;
+    uint64_t identify_id;
+    uint32_t done_steps;
+    uint32_t layer_count;
+    uint32_t support_layer_count;
+    uint32_t first_layer_group_count;
+};
+
+// 64bit FNV-1a, stable across runs and platforms as opposed to std::hash.
+class ContentHasher
+{
+public:
+    void update(const void *data, size_t size) {
+        const unsigned char *p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++ i) {
+            m_hash ^= p[i];
+            m_hash *= 1099511628211ull;
+        }
+    }
+    template<typename T> void update(const T &value) {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only plain values may be hashed directly");
+        this->update(&value, sizeof(T));
+    }
+    uint64_t value() const { return m_hash; }
+
+private:
+    uint64_t m_hash { 14695981039346656037ull };
+};
+
+class BinaryWriter
+{
+public:
+    void append(const void *data, size_t size) { m_data.append(static_cast<const char*>(data), size); }
+    template<typename T> void write(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values may be written directly");
+        this->append(&value, sizeof(T));
+    }
+    void write_count(size_t count) { this->write<uint32_t>(uint32_t(count)); }
+    void write(const std::string &str) {
+        this->write_count(str.size());
+        this->append(str.data(), str.size());
+    }
+    void write(const Point &pt) {
+        this->write<coord_t>(pt.x());
+        this->write<coord_t>(pt.y());
+    }
+    void write(const Points &points) {
+        this->write_count(points.size());
+        this->append(points.data(), points.size() * sizeof(Point));
+    }
+
+    std::string&       data()       { return m_data; }
+    const std::string& data() const { return m_data; }
+
+private:
+    std::string m_data;
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(const char *begin, const char *end) : m_cur(begin), m_end(end) {}
+
+    const char* read_raw(size_t size) {
+        if (size_t(m_end - m_cur) < size)
+            throw Slic3r::FileIOError("Unexpected end of the slicing cache data");
+        const char *ptr = m_cur;
+        m_cur += size;
+        return ptr;
+    }
+    template<typename T> T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values may be read directly");
+        T value;
+        ::memcpy(&value, this->read_raw(sizeof(T)), sizeof(T));
+        return value;
+    }
+    size_t read_count() { return this->read<uint32_t>(); }
+    void read(std::string &str) {
+        size_t size = this->read_count();
+        str.assign(this->read_raw(size), size);
+    }
+    void read(Point &pt) {
+        pt.x() = this->read<coord_t>();
+        pt.y() = this->read<coord_t>();
+    }
+    void read(Points &points) {
+        size_t count = this->read_count();
+        const char *src = this->read_raw(count * sizeof(Point));
+        points.resize(count);
+        if (count > 0)
+            ::memcpy(reinterpret_cast<char*>(points.data()), src, count * sizeof(Point));
+    }
+
+private:
+    const char *m_cur;
+    const char *m_end;
+};
+
+//store apis
+void write_expolygon(BinaryWriter &w, const ExPolygon &expoly)
+{
+    w.write(expoly.contour.points);
+    w.write_count(expoly.holes.size());
+    for (const Polygon &hole : expoly.holes)
+        w.write(hole.points);
+}
+
+void write_expolygons(BinaryWriter &w, const ExPolygons &expolys)
+{
+    w.write_count(expolys.size());
+    for (const ExPolygon &expoly : expolys)
+        write_expolygon(w, expoly);
+}
+
+void write_bbox(BinaryWriter &w, const BoundingBox &bbox)
+{
+    w.write(bbox.min);
+    w.write(bbox.max);
+    w.write<uint8_t>(bbox.defined);
+}
+
+void write_surfaces(BinaryWriter &w, const SurfaceCollection &surfaces)
+{
+    w.write_count(surfaces.surfaces.size());
+    for (const Surface &surface : surfaces.surfaces) {
+        write_expolygon(w, surface.expolygon);
+        w.write<int32_t>(surface.surface_type);
+        w.write<double>(surface.thickness);
+        w.write<uint16_t>(surface.thickness_layers);
+        w.write<double>(surface.bridge_angle);
+        w.write<uint16_t>(surface.extra_perimeters);
+        w.write<uint8_t>(surface.counter_circle_compensation);
+        w.write_count(surface.holes_circle_compensation.size());
+        w.append(surface.holes_circle_compensation.data(), surface.holes_circle_compensation.size() * sizeof(int));
+    }
+}
+
+void write_polyline(BinaryWriter &w, const Polyline &polyline)
+{
+    w.write(polyline.points);
+    w.write_count(polyline.fitting_result.size());
+    for (const PathFittingData &fitting : polyline.fitting_result) {
+        w.write<uint64_t>(fitting.start_point_index);
+        w.write<uint64_t>(fitting.end_point_index);
+        w.write<uint8_t>(uint8_t(fitting.path_type));
+        const ArcSegment &arc = fitting.arc_data;
+        w.write<uint8_t>(arc.is_arc);
+        if (arc.is_arc) {
+            w.write<double>(arc.length);
+            w.write<double>(arc.angle_radians);
+            w.write<double>(arc.polar_start_theta);
+            w.write<double>(arc.polar_end_theta);
+            w.write(arc.start_point);
+            w.write(arc.end_point);
+            w.write<uint8_t>(uint8_t(arc.direction));
+            w.write<double>(arc.radius);
+            w.write(arc.center);
+        }
+    }
+}
+
+void write_polylines(BinaryWriter &w, const Polylines &polylines)
+{
+    w.write_count(polylines.size());
+    for (const Polyline &polyline : polylines)
+        write_polyline(w, polyline);
+}
+
+void write_extrusion_path(BinaryWriter &w, const ExtrusionPath &path)
+{
+    write_polyline(w, path.polyline);
+    w.write<double>(path.overhang_degree);
+    w.write<int32_t>(path.curve_degree);
+    w.write<double>(path.mm3_per_mm);
+    w.write<float>(path.width);
+    w.write<float>(path.height);
+    w.write<uint8_t>(uint8_t(path.role()));
+    w.write<uint8_t>(path.is_force_no_extrusion());
+}
+
+void write_extrusion_paths(BinaryWriter &w, const ExtrusionPaths &paths)
+{
+    w.write_count(paths.size());
+    for (const ExtrusionPath &path : paths)
+        write_extrusion_path(w, path);
+}
+
+void write_extrusion_collection(BinaryWriter &w, const ExtrusionEntityCollection &collection);
+
+void write_extrusion_entity(BinaryWriter &w, const ExtrusionEntity *entity)
+{
+    if (const ExtrusionEntityCollection *collection = dynamic_cast<const ExtrusionEntityCollection*>(entity)) {
+        w.write<uint8_t>(uint8_t(EntityType::Collection));
+        write_extrusion_collection(w, *collection);
+    } else if (const ExtrusionPath *path = dynamic_cast<const ExtrusionPath*>(entity)) {
+        w.write<uint8_t>(uint8_t(EntityType::Path));
+        write_extrusion_path(w, *path);
+    } else if (const ExtrusionMultiPath *multipath = dynamic_cast<const ExtrusionMultiPath*>(entity)) {
+        w.write<uint8_t>(uint8_t(EntityType::MultiPath));
+        write_extrusion_paths(w, multipath->paths);
+    } else if (const ExtrusionLoop *loop = dynamic_cast<const ExtrusionLoop*>(entity)) {
+        w.write<uint8_t>(uint8_t(EntityType::Loop));
+        w.write<uint32_t>(uint32_t(loop->loop_role()));
+        write_extrusion_paths(w, loop->paths);
+    } else
+        throw Slic3r::RuntimeError("Invalid extrusion entity type found while exporting the slicing cache");
+}
+
+void write_extrusion_collection(BinaryWriter &w, const ExtrusionEntityCollection &collection)
+{
+    w.write<uint8_t>(collection.no_sort);
+    w.write_count(collection.entities.size());
+    for (const ExtrusionEntity *entity : collection.entities)
+        write_extrusion_entity(w, entity);
+}
+
+// region_hashes: region_config_hash() of the printing regions of the object, indexed by print_object_region_id.
+void write_layer(BinaryWriter &w, const Layer &layer, const std::vector<uint64_t> &region_hashes)
+{
+    // prefix, decoded serially when creating the layers
+    w.write<uint64_t>(layer.id());
+    w.write<double>(layer.height);
+    w.write<double>(layer.print_z);
+    w.write<double>(layer.slice_z);
+    if (const SupportLayer *support_layer = dynamic_cast<const SupportLayer*>(&layer))
+        w.write<uint64_t>(support_layer->interface_id());
+    w.write_count(layer.region_count());
+    for (const LayerRegion *layerm : layer.regions()) {
+        w.write<int32_t>(layerm->region().print_object_region_id());
+        w.write<uint64_t>(region_hashes[layerm->region().print_object_region_id()]);
+    }
+
+    write_expolygons(w, layer.lslices);
+    w.write_count(layer.lslices_bboxes.size());
+    for (const BoundingBox &bbox : layer.lslices_bboxes)
+        write_bbox(w, bbox);
+    write_expolygons(w, layer.loverhangs);
+    write_bbox(w, layer.loverhangs_bbox);
+
+    for (const LayerRegion *layerm : layer.regions()) {
+        write_surfaces(w, layerm->slices);
+        write_expolygons(w, layerm->raw_slices);
+        write_extrusion_collection(w, layerm->thin_fills);
+        write_expolygons(w, layerm->fill_expolygons);
+        write_surfaces(w, layerm->fill_surfaces);
+        write_expolygons(w, layerm->fill_no_overlap_expolygons);
+        write_polylines(w, layerm->unsupported_bridge_edges);
+        write_extrusion_collection(w, layerm->perimeters);
+        write_extrusion_collection(w, layerm->fills);
+    }
+
+    if (const SupportLayer *support_layer = dynamic_cast<const SupportLayer*>(&layer)) {
+        write_expolygons(w, support_layer->support_islands);
+        write_extrusion_collection(w, support_layer->support_fills);
+    }
+}
+
+//load apis
+void read_expolygon(BinaryReader &r, ExPolygon &expoly)
+{
+    r.read(expoly.contour.points);
+    expoly.holes.resize(r.read_count());
+    for (Polygon &hole : expoly.holes)
+        r.read(hole.points);
+}
+
+void read_expolygons(BinaryReader &r, ExPolygons &expolys)
+{
+    expolys.resize(r.read_count());
+    for (ExPolygon &expoly : expolys)
+        read_expolygon(r, expoly);
+}
+
+void read_bbox(BinaryReader &r, BoundingBox &bbox)
+{
+    r.read(bbox.min);
+    r.read(bbox.max);
+    bbox.defined = r.read<uint8_t>() != 0;
+}
+
+void read_surfaces(BinaryReader &r, SurfaceCollection &surfaces)
+{
+    size_t count = r.read_count();
+    surfaces.surfaces.reserve(count);
+    for (size_t i = 0; i < count; ++ i) {
+        ExPolygon expoly;
+        read_expolygon(r, expoly);
+        Surface surface(SurfaceType(r.read<int32_t>()), std::move(expoly));
+        surface.thickness                   = r.read<double>();
+        surface.thickness_layers            = r.read<uint16_t>();
+        surface.bridge_angle                = r.read<double>();
+        surface.extra_perimeters            = r.read<uint16_t>();
+        surface.counter_circle_compensation = r.read<uint8_t>() != 0;
+        size_t holes = r.read_count();
+        const char *src = r.read_raw(holes * sizeof(int));
+        surface.holes_circle_compensation.resize(holes);
+        if (holes > 0)
+            ::memcpy(surface.holes_circle_compensation.data(), src, holes * sizeof(int));
+        surfaces.surfaces.push_back(std::move(surface));
+    }
+}
+
+void read_polyline(BinaryReader &r, Polyline &polyline)
+{
+    r.read(polyline.points);
+    polyline.fitting_result.resize(r.read_count());
+    for (PathFittingData &fitting : polyline.fitting_result) {
+        fitting.start_point_index = size_t(r.read<uint64_t>());
+        fitting.end_point_index   = size_t(r.read<uint64_t>());
+        fitting.path_type         = EMovePathType(r.read<uint8_t>());
+        ArcSegment &arc = fitting.arc_data;
+        arc.is_arc = r.read<uint8_t>() != 0;
+        if (arc.is_arc) {
+            arc.length            = r.read<double>();
+            arc.angle_radians     = r.read<double>();
+            arc.polar_start_theta = r.read<double>();
+            arc.polar_end_theta   = r.read<double>();
+            r.read(arc.start_point);
+            r.read(arc.end_point);
+            arc.direction         = ArcDirection(r.read<uint8_t>());
+            arc.radius            = r.read<double>();
+            r.read(arc.center);
+        }
+    }
+}
+
+void read_polylines(BinaryReader &r, Polylines &polylines)
+{
+    polylines.resize(r.read_count());
+    for (Polyline &polyline : polylines)
+        read_polyline(r, polyline);
+}
+
+void read_extrusion_path(BinaryReader &r, ExtrusionPath &path)
+{
+    read_polyline(r, path.polyline);
+    path.overhang_degree = r.read<double>();
+    path.curve_degree    = r.read<int32_t>();
+    path.mm3_per_mm      = r.read<double>();
+    path.width           = r.read<float>();
+    path.height          = r.read<float>();
+    path.set_extrusion_role(ExtrusionRole(r.read<uint8_t>()));
+    path.set_force_no_extrusion(r.read<uint8_t>() != 0);
+}
+
+void read_extrusion_paths(BinaryReader &r, ExtrusionPaths &paths)
+{
+    paths.resize(r.read_count());
+    for (ExtrusionPath &path : paths)
+        read_extrusion_path(r, path);
+}
+
+void read_extrusion_collection(BinaryReader &r, ExtrusionEntityCollection &collection);
+
+ExtrusionEntity* read_extrusion_entity(BinaryReader &r)
+{
+    switch (EntityType(r.read<uint8_t>())) {
+    case EntityType::Path: {
+        std::unique_ptr<ExtrusionPath> path = std::make_unique<ExtrusionPath>();
+        read_extrusion_path(r, *path);
+        return path.release();
+    }
+    case EntityType::MultiPath: {
+        std::unique_ptr<ExtrusionMultiPath> multipath = std::make_unique<ExtrusionMultiPath>();
+        read_extrusion_paths(r, multipath->paths);
+        return multipath.release();
+    }
+    case EntityType::Loop: {
+        std::unique_ptr<ExtrusionLoop> loop = std::make_unique<ExtrusionLoop>();
+        loop->set_loop_role(ExtrusionLoopRole(r.read<uint32_t>()));
+        read_extrusion_paths(r, loop->paths);
+        return loop.release();
+    }
+    case EntityType::Collection: {
+        std::unique_ptr<ExtrusionEntityCollection> collection = std::make_unique<ExtrusionEntityCollection>();
+        read_extrusion_collection(r, *collection);
+        return collection.release();
+    }
+    default:
+        throw Slic3r::FileIOError("Unknown extrusion entity type in the slicing cache");
+    }
+}
+
+void read_extrusion_collection(BinaryReader &r, ExtrusionEntityCollection &collection)
+{
+    collection.no_sort = r.read<uint8_t>() != 0;
+    size_t count = r.read_count();
+    collection.entities.reserve(collection.entities.size() + count);
+    for (size_t i = 0; i < count; ++ i)
+        collection.entities.push_back(read_extrusion_entity(r));
+}
+
+struct LayerPrefix
+{
+    uint64_t                                 id;
+    double                                   height;
+    double                                   print_z;
+    double                                   slice_z;
+    uint64_t                                 interface_id { 0 };
+    // print_object_region_id and region_config_hash() of each LayerRegion
+    std::vector<std::pair<int32_t, uint64_t>> regions;
+};
+
+LayerPrefix read_layer_prefix(BinaryReader &r, bool support_layer)
+{
+    LayerPrefix prefix;
+    prefix.id      = r.read<uint64_t>();
+    prefix.height  = r.read<double>();
+    prefix.print_z = r.read<double>();
+    prefix.slice_z = r.read<double>();
+    if (support_layer)
+        prefix.interface_id = r.read<uint64_t>();
+    prefix.regions.resize(r.read_count());
+    for (std::pair<int32_t, uint64_t> &region : prefix.regions) {
+        region.first  = r.read<int32_t>();
+        region.second = r.read<uint64_t>();
+    }
+    return prefix;
+}
+
+void read_layer_data(BinaryReader &r, Layer &layer)
+{
+    read_expolygons(r, layer.lslices);
+    layer.lslices_bboxes.resize(r.read_count());
+    for (BoundingBox &bbox : layer.lslices_bboxes)
+        read_bbox(r, bbox);
+    read_expolygons(r, layer.loverhangs);
+    read_bbox(r, layer.loverhangs_bbox);
+
+    for (LayerRegion *layerm : layer.regions()) {
+        read_surfaces(r, layerm->slices);
+        read_expolygons(r, layerm->raw_slices);
+        read_extrusion_collection(r, layerm->thin_fills);
+        read_expolygons(r, layerm->fill_expolygons);
+        read_surfaces(r, layerm->fill_surfaces);
+        read_expolygons(r, layerm->fill_no_overlap_expolygons);
+        read_polylines(r, layerm->unsupported_bridge_edges);
+        read_extrusion_collection(r, layerm->perimeters);
+        read_extrusion_collection(r, layerm->fills);
+    }
+
+    if (SupportLayer *support_layer = dynamic_cast<SupportLayer*>(&layer)) {
+        read_expolygons(r, support_layer->support_islands);
+        read_extrusion_collection(r, support_layer->support_fills);
+    }
+}
+
+void write_config(BinaryWriter &w, const ConfigBase &config)
+{
+    t_config_option_keys keys = config.keys();
+    w.write_count(keys.size());
+    for (const t_config_option_key &key : keys) {
+        w.write(key);
+        w.write(config.opt_serialize(key));
+    }
+}
+
+void read_config(BinaryReader &r, DynamicPrintConfig &config)
+{
+    ConfigSubstitutionContext context { ForwardCompatibilitySubstitutionRule::Disable };
+    size_t count = r.read_count();
+    std::string key, value;
+    for (size_t i = 0; i < count; ++ i) {
+        r.read(key);
+        r.read(value);
+        config.set_deserialize(key, value, context);
+    }
+}
+
+void hash_facets(ContentHasher &hasher, const FacetsAnnotation &facets)
+{
+    const TriangleSplittingData &data = facets.get_data();
+    hasher.update<uint64_t>(data.triangles_to_split.size());
+    hasher.update(data.triangles_to_split.data(), data.triangles_to_split.size() * sizeof(std::pair<int, int>));
+    hasher.update<uint64_t>(data.num_codes);
+    hasher.update(data.codes.data(), data.codes.size());
+}
+
+void hash_config(ContentHasher &hasher, const ConfigBase &config)
+{
+    t_config_option_keys keys = config.keys();
+    hasher.update<uint64_t>(keys.size());
+    for (const t_config_option_key &key : keys) {
+        const std::string value = config.opt_serialize(key);
+        hasher.update(key.data(), key.size());
+        hasher.update(value.data(), value.size());
+    }
+}
+
+// Unlike PrintRegion::config_hash(), which is based on std::hash, the hash of the serialized configuration
+// is stable across runs and platforms.
+uint64_t region_config_hash(const PrintRegion &region)
+{
+    ContentHasher hasher;
+    hash_config(hasher, region.config());
+    return hasher.value();
+}
+
+std::vector<uint64_t> region_config_hashes(const PrintObject &object)
+{
+    std::vector<uint64_t> out(object.num_printing_regions());
+    for (size_t region_id = 0; region_id < out.size(); ++ region_id)
+        out[region_id] = region_config_hash(object.printing_region(region_id));
+    return out;
+}
+
+} // namespace
+
+uint64_t object_geometry_hash(const PrintObject &object)
+{
+    ContentHasher hasher;
+    hasher.update<uint32_t>(FORMAT_VERSION);
+    hasher.update(object.trafo().matrix().data(), 16 * sizeof(double));
+    for (const ModelVolume *volume : object.model_object()->volumes) {
+        const indexed_triangle_set &its = volume->mesh().its;
+        hasher.update<int>(int(volume->type()));
+        hasher.update<uint64_t>(its.vertices.size());
+        hasher.update(its.vertices.data(), its.vertices.size() * sizeof(stl_vertex));
+        hasher.update<uint64_t>(its.indices.size());
+        hasher.update(its.indices.data(), its.indices.size() * sizeof(stl_triangle_vertex_indices));
+        hasher.update(volume->get_matrix().data(), 16 * sizeof(double));
+        hash_facets(hasher, volume->supported_facets);
+        hash_facets(hasher, volume->seam_facets);
+        hash_facets(hasher, volume->mmu_segmentation_facets);
+        hash_facets(hasher, volume->fuzzy_skin_facets);
+    }
+    // The layers are sliced at the Z levels given by the variable layer height profile and the height range modifiers.
+    const std::vector<coordf_t> layer_height_profile = object.model_object()->layer_height_profile.get();
+    hasher.update<uint64_t>(layer_height_profile.size());
+    hasher.update(layer_height_profile.data(), layer_height_profile.size() * sizeof(coordf_t));
+    hasher.update<uint64_t>(object.model_object()->layer_config_ranges.size());
+    for (const auto &[range, config] : object.model_object()->layer_config_ranges) {
+        hasher.update<coordf_t>(range.first);
+        hasher.update<coordf_t>(range.second);
+        hash_config(hasher, config.get());
+    }
+    return hasher.value();
+}
+
+uint64_t object_content_hash(const PrintObject &object)
+{
+    ContentHasher hasher;
+    hasher.update<uint64_t>(object_geometry_hash(object));
+    hash_config(hasher, object.config());
+    for (uint64_t region_hash : region_config_hashes(object))
+        hasher.update<uint64_t>(region_hash);
+    return hasher.value();
+}
+
+std::string binary_file_name(const std::string &directory, size_t identify_id)
+{
+    return directory + "/obj_" + std::to_string(identify_id) + ".bin";
+}
+
+std::string step_cache_file_name(const std::string &directory, uint64_t geometry_hash)
+{
+    return directory + "/" + (boost::format("%016x") % geometry_hash).str() + ".bin";
+}
+
+int export_object(const PrintObject &object, size_t identify_id, const std::string &file_name)
+{
+    const size_t layer_count         = object.layer_count();
+    const size_t support_layer_count = object.support_layer_count();
+
+    // Serialize the layers in parallel into independent buffers.
+    std::vector<BinaryWriter> blobs(layer_count + support_layer_count + 2);
+    const std::vector<uint64_t> region_hashes = region_config_hashes(object);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, layer_count + support_layer_count),
+        [&object, &blobs, &region_hashes, layer_count](const tbb::blocked_range<size_t> &range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
+                const Layer *layer = idx < layer_count ? object.get_layer(int(idx)) : object.support_layers()[idx - layer_count];
+                write_layer(blobs[idx], *layer, region_hashes);
+            }
+        });
+
+    //first layer groups, the volume ids are stored as indices into ModelObject::volumes
+    const std::vector<groupedVolumeSlices> &first_layer_groups = object.firstLayerObjGroups();
+    {
+        const PrintObject *shared_object = object.get_shared_object() ? object.get_shared_object() : &object;
+        const ModelVolumePtrs &volumes = shared_object->model_object()->volumes;
+        BinaryWriter &w = blobs[layer_count + support_layer_count];
+        for (const groupedVolumeSlices &group : first_layer_groups) {
+            w.write<int32_t>(group.groupId);
+            w.write_count(group.volume_ids.size());
+            for (const ObjectID &obj_id : group.volume_ids) {
+                auto it = std::find_if(volumes.begin(), volumes.end(), [&obj_id](const ModelVolume *volume) { return volume->id() == obj_id; });
+                w.write<uint64_t>(it == volumes.end() ? obj_id.id : uint64_t(it - volumes.begin()));
+            }
+            write_expolygons(w, group.slices);
+        }
+    }
+
+    //configurations the object was sliced with, regions ordered by print_object_region_id
+    {
+        BinaryWriter &w = blobs.back();
+        w.write(std::string(SLIC3R_VERSION));
+        write_config(w, object.print()->config());
+        write_config(w, object.config());
+        w.write_count(object.num_printing_regions());
+        for (size_t region_id = 0; region_id < object.num_printing_regions(); ++ region_id)
+            write_config(w, object.printing_region(region_id).config());
+    }
+
+    uint32_t done_steps = 0;
+    for (int step = 0; step < posCount; ++ step)
+        if (object.is_step_done(PrintObjectStep(step)))
+            done_steps |= 1u << step;
+
+    BinaryWriter head;
+    Header header;
+    header.magic                   = MAGIC;
+    header.version                 = FORMAT_VERSION;
+    header.content_hash            = object_content_hash(object);
+    header.geometry_hash           = object_geometry_hash(object);
+    header.identify_id             = identify_id;
+    header.done_steps              = done_steps;
+    header.layer_count             = uint32_t(layer_count);
+    header.support_layer_count     = uint32_t(support_layer_count);
+    header.first_layer_group_count = uint32_t(first_layer_groups.size());
+    head.write(header);
+    head.write(object.model_object()->name);
+
+    uint64_t offset = head.data().size() + (blobs.size() + 1) * sizeof(uint64_t);
+    for (const BinaryWriter &blob : blobs) {
+        head.write<uint64_t>(offset);
+        offset += blob.data().size();
+    }
+    head.write<uint64_t>(offset);
+
+    try {
+        boost::nowide::ofstream c;
+        c.exceptions(std::ios::failbit | std::ios::badbit);
+        c.open(file_name, std::ios::out | std::ios::trunc | std::ios::binary);
+        c.write(head.data().data(), head.data().size());
+        for (const BinaryWriter &blob : blobs)
+            c.write(blob.data().data(), blob.data().size());
+        c.close();
+    }
+    catch (std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ": save to " << file_name << " got a generic exception, reason = " << err.what();
+        return CLI_EXPORT_CACHE_WRITE_FAILED;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": saved object %1%, %2% layers, %3% support layers, %4% bytes to %5%")
+        % object.model_object()->name % layer_count % support_layer_count % offset % file_name;
+    return 0;
+}
+
+namespace {
+
+int load_object_layers(PrintObject &object, const std::string &file_name, bool strict, CachedState *state)
+{
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(boost::filesystem::path(file_name));
+    }
+    catch (std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ": map " << file_name << " got a generic exception, reason = " << err.what();
+        return CLI_IMPORT_CACHE_LOAD_FAILED;
+    }
+    const char *begin = file.data();
+    const char *end   = begin + file.size();
+
+    try {
+        BinaryReader r(begin, end);
+        Header header = r.read<Header>();
+        if (header.magic != MAGIC || header.version != FORMAT_VERSION) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": %1% has an unsupported format, magic %2%, version %3%") % file_name % header.magic % header.version;
+            return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+        }
+        if (strict ? header.content_hash != object_content_hash(object) : header.geometry_hash != object_geometry_hash(object)) {
+            BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": %1% was generated from a different geometry or configuration") % file_name;
+            return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+        }
+        std::string name;
+        r.read(name);
+
+        const size_t layer_count         = header.layer_count;
+        const size_t support_layer_count = header.support_layer_count;
+        // The offset table has to fit into the file before it is allocated, and the blobs must not overlap.
+        if ((uint64_t(layer_count) + support_layer_count + 3) * sizeof(uint64_t) > file.size())
+            throw Slic3r::FileIOError("Invalid layer count in the slicing cache");
+        std::vector<uint64_t> offsets(layer_count + support_layer_count + 3);
+        for (size_t idx = 0; idx < offsets.size(); ++ idx) {
+            offsets[idx] = r.read<uint64_t>();
+            if (offsets[idx] > file.size() || (idx > 0 && offsets[idx] < offsets[idx - 1]))
+                throw Slic3r::FileIOError("Invalid offset table in the slicing cache");
+        }
+        auto blob_reader = [begin, &offsets](size_t idx) { return BinaryReader(begin + offsets[idx], begin + offsets[idx + 1]); };
+
+        //the configurations are checked before any layer is created
+        {
+            BinaryReader r_config = blob_reader(layer_count + support_layer_count + 1);
+            std::string version;
+            r_config.read(version);
+            CachedState cached;
+            cached.done_steps = header.done_steps;
+            read_config(r_config, cached.print_config);
+            read_config(r_config, cached.object_config);
+            cached.region_configs.resize(r_config.read_count());
+            for (DynamicPrintConfig &region_config : cached.region_configs)
+                read_config(r_config, region_config);
+            if (! strict && (version != SLIC3R_VERSION || cached.region_configs.size() != object.num_printing_regions())) {
+                BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": %1% was generated by version %2% with %3% regions, can not reuse it")
+                    % file_name % version % cached.region_configs.size();
+                return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+            }
+            if (state)
+                *state = std::move(cached);
+        }
+
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": will load %1%, identify_id %2%, layer_count %3%, support_layer_count %4%, firstlayer_group_count %5%")
+            % name % header.identify_id % layer_count % support_layer_count % header.first_layer_group_count;
+
+        //create layers and layer regions serially from the blob prefixes
+        const std::vector<uint64_t> region_hashes = strict ? region_config_hashes(object) : std::vector<uint64_t>();
+        std::vector<BinaryReader> readers;
+        readers.reserve(layer_count + support_layer_count);
+        Layer *previous_layer = nullptr;
+        for (size_t idx = 0; idx < layer_count; ++ idx) {
+            readers.emplace_back(blob_reader(idx));
+            LayerPrefix prefix = read_layer_prefix(readers.back(), false);
+            Layer *new_layer = object.add_layer(int(prefix.id), prefix.height, prefix.print_z, prefix.slice_z);
+            if (previous_layer) {
+                previous_layer->upper_layer = new_layer;
+                new_layer->lower_layer = previous_layer;
+            }
+            previous_layer = new_layer;
+            for (const std::pair<int32_t, uint64_t> &region : prefix.regions) {
+                const PrintRegion *print_region = nullptr;
+                if (strict) {
+                    for (size_t region_id = 0; region_id < region_hashes.size() && ! print_region; ++ region_id)
+                        if (region_hashes[region_id] == region.second)
+                            print_region = &object.printing_region(region_id);
+                } else if (region.first >= 0 && size_t(region.first) < object.num_printing_regions())
+                    print_region = &object.printing_region(region.first);
+                if (! print_region) {
+                    BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": can not find print region of object %1%, layer %2%, print_z %3%") % name % idx % prefix.print_z;
+                    return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+                }
+                new_layer->add_region(print_region);
+            }
+        }
+        Layer *previous_support_layer = nullptr;
+        for (size_t idx = 0; idx < support_layer_count; ++ idx) {
+            readers.emplace_back(blob_reader(layer_count + idx));
+            LayerPrefix prefix = read_layer_prefix(readers.back(), true);
+            SupportLayer *new_support_layer = object.add_support_layer(int(prefix.id), int(prefix.interface_id), prefix.height, prefix.print_z);
+            if (previous_support_layer) {
+                previous_support_layer->upper_layer = new_support_layer;
+                new_support_layer->lower_layer = previous_support_layer;
+            }
+            previous_support_layer = new_support_layer;
+        }
+
+        //decode the layer geometry in parallel straight from the mapped file
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, layer_count + support_layer_count),
+            [&object, &readers, layer_count](const tbb::blocked_range<size_t> &range) {
+                for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
+                    Layer *layer = idx < layer_count ? object.get_layer(int(idx)) : object.get_support_layer(int(idx - layer_count));
+                    read_layer_data(readers[idx], *layer);
+                }
+            });
+
+        //first layer groups
+        BinaryReader r_groups = blob_reader(layer_count + support_layer_count);
+        const ModelVolumePtrs &volumes = object.model_object()->volumes;
+        std::vector<groupedVolumeSlices> &first_layer_groups = object.firstLayerObjGroupsMod();
+        for (size_t idx = 0; idx < header.first_layer_group_count; ++ idx) {
+            groupedVolumeSlices group;
+            group.groupId = r_groups.read<int32_t>();
+            group.volume_ids.resize(r_groups.read_count());
+            for (ObjectID &obj_id : group.volume_ids) {
+                size_t volume_idx = size_t(r_groups.read<uint64_t>());
+                if (volume_idx >= volumes.size()) {
+                    BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": can not find volume_id %1% from object file %2% in firstlayer groups, volume_count %3%!")
+                        % volume_idx % file_name % volumes.size();
+                    return CLI_IMPORT_CACHE_LOAD_FAILED;
+                }
+                obj_id = volumes[volume_idx]->id();
+            }
+            read_expolygons(r_groups, group.slices);
+            first_layer_groups.push_back(std::move(group));
+        }
+    }
+    catch (std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ": load from " << file_name << " got a generic exception, reason = " << err.what();
+        return CLI_IMPORT_CACHE_LOAD_FAILED;
+    }
+
+    return 0;
+}
+
+} // namespace
+
+int load_object(PrintObject &object, const std::string &file_name, bool strict, CachedState *state)
+{
+    int ret = load_object_layers(object, file_name, strict, state);
+    if (ret) {
+        // Do not leave the layers of a partially loaded cache behind.
+        object.clear_layers();
+        object.clear_support_layers();
+        object.firstLayerObjGroupsMod().clear();
+    }
+    return ret;
+}
+
+} // namespace PrintCache
+} // namespace Slic3r
@@ -0,0 +1,65 @@
+#ifndef slic3r_PrintCache_hpp_
+#define slic3r_PrintCache_hpp_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Print.hpp"
+
+namespace Slic3r {
+
+// BBS: Compact binary storage of the sliced layers of a PrintObject, used by Print::export_cached_data()
+// and Print::load_cached_data() to warm-start Print::process(..., use_cache = true), and by the step cache
+// (Print::export_step_cache() / Print::load_step_cache()) to reuse finished PrintObjectSteps across CLI runs.
+//
+// File layout (native byte order, not portable across endianness; all offsets relative to the start of the file):
+//   header      magic, format version, content hash, geometry hash, finished steps, identify id, blob counts
+//   name        object name (u32 length + bytes)
+//   offsets     (layer_count + support_layer_count + 3) x u64, blob i spans [offsets[i], offsets[i + 1])
+//   blobs       one blob per layer, one blob per support layer, one blob with the first layer groups,
+//               one blob with the configurations the object was sliced with
+//
+// Each layer blob starts with a small fixed prefix (id, heights, regions) so that the layers may be created
+// serially, while the heavy geometry is decoded in parallel straight from the memory mapped file.
+namespace PrintCache {
+
+// Bump whenever the binary layout changes, files with a different version are rejected.
+static constexpr uint32_t FORMAT_VERSION = 3;
+
+// Configurations and step states of a PrintObject at the time it was exported.
+struct CachedState
+{
+    // Bit mask of the PrintObjectSteps, which were finished.
+    uint32_t                        done_steps { 0 };
+    DynamicPrintConfig              print_config;
+    DynamicPrintConfig              object_config;
+    // Indexed by PrintRegion::print_object_region_id().
+    std::vector<DynamicPrintConfig> region_configs;
+
+    bool is_step_done(PrintObjectStep step) const { return (done_steps & (1u << step)) != 0; }
+};
+
+// Hash of the ModelVolume meshes, their transformations and painting, of the object transformation
+// and of the layer height profile and height range modifiers.
+uint64_t    object_geometry_hash(const PrintObject &object);
+// object_geometry_hash() combined with the serialized object / region configurations.
+// Cached data is only reused by load_object(strict) if the stored hash matches.
+uint64_t    object_content_hash(const PrintObject &object);
+
+std::string binary_file_name(const std::string &directory, size_t identify_id);
+// Content addressed file name used by the step cache.
+std::string step_cache_file_name(const std::string &directory, uint64_t geometry_hash);
+
+// Return 0 on success or one of the CLI_EXPORT_CACHE_* / CLI_IMPORT_CACHE_* error codes.
+int         export_object(const PrintObject &object, size_t identify_id, const std::string &file_name);
+// The object is expected to have its layers cleared. If loading fails, the layers created so far are released.
+// If strict, the layers are only loaded if object_content_hash() matches, otherwise only the geometry hash
+// and the region layout have to match and the caller is responsible for invalidating the steps affected
+// by the configuration differences reported through state.
+int         load_object(PrintObject &object, const std::string &file_name, bool strict = true, CachedState *state = nullptr);
+
+} // namespace PrintCache
+} // namespace Slic3r
+
+#endif // slic3r_PrintCache_hpp_
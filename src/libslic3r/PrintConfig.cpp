@@ -8202,6 +8202,43 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->cli_params = "custom_gcode_toolchange.json";
     def->set_default_value(new ConfigOptionString());
 
+    def = this->add("step_cache_dir", coString);
+    def->label = "Step cache directory";
+    def->tooltip = "Directory of the content addressed slicing step cache. The sliced objects are stored into it, "
+                   "and an object with the same geometry is restored from it in the later runs, only the steps affected by the changed settings are recomputed.";
+    def->cli_params = "dir";
+    def->set_default_value(new ConfigOptionString());
+
+    def = this->add("profile_out", coString);
+    def->label = "Profile output file";
+    def->tooltip = "Profile the slicing and G-code export and write the recorded zones into this file in the Chrome trace format, "
+                   "to be viewed in chrome://tracing or Perfetto. With the batch server, each job writes its own file, numbered in the order of the jobs (trace.1.json, trace.2.json, ...).";
+    def->cli_params = "trace.json";
+    def->set_default_value(new ConfigOptionString());
+
+    def = this->add("parallel_plates", coInt);
+    def->label = "Parallel plates";
+    def->tooltip = "Maximum count of plates sliced concurrently when slicing all the plates, sharing the same thread pool. "
+                   "0 means as many as the hardware threads, 1 slices the plates one after another.";
+    def->cli_params = "count";
+    def->min = 0;
+    def->set_default_value(new ConfigOptionInt(1));
+
+    def = this->add("slicing_memory_budget", coInt);
+    def->label = "Slicing memory budget";
+    def->tooltip = "Memory budget in MB of the plates sliced concurrently. The memory of a plate is estimated from its triangle count "
+                   "and from the memory per triangle measured on the first plate, which is sliced alone. "
+                   "A plate exceeding the budget is sliced alone. 0 means no limit.";
+    def->cli_params = "MB";
+    def->min = 0;
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("batch_server", coBool);
+    def->label = "Batch server";
+    def->tooltip = "Keep running and read the slicing jobs from the standard input, one json per line. "
+                   "The other arguments are applied to every job, the presets and resources are only loaded once.";
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("load_filament_ids", coInts);
     def->label = "Load filament ids";
     def->tooltip = "Load filament ids for each object";
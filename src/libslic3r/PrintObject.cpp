@@ -15,10 +15,12 @@
 #include "TriangleMeshSlicer.hpp"
 #include "Utils.hpp"
 #include "Fill/FillAdaptive.hpp"
+#include "Fill/FillCache.hpp"
 #include "Fill/FillLightning.hpp"
 #include "Format/STL.hpp"
 #include "InternalBridgeDetector.hpp"
 #include "AABBTreeLines.hpp"
+#include "Profiler.hpp"
 
 #include <float.h>
 #include <string_view>
@@ -326,6 +328,7 @@ void PrintObject::make_perimeters()
     if (! this->set_started(posPerimeters))
         return;
 
+    SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::make_perimeters", this->model_object()->name);
     m_print->set_status(15, L("Generating walls"));
     BOOST_LOG_TRIVIAL(info) << "Generating walls..." << log_memory_info();
 
@@ -429,6 +432,7 @@ void PrintObject::make_perimeters()
         [this](const tbb::blocked_range<size_t>& range) {
             for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                 m_print->throw_if_canceled();
+                SLIC3R_PROFILE_ZONE_DETAIL("Layer::make_perimeters", std::to_string(layer_idx));
                 m_layers[layer_idx]->make_perimeters();
             }
         }
@@ -492,6 +496,8 @@ void PrintObject::prepare_infill()
 {
     if (! this->set_started(posPrepareInfill))
         return;
+    m_prepare_infill_from_cache = false;
+    SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::prepare_infill", this->model_object()->name);
     m_print->set_status(25, L("Generating infill regions"));
     if (m_typed_slices) {
         // To improve robustness of detect_surfaces_type() when reslicing (working with typed slices), see GH issue #7442.
@@ -621,23 +627,28 @@ void PrintObject::infill()
     this->prepare_infill();
 
     if (this->set_started(posInfill)) {
+        SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::infill", this->model_object()->name);
         m_print->set_status(35, L("Generating infill toolpath"));
 
         const auto& adaptive_fill_octree = this->m_adaptive_fill_octrees.first;
         const auto& support_fill_octree = this->m_adaptive_fill_octrees.second;
+        // BBS: the layers of prismatic parts share their rectilinear infill
+        FillCache   fill_cache;
 
         //BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
         tbb::parallel_for(
            tbb::blocked_range<size_t>(0, m_layers.size()),
-           [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
+           [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree, &fill_cache](const tbb::blocked_range<size_t>& range) {
                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                    m_print->throw_if_canceled();
-                   m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get());
+                   SLIC3R_PROFILE_ZONE_DETAIL("Layer::make_fills", std::to_string(layer_idx));
+                   m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get(), &fill_cache);
                }
            }
         );
         m_print->throw_if_canceled();
         BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - end";
+        BOOST_LOG_TRIVIAL(info) << "Infill cache of object " << this->model_object()->name << ": " << fill_cache.hits() << " hits out of " << fill_cache.lookups() << " lookups";
         /*  we could free memory now, but this would make this step not idempotent
         ### $_->fill_surfaces->clear for map @{$_->regions}, @{$object->layers};
         */
@@ -648,6 +659,7 @@ void PrintObject::infill()
 void PrintObject::ironing()
 {
     if (this->set_started(posIroning)) {
+        SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::ironing", this->model_object()->name);
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - start";
         tbb::parallel_for(
             // Ironing starting with layer 0 to support ironing all surfaces.
@@ -679,6 +691,7 @@ static const float g_min_overhang_percent_for_lift = 0.3f;
 void PrintObject::detect_overhangs_for_lift()
 {
     if (this->set_started(posDetectOverhangsForLift)) {
+        SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::detect_overhangs_for_lift", this->model_object()->name);
         const float min_overlap = m_config.line_width * g_min_overhang_percent_for_lift;
         size_t num_layers = this->layer_count();
         size_t num_raft_layers = m_slicing_params.raft_layers();
@@ -707,6 +720,7 @@ void PrintObject::detect_overhangs_for_lift()
 void PrintObject::generate_support_material()
 {
     if (this->set_started(posSupportMaterial)) {
+        SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::generate_support_material", this->model_object()->name);
         this->clear_support_layers();
 
         if(!has_support() && !m_print->get_no_check_flag()) {
@@ -754,6 +768,7 @@ void PrintObject::generate_support_material()
 void PrintObject::simplify_extrusion_path()
 {
     if (this->set_started(posSimplifyWall)) {
+        SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::simplify_wall", this->model_object()->name);
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify wall extrusion path of object in parallel - start";
         //BBS: walls
@@ -772,6 +787,7 @@ void PrintObject::simplify_extrusion_path()
     }
 
     if (this->set_started(posSimplifyInfill)) {
+        SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::simplify_infill", this->model_object()->name);
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify infill extrusion path of object in parallel - start";
         //BBS: infills
@@ -790,6 +806,7 @@ void PrintObject::simplify_extrusion_path()
     }
 
     if (this->set_started(posSimplifySupportPath)) {
+        SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::simplify_support_path", this->model_object()->name);
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify extrusion path of support in parallel - start";
         tbb::parallel_for(
@@ -859,8 +876,11 @@ FillLightning::GeneratorPtr PrintObject::prepare_lightning_infill_data()
 void PrintObject::clear_layers()
 {
     if (!m_shared_object) {
-        for (Layer *l : m_layers)
-            delete l;
+        // BBS: each layer owns trees of individually allocated extrusion entities, release the layers in parallel.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()), [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                delete m_layers[layer_idx];
+        });
         m_layers.clear();
     }
 }
@@ -886,8 +906,10 @@ SupportLayer* PrintObject::get_support_layer_at_printz(coordf_t print_z, coordf_
 void PrintObject::clear_support_layers()
 {
     if (!m_shared_object) {
-        for (SupportLayer* l : m_support_layers)
-            delete l;
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_support_layers.size()), [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                delete m_support_layers[layer_idx];
+        });
         m_support_layers.clear();
         for (auto l : m_layers) {
             l->sharp_tails.clear();
@@ -1228,6 +1250,9 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
         invalidated |= this->invalidate_steps({ posInfill, posIroning, posSimplifyWall, posSimplifyInfill });
     } else if (step == posInfill) {
         invalidated |= this->invalidate_steps({ posIroning, posSimplifyInfill });
+        // The infill data of a posPrepareInfill restored from the step cache is missing, make_fills() would get null octrees.
+        if (m_prepare_infill_from_cache)
+            invalidated |= this->invalidate_steps({ posPrepareInfill, posSimplifyWall });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
     } else if (step == posSlice) {
 		invalidated |= this->invalidate_steps({ posPerimeters, posPrepareInfill, posInfill, posIroning, posSupportMaterial, posSimplifyWall, posSimplifyInfill });
@@ -1268,6 +1293,7 @@ bool PrintObject::invalidate_all_steps()
 // If a part of a region is of stBottom and stTop, the stBottom wins.
 void PrintObject::detect_surfaces_type()
 {
+    SLIC3R_PROFILE_ZONE("PrintObject::detect_surfaces_type");
     BOOST_LOG_TRIVIAL(info) << "Detecting solid surfaces..." << log_memory_info();
 
     // Interface shells: the intersecting parts are treated as self standing objects supporting each other.
@@ -1468,6 +1494,7 @@ void PrintObject::detect_surfaces_type()
 
 void PrintObject::process_external_surfaces()
 {
+    SLIC3R_PROFILE_ZONE("PrintObject::process_external_surfaces");
     BOOST_LOG_TRIVIAL(info) << "Processing external surfaces..." << log_memory_info();
 
     // Cached surfaces covered by some extrusion, defining regions, over which the from the surfaces one layer higher are allowed to expand.
@@ -1546,6 +1573,7 @@ void PrintObject::process_external_surfaces()
 
 void PrintObject::discover_vertical_shells()
 {
+    SLIC3R_PROFILE_ZONE("PrintObject::discover_vertical_shells");
     PROFILE_FUNC();
 
     BOOST_LOG_TRIVIAL(info) << "Discovering vertical shells..." << log_memory_info();
@@ -1973,6 +2001,7 @@ void PrintObject::discover_shell_for_perimeters()
 // This method applies bridge flow to the first internal solid layer above sparse infill.
 void PrintObject::bridge_over_infill()
 {
+    SLIC3R_PROFILE_ZONE("PrintObject::bridge_over_infill");
     BOOST_LOG_TRIVIAL(info) << "Bridge over infill - Start" << log_memory_info();
 
     // CandidateSurface存放一个需要桥接的区域
@@ -3073,6 +3102,7 @@ std::vector<Point> PrintObject::get_instances_shift_without_plate_offset() const
 // fill_surfaces but we only turn them into VOID surfaces, thus preserving the boundaries.
 void PrintObject::clip_fill_surfaces()
 {
+    SLIC3R_PROFILE_ZONE("PrintObject::clip_fill_surfaces");
     if (! PrintObject::infill_only_where_needed)
         return;
     bool has_infill = false;
@@ -3159,6 +3189,7 @@ void PrintObject::clip_fill_surfaces()
 
 void PrintObject::discover_horizontal_shells()
 {
+    SLIC3R_PROFILE_ZONE("PrintObject::discover_horizontal_shells");
     BOOST_LOG_TRIVIAL(trace) << "discover_horizontal_shells()";
 
     for (size_t region_id = 0; region_id < this->num_printing_regions(); ++region_id) {
@@ -3346,6 +3377,7 @@ void PrintObject::discover_horizontal_shells()
 // fill_surfaces but we only turn them into VOID surfaces, thus preserving the boundaries.
 void PrintObject::combine_infill()
 {
+    SLIC3R_PROFILE_ZONE("PrintObject::combine_infill");
     // Work on each region separately.
     for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
         const PrintRegion &region = this->printing_region(region_id);
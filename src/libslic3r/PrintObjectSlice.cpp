@@ -3,6 +3,7 @@
 #include "Layer.hpp"
 #include "MultiMaterialSegmentation.hpp"
 #include "Print.hpp"
+#include "Profiler.hpp"
 #include "ClipperUtils.hpp"
 #include "Interlocking/InterlockingGenerator.hpp"
 //BBS
@@ -792,6 +793,7 @@ void PrintObject::slice()
 {
     if (! this->set_started(posSlice))
         return;
+    SLIC3R_PROFILE_ZONE_DETAIL("PrintObject::slice", this->model_object()->name);
     //BBS: add flag to reload scene for shell rendering
     m_print->set_status(5, L("Slicing mesh"), PrintBase::SlicingStatus::RELOAD_SCENE);
     std::vector<coordf_t> layer_height_profile;
@@ -1086,6 +1088,7 @@ template<typename ThrowOnCancel> void apply_fuzzy_skin_segmentation(PrintObject
 // this should be idempotent
 void PrintObject::slice_volumes()
 {
+    SLIC3R_PROFILE_ZONE("PrintObject::slice_volumes");
     BOOST_LOG_TRIVIAL(info) << "Slicing volumes..." << log_memory_info();
     const Print *print                      = this->print();
     const auto   throw_on_cancel_callback   = std::function<void()>([print](){ print->throw_if_canceled(); });
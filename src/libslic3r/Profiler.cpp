@@ -0,0 +1,245 @@
+#include "Profiler.hpp"
+#include "Thread.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <tbb/spin_mutex.h>
+
+namespace Slic3r {
+namespace Profiler {
+
+namespace detail {
+    std::atomic<bool> g_enabled { false };
+
+    uint64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+} // namespace detail
+
+namespace {
+
+struct Event
+{
+    const char  *name;
+    std::string  detail;
+    uint64_t     start_ns;
+    uint64_t     end_ns;
+};
+
+// Zones of a single thread. Only the owning thread appends, the mutex is locked by the exporter,
+// thus it is practically never contended.
+struct ThreadBuffer
+{
+    uint32_t            tid;
+    std::string         thread_name;
+    tbb::spin_mutex     mutex;
+    std::vector<Event>  events;
+};
+
+struct Registry
+{
+    std::mutex                                  mutex;
+    // The buffers are never released, the threads keep a pointer to their buffer in t_buffer.
+    std::vector<std::unique_ptr<ThreadBuffer>>  buffers;
+    // Time stamps are exported relative to the last clear().
+    std::atomic<uint64_t>                       origin_ns { 0 };
+};
+
+Registry& registry()
+{
+    static Registry s_registry;
+    return s_registry;
+}
+
+thread_local ThreadBuffer *t_buffer = nullptr;
+
+ThreadBuffer& thread_buffer()
+{
+    if (t_buffer == nullptr) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        std::optional<std::string> name = get_current_thread_name();
+        Registry &reg = registry();
+        std::scoped_lock<std::mutex> lock(reg.mutex);
+        buffer->tid         = uint32_t(reg.buffers.size());
+        buffer->thread_name = name && ! name->empty() ? *name : "thread " + std::to_string(buffer->tid);
+        t_buffer = buffer.get();
+        reg.buffers.emplace_back(std::move(buffer));
+    }
+    return *t_buffer;
+}
+
+void append_json_string(std::string &out, const char *str)
+{
+    out += '"';
+    for (const char *c = str; *c != 0; ++ c) {
+        switch (*c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20) {
+                char buf[8];
+                sprintf(buf, "\\u%04x", int(*c));
+                out += buf;
+            } else
+                out += *c;
+        }
+    }
+    out += '"';
+}
+
+// Appends nanoseconds as microseconds with three decimals. Only integers are formatted, so that the decimal
+// separator does not depend on the numeric locale of the caller (the GUI sets the user locale).
+void append_json_microseconds(std::string &out, uint64_t ns)
+{
+    char buf[32];
+    int  len = snprintf(buf, sizeof(buf), "%llu.%03u", (unsigned long long)(ns / 1000), unsigned(ns % 1000));
+    out.append(buf, size_t(len));
+}
+
+} // namespace
+
+namespace detail {
+    void record(const char *name, std::string &&detail, uint64_t start_ns, uint64_t end_ns)
+    {
+        ThreadBuffer &buffer = thread_buffer();
+        tbb::spin_mutex::scoped_lock lock(buffer.mutex);
+        buffer.events.push_back({ name, std::move(detail), start_ns, end_ns });
+    }
+} // namespace detail
+
+void enable(bool enable)
+{
+    if (enable && ! enabled())
+        registry().origin_ns = detail::now_ns();
+    detail::g_enabled.store(enable, std::memory_order_relaxed);
+}
+
+void clear()
+{
+    Registry &reg = registry();
+    std::scoped_lock<std::mutex> lock(reg.mutex);
+    for (std::unique_ptr<ThreadBuffer> &buffer : reg.buffers) {
+        tbb::spin_mutex::scoped_lock buffer_lock(buffer->mutex);
+        buffer->events.clear();
+        buffer->events.shrink_to_fit();
+    }
+    reg.origin_ns = detail::now_ns();
+}
+
+std::vector<ZoneStats> summary()
+{
+    std::map<std::string, ZoneStats> by_name;
+    Registry &reg = registry();
+    {
+        std::scoped_lock<std::mutex> lock(reg.mutex);
+        for (std::unique_ptr<ThreadBuffer> &buffer : reg.buffers) {
+            tbb::spin_mutex::scoped_lock buffer_lock(buffer->mutex);
+            for (const Event &event : buffer->events) {
+                ZoneStats &stats = by_name[event.name];
+                uint64_t   duration = event.end_ns - event.start_ns;
+                ++ stats.count;
+                stats.total_ns += duration;
+                stats.max_ns    = std::max(stats.max_ns, duration);
+            }
+        }
+    }
+    std::vector<ZoneStats> out;
+    out.reserve(by_name.size());
+    for (auto &[name, stats] : by_name) {
+        stats.name = name;
+        out.emplace_back(std::move(stats));
+    }
+    std::sort(out.begin(), out.end(), [](const ZoneStats &l, const ZoneStats &r) { return l.total_ns > r.total_ns; });
+    return out;
+}
+
+bool export_chrome_trace(const std::string &path)
+{
+    FILE *file = boost::nowide::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": can not open %1% for writing") % path;
+        return false;
+    }
+
+    Registry      &reg    = registry();
+    const uint64_t origin = reg.origin_ns;
+    size_t         num_events = 0;
+    std::string    out;
+    out.reserve(1 << 16);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto flush = [&out, file]() { ::fwrite(out.data(), 1, out.size(), file); out.clear(); };
+    {
+        std::scoped_lock<std::mutex> lock(reg.mutex);
+        for (std::unique_ptr<ThreadBuffer> &buffer : reg.buffers) {
+            tbb::spin_mutex::scoped_lock buffer_lock(buffer->mutex);
+            // Name the thread lane.
+            out += first ? "\n" : ",\n";
+            first = false;
+            out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + std::to_string(buffer->tid) + ",\"args\":{\"name\":";
+            append_json_string(out, buffer->thread_name.c_str());
+            out += "}}";
+            for (const Event &event : buffer->events) {
+                // Zones started before the last clear() are clamped.
+                uint64_t start = std::max(event.start_ns, origin);
+                uint64_t end   = std::max(event.end_ns, start);
+                out += ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(buffer->tid) + ",\"name\":";
+                append_json_string(out, event.name);
+                out += ",\"ts\":";
+                append_json_microseconds(out, start - origin);
+                out += ",\"dur\":";
+                append_json_microseconds(out, end - start);
+                if (! event.detail.empty()) {
+                    out += ",\"args\":{\"detail\":";
+                    append_json_string(out, event.detail.c_str());
+                    out += "}";
+                }
+                out += "}";
+                if (out.size() > (1 << 16))
+                    flush();
+            }
+            num_events += buffer->events.size();
+        }
+    }
+    out += "\n]}\n";
+    flush();
+    bool ok = ::ferror(file) == 0;
+    ok &= ::fclose(file) == 0;
+    if (ok)
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": exported %1% zones to %2%") % num_events % path;
+    else
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": failed to write %1%") % path;
+    return ok;
+}
+
+Session::Session(std::string path) : m_path(std::move(path))
+{
+    clear();
+    enable(true);
+}
+
+Session::~Session()
+{
+    enable(false);
+    for (const ZoneStats &stats : summary())
+        BOOST_LOG_TRIVIAL(info) << "profile zone " << stats.name << boost::format(": count %1%, total %2% ms, max %3% ms")
+            % stats.count % (double(stats.total_ns) * 1e-6) % (double(stats.max_ns) * 1e-6);
+    export_chrome_trace(m_path);
+}
+
+} // namespace Profiler
+} // namespace Slic3r
@@ -0,0 +1,98 @@
+#ifndef slic3r_Profiler_hpp_
+#define slic3r_Profiler_hpp_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Slic3r {
+
+// BBS: Scoped zone profiler of the slicing pipeline.
+// Zones are recorded per thread into thread local buffers and may nest, the nesting is reconstructed from the time stamps
+// by the trace viewers. While the profiler is disabled (the default), a zone costs a single relaxed atomic load.
+//
+//     SLIC3R_PROFILE_ZONE("PrintObject::infill");
+//     SLIC3R_PROFILE_ZONE_DETAIL("Layer::make_fills", std::to_string(layer_idx));
+//
+// The recorded zones are exported as Chrome trace JSON, which is understood by chrome://tracing and https://ui.perfetto.dev
+namespace Profiler {
+
+namespace detail {
+    extern std::atomic<bool> g_enabled;
+    uint64_t                 now_ns();
+    void                     record(const char *name, std::string &&detail, uint64_t start_ns, uint64_t end_ns);
+} // namespace detail
+
+inline bool enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+void        enable(bool enable);
+// Drop all zones recorded so far. Must not be called while zones are being recorded.
+void        clear();
+
+struct ZoneStats
+{
+    std::string name;
+    size_t      count    { 0 };
+    uint64_t    total_ns { 0 };
+    uint64_t    max_ns   { 0 };
+};
+// Aggregated zones by name, sorted by the total time, largest first.
+std::vector<ZoneStats> summary();
+
+// Write the zones recorded since the last clear() as Chrome trace JSON. Returns false if the file could not be written.
+bool        export_chrome_trace(const std::string &path);
+
+class Zone
+{
+public:
+    explicit Zone(const char *name) {
+        if (enabled()) {
+            m_name  = name;
+            m_start = detail::now_ns();
+        }
+    }
+    // The detail is only evaluated if the profiler is enabled, it is shown as an argument of the zone in the trace.
+    template<typename DetailFn>
+    Zone(const char *name, DetailFn &&detail_fn) {
+        if (enabled()) {
+            m_name   = name;
+            m_detail = detail_fn();
+            m_start  = detail::now_ns();
+        }
+    }
+    ~Zone() {
+        if (m_name)
+            detail::record(m_name, std::move(m_detail), m_start, detail::now_ns());
+    }
+
+    Zone(const Zone &) = delete;
+    Zone &operator=(const Zone &) = delete;
+
+private:
+    const char  *m_name  { nullptr };
+    uint64_t     m_start { 0 };
+    std::string  m_detail;
+};
+
+// Enables the profiler for its life time and writes the recorded zones into a Chrome trace file when destroyed.
+class Session
+{
+public:
+    explicit Session(std::string path);
+    ~Session();
+
+private:
+    std::string m_path;
+};
+
+} // namespace Profiler
+} // namespace Slic3r
+
+#define SLIC3R_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SLIC3R_PROFILE_CONCAT(a, b) SLIC3R_PROFILE_CONCAT_IMPL(a, b)
+#define SLIC3R_PROFILE_ZONE(name) ::Slic3r::Profiler::Zone SLIC3R_PROFILE_CONCAT(slic3r_profile_zone_, __LINE__)(name)
+#define SLIC3R_PROFILE_ZONE_DETAIL(name, detail) \
+    ::Slic3r::Profiler::Zone SLIC3R_PROFILE_CONCAT(slic3r_profile_zone_, __LINE__)(name, [&]() -> std::string { return detail; })
+
+#endif // slic3r_Profiler_hpp_
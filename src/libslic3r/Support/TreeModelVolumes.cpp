@@ -868,25 +868,104 @@ coord_t TreeModelVolumes::ceilRadius(const coord_t radius) const
     return out;
 }
 
-void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layers)
+void TreeModelVolumes::RadiusLayerPolygonCache::insert_entry(Layer &layer, coord_t radius, Polygons &&polygons)
 {
-    if (num_layers > m_data.size()) {
-        if (num_layers > m_data.capacity())
-            m_data.reserve(next_highest_power_of_2(num_layers));
-        m_data.resize(num_layers, {});
+    Entry *head = layer.head.load(std::memory_order_acquire);
+    if (find_entry(head, nullptr, radius))
+        // Already calculated by another thread.
+        return;
+    auto *entry = new Entry{ radius, std::move(polygons), head };
+    while (! layer.head.compare_exchange_weak(entry->next, entry, std::memory_order_release, std::memory_order_acquire)) {
+        // Another entry was prepended in the meantime, only the newly prepended entries need to be checked.
+        if (find_entry(entry->next, head, radius)) {
+            delete entry;
+            return;
+        }
+        head = entry->next;
+    }
+}
+
+TreeModelVolumes::RadiusLayerPolygonCache::Layer& TreeModelVolumes::RadiusLayerPolygonCache::get_allocate_layer(LayerIndex layer_idx)
+{
+    assert(layer_idx >= 0);
+    auto [segment, idx] = locate(size_t(layer_idx));
+    if (segment >= NumSegments)
+        throw Slic3r::RuntimeError("Tree support: Too many layers");
+    Layer *layers = m_segments[segment].load(std::memory_order_acquire);
+    if (layers == nullptr) {
+        auto *new_layers = new Layer[segment_size(segment)];
+        if (m_segments[segment].compare_exchange_strong(layers, new_layers, std::memory_order_acq_rel, std::memory_order_acquire))
+            layers = new_layers;
+        else
+            // Allocated by another thread.
+            delete[] new_layers;
     }
+    // Raise the number of layers to layer_idx + 1 unless another thread raised it further,
+    // a failed compare_exchange_weak() reloads num_layers.
+    size_t num_layers = m_num_layers.load(std::memory_order_relaxed);
+    while (num_layers <= size_t(layer_idx) && ! m_num_layers.compare_exchange_weak(num_layers, size_t(layer_idx) + 1, std::memory_order_release, std::memory_order_relaxed))
+        ;
+    return layers[idx];
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::move_from(RadiusLayerPolygonCache &rhs)
+{
+    for (size_t i = 0; i < NumSegments; ++ i)
+        m_segments[i].store(rhs.m_segments[i].exchange(nullptr));
+    m_num_layers.store(rhs.m_num_layers.exchange(0));
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear()
+{
+    this->clear_layers(0, std::numeric_limits<LayerIndex>::max());
+    for (std::atomic<Layer*> &segment : m_segments)
+        delete[] segment.exchange(nullptr);
+    m_num_layers.store(0);
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear_all_but_radius0()
+{
+    for (size_t layer_idx = 0; layer_idx < m_num_layers.load(); ++ layer_idx)
+        if (Layer *layer = const_cast<Layer*>(this->get_layer(LayerIndex(layer_idx))); layer) {
+            // Keep the entry with the smallest radius.
+            Entry *smallest = layer->head.load();
+            for (Entry *entry = smallest; entry; entry = entry->next)
+                if (entry->radius < smallest->radius)
+                    smallest = entry;
+            for (Entry *entry = layer->head.load(); entry;) {
+                Entry *next = entry->next;
+                if (entry != smallest)
+                    delete entry;
+                entry = next;
+            }
+            if (smallest)
+                smallest->next = nullptr;
+            layer->head.store(smallest);
+        }
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear_layers(LayerIndex begin, LayerIndex end)
+{
+    for (size_t layer_idx = size_t(std::max(0, begin)); layer_idx < std::min(size_t(std::max(0, end)), m_num_layers.load()); ++ layer_idx)
+        if (Layer *layer = const_cast<Layer*>(this->get_layer(LayerIndex(layer_idx))); layer)
+            for (Entry *entry = layer->head.exchange(nullptr); entry;) {
+                Entry *next = entry->next;
+                delete entry;
+                entry = next;
+            }
 }
 
 // For debugging purposes, sorted by layer index, then by radius.
 std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::sorted() const
 {
     std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> out;
-    for (auto &layer : m_data) {
-        auto layer_idx = LayerIndex(&layer - m_data.data());
-        for (auto &radius_polygons : layer)
-            out.emplace_back(std::make_pair(radius_polygons.first, layer_idx), radius_polygons.second);
-    }
-    assert(std::is_sorted(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second) && l.first.first < r.first.first; }));
+    for (size_t layer_idx = 0; layer_idx < m_num_layers.load(); ++ layer_idx)
+        if (const Layer *layer = this->get_layer(LayerIndex(layer_idx)); layer) {
+            size_t begin = out.size();
+            for (const Entry *entry = layer->head.load(std::memory_order_acquire); entry; entry = entry->next)
+                out.emplace_back(std::make_pair(entry->radius, LayerIndex(layer_idx)), entry->polygons);
+            std::sort(out.begin() + begin, out.end(), [](auto &l, auto &r){ return l.first.first < r.first.first; });
+        }
     return out;
 }
 
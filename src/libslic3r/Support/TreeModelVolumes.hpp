@@ -9,6 +9,8 @@
 #ifndef slic3r_TreeModelVolumes_hpp
 #define slic3r_TreeModelVolumes_hpp
 
+#include <array>
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 
@@ -68,6 +70,20 @@ public:
         m_wall_restrictions_cache.clear();
         m_wall_restrictions_cache_min.clear();
     }
+    // Reduce memory footprint while propagating the influence areas downwards: Release the avoidances and wall restrictions
+    // of the layers <begin, end), which are above the layers still being processed.
+    // Must not be called while other threads query the volumes.
+    void clear_avoidance_layers(LayerIndex begin, LayerIndex end) {
+        m_collision_cache_holefree.clear_layers(begin, end);
+        m_avoidance_cache.clear_layers(begin, end);
+        m_avoidance_cache_slow.clear_layers(begin, end);
+        m_avoidance_cache_to_model.clear_layers(begin, end);
+        m_avoidance_cache_to_model_slow.clear_layers(begin, end);
+        m_avoidance_cache_holefree.clear_layers(begin, end);
+        m_avoidance_cache_holefree_to_model.clear_layers(begin, end);
+        m_wall_restrictions_cache.clear_layers(begin, end);
+        m_wall_restrictions_cache_min.clear_layers(begin, end);
+    }
 
     enum class AvoidanceType : int8_t
     {
@@ -196,43 +212,49 @@ private:
      * \brief Convenience typedef for the keys to the caches
      */
     using RadiusLayerPair             = std::pair<coord_t, LayerIndex>;
+    // Cache of polygons indexed by layer and radius, shared by all the TBB workers generating the tree supports.
+    // The layers are stored in segments of doubling size, which are never reallocated, thus a layer may be looked up
+    // without locking while other layers are being allocated. Each layer keeps a lock-free singly linked list
+    // of radius / polygons entries, which are only ever prepended, thus the lookups do not lock either.
+    // Reference to Polygons returned shall be stable to insertion.
     class RadiusLayerPolygonCache {
-        // Map from radius to Polygons. Cache of one layer collision regions.
-        using LayerData = std::map<coord_t, Polygons>;
-        // Vector of layers, at each layer map of radius to Polygons.
-        // Reference to Polygons returned shall be stable to insertion.
-        using Layers = std::vector<LayerData>;
+        struct Entry {
+            coord_t     radius;
+            Polygons    polygons;
+            Entry      *next;
+        };
+        struct Layer {
+            std::atomic<Entry*> head { nullptr };
+        };
+        // Number of layers of the first segment, the following segments double in size.
+        static constexpr const size_t FirstSegmentSize = 64;
+        static constexpr const size_t NumSegments      = 24;
     public:
         RadiusLayerPolygonCache() = default;
-        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : m_data(std::move(rhs.m_data)) {}
-        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) { m_data = std::move(rhs.m_data); return *this; }
+        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) { this->move_from(rhs); }
+        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) { if (this != &rhs) { this->clear(); this->move_from(rhs); } return *this; }
+        ~RadiusLayerPolygonCache() { this->clear(); }
 
         RadiusLayerPolygonCache(const RadiusLayerPolygonCache&) = delete;
         RadiusLayerPolygonCache& operator=(const RadiusLayerPolygonCache&) = delete;
 
         void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first.second).emplace(d.first.first, std::move(d.second));
+                insert_entry(this->get_allocate_layer(d.first.second), d.first.first, std::move(d.second));
         }
         // by layer
         void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first).emplace(radius, std::move(d.second));
+                insert_entry(this->get_allocate_layer(d.first), radius, std::move(d.second));
         }
         void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            allocate_layers(first_layer_idx + in.size());
             for (auto &d : in)
-                m_data[first_layer_idx ++].emplace(radius, std::move(d));
+                insert_entry(this->get_allocate_layer(first_layer_idx ++), radius, std::move(d));
         }
         void insert(LayerPolygonCache &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             LayerIndex i = in.begin();
-            allocate_layers(i + LayerIndex(in.size()));
             for (auto &d : in.polygons_mutable())
-                m_data[i ++].emplace(radius, std::move(d));
+                insert_entry(this->get_allocate_layer(i ++), radius, std::move(d));
         }
         /*!
          * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
@@ -240,29 +262,23 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= m_data.size())
-                return std::optional<std::reference_wrapper<const Polygons>>{};
-            const auto &layer = m_data[key.second];
-            auto it = layer.find(key.first);
-            return it == layer.end() ? 
-                std::optional<std::reference_wrapper<const Polygons>>{} : std::optional<std::reference_wrapper<const Polygons>>{ it->second };
+            if (const Layer *layer = this->get_layer(key.second); layer)
+                if (const Entry *entry = find_entry(layer->head.load(std::memory_order_acquire), nullptr, key.first); entry)
+                    return std::optional<std::reference_wrapper<const Polygons>>{ entry->polygons };
+            return std::optional<std::reference_wrapper<const Polygons>>{};
         }
         // Get a collision area at a given layer for a radius that is a lower or equial to the key radius.
         std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= m_data.size())
+            const Layer *layer = this->get_layer(key.second);
+            if (! layer)
                 return {};
-            const auto &layer = m_data[key.second];
-            if (layer.empty())
+            const Entry *best = nullptr;
+            for (const Entry *entry = layer->head.load(std::memory_order_acquire); entry; entry = entry->next)
+                if (entry->radius <= key.first && (best == nullptr || entry->radius > best->radius))
+                    best = entry;
+            if (! best)
                 return {};
-            auto it = layer.lower_bound(key.first);
-            if (it == layer.end() || it->first != key.first) {
-                if (it == layer.begin())
-                    return {};
-                -- it;
-            }
-            return std::make_pair(it->first, std::reference_wrapper<const Polygons>(it->second));
+            return std::make_pair(best->radius, std::reference_wrapper<const Polygons>(best->polygons));
         }
         /*!
          * \brief Get the highest already calculated layer in the cache.
@@ -272,10 +288,9 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         LayerIndex getMaxCalculatedLayer(coord_t radius) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            auto layer_idx = LayerIndex(m_data.size()) - 1;
+            auto layer_idx = LayerIndex(m_num_layers.load(std::memory_order_acquire)) - 1;
             for (; layer_idx > 0; -- layer_idx)
-                if (const auto &layer = m_data[layer_idx]; layer.find(radius) != layer.end())
+                if (const Layer *layer = this->get_layer(layer_idx); layer && find_entry(layer->head.load(std::memory_order_acquire), nullptr, radius))
                     break;
             // The placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
             return layer_idx == 0 ? -1 : layer_idx;
@@ -284,25 +299,42 @@ private:
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
 
-        void clear() { m_data.clear(); }
-        void clear_all_but_radius0() { 
-            for (LayerData &l : m_data) {
-                auto begin = l.begin();
-                auto end = l.end();
-                if (begin != end && ++ begin != end)
-                    l.erase(begin, end);
-            }
-        }
+        // The following methods release memory, they must not be called while other threads access the cache.
+        void clear();
+        void clear_all_but_radius0();
+        // Release the layers <begin, end), which will not be queried anymore. They are recalculated if queried again.
+        void clear_layers(LayerIndex begin, LayerIndex end);
 
     private:
-        LayerData&          get_allocate_layer_data(LayerIndex layer_idx) {
-            allocate_layers(layer_idx + 1);
-            return m_data[layer_idx];
+        // Index of the segment and of the layer inside the segment.
+        static std::pair<size_t, size_t> locate(size_t layer_idx) {
+            size_t segment = 0;
+            for (size_t n = layer_idx / FirstSegmentSize + 1; n > 1; n >>= 1)
+                ++ segment;
+            return { segment, layer_idx - FirstSegmentSize * ((size_t(1) << segment) - 1) };
+        }
+        static size_t segment_size(size_t segment) { return FirstSegmentSize << segment; }
+        static const Entry* find_entry(const Entry *begin, const Entry *end, coord_t radius) {
+            for (const Entry *entry = begin; entry != end; entry = entry->next)
+                if (entry->radius == radius)
+                    return entry;
+            return nullptr;
+        }
+        static void insert_entry(Layer &layer, coord_t radius, Polygons &&polygons);
+
+        const Layer*        get_layer(LayerIndex layer_idx) const {
+            if (layer_idx < 0)
+                return nullptr;
+            auto [segment, idx] = locate(size_t(layer_idx));
+            const Layer *layers = segment < NumSegments ? m_segments[segment].load(std::memory_order_acquire) : nullptr;
+            return layers ? layers + idx : nullptr;
         }
-        void                allocate_layers(size_t num_layers);
+        Layer&              get_allocate_layer(LayerIndex layer_idx);
+        void                move_from(RadiusLayerPolygonCache &rhs);
 
-        Layers              m_data;
-        mutable std::mutex  m_mutex;
+        std::array<std::atomic<Layer*>, NumSegments> m_segments {};
+        // One past the highest layer allocated.
+        std::atomic<size_t> m_num_layers { 0 };
     };
 
 
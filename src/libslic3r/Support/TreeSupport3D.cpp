@@ -2291,7 +2291,7 @@ static void merge_influence_areas(
  *
  * \param move_bounds[in,out] All currently existing influence areas
  */
-void create_layer_pathing(const TreeModelVolumes &volumes, const TreeSupportSettings &config, std::vector<SupportElements> &move_bounds, std::function<void()> throw_on_cancel)
+void create_layer_pathing(TreeModelVolumes &volumes, const TreeSupportSettings &config, std::vector<SupportElements> &move_bounds, std::function<void()> throw_on_cancel)
 {
 #ifdef SLIC3R_TREESUPPORTS_PROGRESS
     const double data_size_inverse = 1 / double(move_bounds.size());
@@ -2307,6 +2307,8 @@ void create_layer_pathing(const TreeModelVolumes &volumes, const TreeSupportSett
     // Ensures at least one merge operation per 3mm height, 50 layers, 1 mm movement of slow speed or 5mm movement of fast speed (whatever is lowest). Values were guessed.
     size_t max_merge_every_x_layers = std::min(std::min(5000 / (std::max(config.maximum_move_distance, coord_t(100))), 1000 / std::max(config.maximum_move_distance_slow, coord_t(20))), 3000 / config.layer_height);
     size_t merge_every_x_layers = 1;
+    // Avoidances and wall restrictions above this layer were already released.
+    LayerIndex released_layer_idx = std::numeric_limits<LayerIndex>::max();
     // Calculate the influence areas for each layer below (Top down)
     // This is done by first increasing the influence area by the allowed movement distance, and merging them with other influence areas if possible
     for (int layer_idx = int(move_bounds.size()) - 1; layer_idx > 0; -- layer_idx)
@@ -2382,6 +2384,9 @@ void create_layer_pathing(const TreeModelVolumes &volumes, const TreeSupportSett
             progress_total += data_size_inverse * TREE_PROGRESS_AREA_CALC;
             Progress::messageProgress(Progress::Stage::SUPPORT, progress_total * m_progress_multiplier + m_progress_offset, TREE_PROGRESS_TOTAL);
     #endif
+            // The layers below only query the avoidances and wall restrictions of their own layer and of the layer below.
+            volumes.clear_avoidance_layers(layer_idx, released_layer_idx);
+            released_layer_idx = layer_idx;
             throw_on_cancel();
         }
 
@@ -1719,24 +1719,25 @@ void TriangleSelector::get_seed_fill_contour_recursive(const int facet_idx, cons
     }
 }
 
-std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> TriangleSelector::serialize() const
+TriangleSplittingData TriangleSelector::serialize() const
 {
     // Each original triangle of the mesh is assigned a number encoding its state
     // or how it is split. Each triangle is encoded by 4 bits (xxyy) or 8 bits (zzzzxxyy):
     // leaf triangle: xx = EnforcerBlockerType (Only values 0, 1, and 2. Value 3 is used as an indicator for additional 4 bits.), yy = 0
     // leaf triangle: xx = 0b11, yy = 0b00, zzzz = EnforcerBlockerType (subtracted by 3)
     // non-leaf:      xx = special side, yy = number of split sides
-    // These are bitwise appended and formed into one 64-bit integer.
+    // States of 18 and above are stored as a run of 0b1111 codes, each adding 15 to the last zzzz code.
+    // All the codes are 4 bits long, thus they are stored as a stream of nibbles.
 
     // The function returns a map from original triangle indices to
-    // stream of bits encoding state and offsprings.
+    // stream of codes encoding state and offsprings.
 
     // Using an explicit function object to support recursive call of Serializer::serialize().
     // This is cheaper than the previous implementation using a recursive call of type erased std::function.
     // (std::function calls using a pointer, while this implementation calls directly).
     struct Serializer {
         const TriangleSelector* triangle_selector;
-        std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> data;
+        TriangleSplittingData   data;
 
         void serialize(int facet_idx) {
             const Triangle& tr = triangle_selector->m_triangles[facet_idx];
@@ -1745,17 +1746,13 @@ std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> TriangleSelector:
             int split_sides = tr.number_of_split_sides();
             assert(split_sides >= 0 && split_sides <= 3);
 
-            data.second.push_back(split_sides & 0b01);
-            data.second.push_back(split_sides & 0b10);
-
             if (split_sides) {
                 // If this triangle is split, save which side is split (in case
                 // of one split) or kept (in case of two splits). The value will
                 // be ignored for 3-side split.
                 assert(tr.is_split() && split_sides > 0);
                 assert(tr.special_side() >= 0 && tr.special_side() <= 3);
-                data.second.push_back(tr.special_side() & 0b01);
-                data.second.push_back(tr.special_side() & 0b10);
+                data.push_code(split_sides | (tr.special_side() << 2));
                 // Now save all children.
                 // Serialized in reverse order for compatibility with PrusaSlicer 2.3.1.
                 for (int child_idx = split_sides; child_idx >= 0; -- child_idx)
@@ -1764,60 +1761,86 @@ std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> TriangleSelector:
                 // In case this is leaf, we better save information about its state.
                 int n = int(tr.get_state());
                 if (n >= 3) {
-                    data.second.insert(data.second.end(), {true, true});
+                    data.push_code(0b1100);
                     n -= 3;
                     while (n >= 15) {
-                        data.second.insert(data.second.end(), {true, true, true, true});
+                        data.push_code(0b1111);
                         n -= 15;
                     }
-
-                    for (size_t bit_idx = 0; bit_idx < 4; ++bit_idx)
-                        data.second.push_back(n & (uint64_t(0b0001) << bit_idx));
+                    data.push_code(n);
                 } else {
                     // Simple case, compatible with PrusaSlicer 2.3.1 and older for storing paint on supports and seams.
-                    // Store 2 bits of n.
-                    data.second.push_back(n & 0b01);
-                    data.second.push_back(n & 0b10);
+                    data.push_code(n << 2);
                 }
             }
         }
     } out { this };
 
-    out.data.first.reserve(m_orig_size_indices);
+    out.data.triangles_to_split.reserve(m_orig_size_indices);
     for (int i=0; i<m_orig_size_indices; ++i)
         if (const Triangle& tr = m_triangles[i]; tr.is_split() || tr.get_state() != EnforcerBlockerType::NONE) {
-            // Store index of the first bit assigned to ith triangle.
-            out.data.first.emplace_back(i, int(out.data.second.size()));
-            // out the triangle bits.
+            // Store index of the first code assigned to ith triangle.
+            out.data.triangles_to_split.emplace_back(i, out.data.num_codes);
+            // out the triangle codes.
             out.serialize(i);
         }
 
     // May be stored onto Undo / Redo stack, thus conserve memory.
-    out.data.first.shrink_to_fit();
-    out.data.second.shrink_to_fit();
+    out.data.shrink_to_fit();
     return out.data;
 }
 
-void TriangleSelector::deserialize(const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> &data,
-                                   bool                                                                  needs_reset,
-                                   EnforcerBlockerType                                                   max_ebt,
-                                   EnforcerBlockerType                                                   to_delete_filament,
-                                   EnforcerBlockerType                                                   replace_filament)
+// The split trees are stored depth first one after the other, thus the leaves may be visited by a linear scan
+// of the codes without rebuilding the trees. Returns the number of nodes of all the trees.
+// visit_leaf(state) returns false to stop the scan.
+template<typename VisitLeaf>
+static int scan_serialized_leaves(const TriangleSplittingData &data, VisitLeaf visit_leaf)
+{
+    int num_nodes = 0;
+    for (int icode = 0; icode < data.num_codes;) {
+        int code = data.code(icode ++);
+        ++ num_nodes;
+        if ((code & 0b11) != 0)
+            // Split node.
+            continue;
+        int state = code >> 2;
+        if (state == 0b11) {
+            // Extended state, see TriangleSelector::serialize().
+            int num = 0;
+            int next_code = icode < data.num_codes ? data.code(icode ++) : 0;
+            while (next_code == 0b1111 && icode < data.num_codes) {
+                ++ num;
+                next_code = data.code(icode ++);
+            }
+            state = next_code + 15 * num + 3;
+        }
+        if (! visit_leaf(state))
+            break;
+    }
+    return num_nodes;
+}
+
+void TriangleSelector::deserialize(const TriangleSplittingData &data,
+                                   bool                         needs_reset,
+                                   EnforcerBlockerType          max_ebt,
+                                   EnforcerBlockerType          to_delete_filament,
+                                   EnforcerBlockerType          replace_filament)
 {
     if (needs_reset)
         reset(); // dump any current state
-    for (auto [triangle_id, ibit] : data.first) {
+    for (auto [triangle_id, icode] : data.triangles_to_split) {
         if (triangle_id >= int(m_triangles.size())) {
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << "array bound:error:triangle_id >= int(m_triangles.size())";
             return;
         }
     }
-    // Reserve number of triangles as if each triangle was saved with 4 bits.
-    // With MMU painting this estimate may be somehow low, but better than nothing.
-    m_triangles.reserve(std::max(m_mesh.its.indices.size(), data.second.size() / 4));
+    // Each node of a split tree except for its root becomes a new triangle. Reserve the exact count to avoid
+    // reallocations of a heavily painted mesh, which would temporarily double the memory.
+    int num_nodes = scan_serialized_leaves(data, [](int) { return true; });
+    m_triangles.reserve(m_triangles.size() + size_t(std::max(0, num_nodes - int(data.triangles_to_split.size()))));
     // Number of triangles is twice the number of vertices on a large manifold mesh of genus zero.
     // Here the triangles count account for both the nodes and leaves, thus the following line may overestimate.
-    m_vertices.reserve(std::max(m_mesh.its.vertices.size(), m_triangles.size() / 2));
+    m_vertices.reserve(std::max(m_mesh.its.vertices.size(), m_triangles.capacity() / 2));
 
     // Vector to store all parents that have offsprings.
     struct ProcessingInfo {
@@ -1830,15 +1853,10 @@ void TriangleSelector::deserialize(const std::pair<std::vector<std::pair<int, in
     // kept outside of the loop to avoid re-allocating inside the loop.
     std::vector<ProcessingInfo> parents;
 
-    for (auto [triangle_id, ibit] : data.first) {
+    for (auto [triangle_id, icode] : data.triangles_to_split) {
         assert(triangle_id < int(m_triangles.size()));
-        assert(ibit < int(data.second.size()));
-        auto next_nibble = [&data, &ibit = ibit]() {
-            int n = 0;
-            for (int i = 0; i < 4; ++ i)
-                n |= data.second[ibit ++] << i;
-            return n;
-        };
+        assert(icode < data.num_codes);
+        auto next_nibble = [&data, &icode = icode]() { return data.code(icode ++); };
 
         parents.clear();
         while (true) {
@@ -1936,69 +1954,25 @@ void TriangleSelector::deserialize(const std::pair<std::vector<std::pair<int, in
 }
 
 // Lightweight variant of deserialization, which only tests whether a face of test_state exists.
-bool TriangleSelector::has_facets(const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> &data, const EnforcerBlockerType test_state)
-{
-    // Depth-first queue of a number of unvisited children.
-    // Kept outside of the loop to avoid re-allocating inside the loop.
-    std::vector<int> parents_children;
-    parents_children.reserve(64);
-
-    for (const std::pair<int, int> &triangle_id_and_ibit : data.first) {
-        int ibit = triangle_id_and_ibit.second;
-        assert(ibit < int(data.second.size()));
-        auto next_nibble = [&data, &ibit = ibit]() {
-            int n = 0;
-            for (int i = 0; i < 4; ++ i)
-                n |= data.second[ibit ++] << i;
-            return n;
-        };
-        // < 0 -> negative of a number of children
-        // >= 0 -> state
-        auto num_children_or_state = [&next_nibble]() -> int {
-            int code               = next_nibble();
-            int num_of_split_sides = code & 0b11;
-            if (num_of_split_sides == 0) {
-                int state = 0;
-                if ((code & 0b1100) == 0b1100) {
-                    int next_code = next_nibble();
-                    int num       = 0;
-                    while (next_code == 0b1111) {
-                        num++;
-                        next_code = next_nibble();
-                    }
-                    state = next_code + 15 * num + 3; // old:next_nibble() + 3;
-                } else {
-                    state = code >> 2;
-                }
-                return state;
-            } else {
-                return -num_of_split_sides - 1;// < 0 -> negative of a number of children
-            }
-        };
-
-        int state = num_children_or_state();
-        if (state < 0) {
-            // Root is split.
-            parents_children.clear();
-            parents_children.emplace_back(- state);
-            do {
-                if (-- parents_children.back() >= 0) {
-                    int state = num_children_or_state();
-                    if (state < 0)
-                        // Child is split.
-                        parents_children.emplace_back(- state);
-                    else if (state == int(test_state))
-                        // Child is not split and a face of test_state was found.
-                        return true;
-                } else
-                    parents_children.pop_back();
-            } while (! parents_children.empty());
-        } else if (state == int(test_state))
-            // Root is not split and a face of test_state was found.
-            return true;
-    }
+bool TriangleSelector::has_facets(const TriangleSplittingData &data, const EnforcerBlockerType test_state)
+{
+    bool found = false;
+    scan_serialized_leaves(data, [&found, test_state](int state) {
+        found = state == int(test_state);
+        return ! found;
+    });
+    return found;
+}
 
-    return false;
+EnforcerBlockerStates TriangleSelector::get_used_states(const TriangleSplittingData &data)
+{
+    EnforcerBlockerStates used_states;
+    scan_serialized_leaves(data, [&used_states](int state) {
+        if (state >= 0 && state < int(used_states.size()))
+            used_states.set(state);
+        return true;
+    });
+    return used_states;
 }
 
 void TriangleSelector::seed_fill_unselect_all_triangles()
@@ -1,10 +1,17 @@
+#include <algorithm>
 #include <exception>
+#include <memory>
+#include <vector>
 
 #include "miniz_extension.hpp"
 
 #if defined(_MSC_VER) || defined(__MINGW64__)
 #include "boost/nowide/cstdio.hpp"
 #endif
+#include <boost/nowide/fstream.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 
 #include "I18N.hpp"
 
@@ -76,6 +83,91 @@ bool open_zip_writer(mz_zip_archive *zip, const std::string &fname)
 bool close_zip_reader(mz_zip_archive *zip) { return close_zip(zip, true); }
 bool close_zip_writer(mz_zip_archive *zip) { return close_zip(zip, false); }
 
+namespace {
+static constexpr size_t DEFLATE_BLOCK_SIZE = 1024 * 1024;
+
+struct DeflateBlock
+{
+    std::string in;
+    std::string out;
+    bool        last { false };
+    bool        ok { false };
+};
+
+mz_bool deflate_block_put_buf(const void *buf, int len, void *user)
+{
+    static_cast<std::string *>(user)->append(static_cast<const char *>(buf), size_t(len));
+    return MZ_TRUE;
+}
+
+// Each block gets its own compressor. Non-last blocks end with a sync flush (empty stored block),
+// which byte aligns the output and does not set BFINAL, so the outputs can be simply concatenated.
+bool deflate_block(DeflateBlock &block, mz_uint comp_flags)
+{
+    std::unique_ptr<tdefl_compressor, decltype(&free)> comp((tdefl_compressor *)malloc(sizeof(tdefl_compressor)), &free);
+    if (!comp || tdefl_init(comp.get(), deflate_block_put_buf, &block.out, int(comp_flags)) != TDEFL_STATUS_OKAY)
+        return false;
+    block.out.reserve(block.in.size() / 3 + 64);
+    size_t in_size = block.in.size();
+    tdefl_status status = tdefl_compress_buffer(comp.get(), block.in.data(), in_size, block.last ? TDEFL_FINISH : TDEFL_SYNC_FLUSH);
+    return block.last ? status == TDEFL_STATUS_DONE : status == TDEFL_STATUS_OKAY;
+}
+}
+
+bool deflate_file_parallel(const std::string &fname_utf8, int level, MZ_DeflatedData &deflated)
+{
+    deflated = MZ_DeflatedData();
+    boost::nowide::ifstream ifs(fname_utf8, std::ios::binary);
+    if (!ifs.good())
+        return false;
+
+    const mz_uint comp_flags = tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    // Two blocks in flight per worker keep all of them busy while bounding the memory.
+    const size_t batch_size = size_t(std::max(1, 2 * tbb::this_task_arena::max_concurrency()));
+    std::vector<DeflateBlock> blocks(batch_size);
+    bool eof = false;
+    while (!eof) {
+        size_t num_blocks = 0;
+        for (; num_blocks < batch_size && !eof; ++num_blocks) {
+            DeflateBlock &block = blocks[num_blocks];
+            block.in.resize(DEFLATE_BLOCK_SIZE);
+            ifs.read(block.in.data(), std::streamsize(DEFLATE_BLOCK_SIZE));
+            block.in.resize(size_t(ifs.gcount()));
+            if (ifs.bad())
+                return false;
+            // The last block may be empty, it only carries the final block marker then.
+            eof = ifs.eof() || ifs.peek() == std::char_traits<char>::eof();
+            block.last = eof;
+            block.out.clear();
+            block.ok = false;
+        }
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks, 1), [&blocks, comp_flags](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++i)
+                blocks[i].ok = deflate_block(blocks[i], comp_flags);
+        });
+
+        for (size_t i = 0; i < num_blocks; ++i) {
+            DeflateBlock &block = blocks[i];
+            if (!block.ok)
+                return false;
+            deflated.crc32 = (mz_uint32)mz_crc32(deflated.crc32, (const unsigned char *)block.in.data(), block.in.size());
+            deflated.uncomp_size += block.in.size();
+            deflated.data += block.out;
+        }
+    }
+    return true;
+}
+
+bool add_deflated_to_zip(mz_zip_archive *zip, const char *name_in_zip, const MZ_DeflatedData &deflated, int level)
+{
+    // The level shares its argument with the flags, MZ_DEFAULT_COMPRESSION (-1) would set all of them.
+    // The data is a deflate stream even for level 0, a zero level would store the entry with the stored method.
+    const mz_uint level_bits = (level < 0) ? MZ_DEFAULT_LEVEL : std::clamp(level, 1, int(MZ_UBER_COMPRESSION));
+    return mz_zip_writer_add_mem_ex(zip, name_in_zip, deflated.data.data(), deflated.data.size(), nullptr, 0,
+                                    level_bits | MZ_ZIP_FLAG_COMPRESSED_DATA, deflated.uncomp_size, deflated.crc32);
+}
+
 MZ_Archive::MZ_Archive()
 {
     mz_zip_zero_struct(&arch);
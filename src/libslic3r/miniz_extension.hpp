@@ -11,6 +11,23 @@ bool open_zip_writer(mz_zip_archive *zip, const std::string &fname_utf8);
 bool close_zip_reader(mz_zip_archive *zip);
 bool close_zip_writer(mz_zip_archive *zip);
 
+//BBS: raw deflate stream of a whole file, together with the size and crc32
+// needed to store it with mz_zip_writer_add_mem_ex() and MZ_ZIP_FLAG_COMPRESSED_DATA.
+struct MZ_DeflatedData
+{
+    std::string data;
+    mz_uint64   uncomp_size { 0 };
+    mz_uint32   crc32 { 0 };
+};
+
+//BBS: deflate a file pigz style: the file is cut into blocks which are compressed in parallel
+// and concatenated with sync flushes in between, so the result is a single valid deflate stream.
+// The blocks do not share their dictionaries, which costs a fraction of a percent of the ratio.
+// Only a bounded number of blocks is kept in memory at once.
+bool deflate_file_parallel(const std::string &fname_utf8, int level, MZ_DeflatedData &deflated);
+// Store data produced by deflate_file_parallel() as a compressed entry of the archive.
+bool add_deflated_to_zip(mz_zip_archive *zip, const char *name_in_zip, const MZ_DeflatedData &deflated, int level);
+
 class MZ_Archive {
 public:
     mz_zip_archive arch;
@@ -0,0 +1,26 @@
+#ifndef slic3r_bench_hpp_
+#define slic3r_bench_hpp_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Slic3r { namespace Bench {
+
+// Counters of the global operator new / delete, replaced by bench_memory.cpp.
+struct AllocationCounters
+{
+    uint64_t count { 0 };
+    uint64_t bytes { 0 };
+    uint64_t frees { 0 };
+};
+AllocationCounters allocation_counters();
+
+// Reset the peak resident set size, so that peak_rss() reports the peak of the following stage only.
+// Returns false if the platform does not allow resetting the peak, then peak_rss() is the peak of the whole process.
+bool   reset_peak_rss();
+// Peak resident set size in bytes, 0 if unknown.
+size_t peak_rss();
+
+} } // namespace Slic3r::Bench
+
+#endif // slic3r_bench_hpp_
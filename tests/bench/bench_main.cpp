@@ -0,0 +1,558 @@
+// Slicing benchmark suite.
+//
+// Slices the models of tests/data and synthetic stress models and reports the wall time, allocation count and peak memory
+// of Print::process(), of the individual PrintObject / Print steps and G-code export stages (collected through the Profiler zones),
+// of Print::export_gcode() (also without GCode::collect_layer_islands()) and of GCodeProcessor::process_file() (also with the G1 times
+// spilled to disk in small blocks and with all of them kept in memory, the moves and the line ends stay in memory either way). The project cases store and load the model as a bbs 3mf project,
+// the sliced ones also store the G-code into the 3mf. The G1 moves of the exported G-code are formatted again by GCodeG1Formatter,
+// by the std::to_chars() based formatter it replaced and by printf() to compare the fixed-point number formatting of the G-code export
+// against the previous and the generic one. The moves formatted differently by the two G-code formatters are counted.
+// Finally the layers are released to measure the teardown of the extrusion entities.
+//
+//     bench [--list] [--filter <substring>] [--repeat <n>] [--threads <n>] [--clipper2] [--json <file>]
+//
+// --clipper2 runs the boolean operations and the offsets of ClipperUtils on the Clipper2 backend, to compare it against ClipperLib.
+// The JSON output is meant to be stored per commit, so that performance regressions can be tracked over time.
+
+#include "bench.hpp"
+#include "gcode_formatter_reference.hpp"
+#include "test_data.hpp"
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/Format/OBJ.hpp"
+#include "libslic3r/Format/bbs_3mf.hpp"
+#include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCodeWriter.hpp"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/ModelArrange.hpp"
+#include "libslic3r/Preset.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/Profiler.hpp"
+#include "libslic3r/Timer.hpp"
+#include "libslic3r/TriangleSelector.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <tbb/global_control.h>
+
+#include "nlohmann/json.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+namespace {
+
+struct BenchCase
+{
+    std::string name;
+    std::string description;
+    // Fill in the model and adjust the configuration, the objects are arranged afterwards.
+    std::function<void(Model &model, DynamicPrintConfig &config)> setup;
+    // Measure store_bbs_3mf() and load_bbs_3mf() of the model.
+    bool project_io { false };
+    bool slice      { true };
+};
+
+// Measurements of a stage, one per repetition.
+struct StageResult
+{
+    std::vector<double>   wall_ms;
+    std::vector<uint64_t> allocations;
+    std::vector<uint64_t> allocated_bytes;
+    std::vector<uint64_t> frees;
+    std::vector<size_t>   peak_rss;
+};
+
+ModelObject* add_object(Model &model, TriangleMesh &&mesh, const std::string &name, size_t instances = 1)
+{
+    ModelObject *object = model.add_object();
+    object->name = name;
+    object->add_volume(std::move(mesh));
+    for (size_t i = 0; i < instances; ++ i)
+        object->add_instance();
+    return object;
+}
+
+TriangleMesh load_test_data_obj(const std::string &name)
+{
+    TriangleMesh mesh;
+    ObjInfo      obj_info;
+    std::string  message;
+    std::string  path = std::string(TEST_DATA_DIR) + "/" + name + ".obj";
+    if (! load_obj(path.c_str(), &mesh, obj_info, message))
+        throw Slic3r::RuntimeError("Failed to load " + path + ": " + message);
+    return mesh;
+}
+
+// Make the configuration print with num_filaments filaments.
+void set_num_filaments(DynamicPrintConfig &config, size_t num_filaments)
+{
+    for (const std::string &key : Preset::filament_options())
+        if (auto *opt = dynamic_cast<ConfigOptionVectorBase*>(config.optptr(key)); opt != nullptr && opt->size() > 0)
+            opt->resize(num_filaments);
+}
+
+// Paint the facets in horizontal stripes alternating the four filaments.
+void paint_stripes(ModelVolume &volume)
+{
+    TriangleSelector selector(volume.mesh());
+    const indexed_triangle_set &its = volume.mesh().its;
+    for (int facet_idx = 0; facet_idx < int(its.indices.size()); ++ facet_idx) {
+        float z = its.vertices[its.indices[facet_idx](0)].z();
+        selector.set_facet(facet_idx, EnforcerBlockerType(1 + (int(std::floor(z / 3.f)) & 3)));
+    }
+    volume.mmu_segmentation_facets.set(selector);
+}
+
+const std::vector<BenchCase>& bench_cases()
+{
+    static std::vector<BenchCase> cases {
+        { "cube_20x20x20", "20mm cube",
+          [](Model &model, DynamicPrintConfig &) { add_object(model, mesh(TestMesh::cube_20x20x20), "cube_20x20x20"); } },
+        { "sphere_50mm", "50mm sphere",
+          [](Model &model, DynamicPrintConfig &) { add_object(model, mesh(TestMesh::sphere_50mm), "sphere_50mm"); } },
+        { "ipadstand", "ipad stand",
+          [](Model &model, DynamicPrintConfig &) { add_object(model, mesh(TestMesh::ipadstand), "ipadstand"); } },
+        { "extruder_idler", "tests/data/extruder_idler.obj",
+          [](Model &model, DynamicPrintConfig &) { add_object(model, load_test_data_obj("extruder_idler"), "extruder_idler"); } },
+        { "frog_legs", "tests/data/frog_legs.obj",
+          [](Model &model, DynamicPrintConfig &) { add_object(model, load_test_data_obj("frog_legs"), "frog_legs"); } },
+        { "overhang_support", "tests/data/overhang.obj with support",
+          [](Model &model, DynamicPrintConfig &config) {
+              add_object(model, load_test_data_obj("overhang"), "overhang");
+              config.set_deserialize_strict({ { "enable_support", true } });
+          } },
+        { "organic_support_tall", "50mm sphere stretched to 150mm height with organic tree supports",
+          [](Model &model, DynamicPrintConfig &config) {
+              TriangleMesh tall = mesh(TestMesh::sphere_50mm);
+              tall.scale(Vec3f(0.6f, 0.6f, 3.f));
+              add_object(model, std::move(tall), "tall_ellipsoid");
+              config.set_deserialize_strict({ { "enable_support", true }, { "support_type", "tree(auto)" }, { "support_style", "tree_organic" } });
+          } },
+        // Synthetic stress models.
+        { "dense_sphere", "sphere with about 650k triangles",
+          [](Model &model, DynamicPrintConfig &) { add_object(model, make_sphere(50., PI / 400.), "dense_sphere"); } },
+        { "many_instances", "64 instances of a cube with a hole",
+          [](Model &model, DynamicPrintConfig &) { add_object(model, mesh(TestMesh::cube_with_hole), "cube_with_hole", 64); } },
+        { "many_parts_travel", "144 instances of a half sized cube with a hole, travels avoiding the walls",
+          [](Model &model, DynamicPrintConfig &config) {
+              TriangleMesh part = mesh(TestMesh::cube_with_hole);
+              part.scale(0.5f);
+              add_object(model, std::move(part), "cube_with_hole", 144);
+              config.set_deserialize_strict({ { "reduce_crossing_wall", true } });
+          } },
+        { "gyroid_dense_plate", "4 flat 90x90x6mm boxes with 50% gyroid infill",
+          [](Model &model, DynamicPrintConfig &config) {
+              for (int i = 0; i < 4; ++ i)
+                  add_object(model, make_cube(90., 90., 6.), "box_" + std::to_string(i));
+              config.set_deserialize_strict({ { "sparse_infill_pattern", "gyroid" }, { "sparse_infill_density", "50%" } });
+          } },
+        { "painted_4_colors", "50mm sphere painted in 4 colors",
+          [](Model &model, DynamicPrintConfig &config) {
+              ModelObject *object = add_object(model, mesh(TestMesh::sphere_50mm), "painted_sphere");
+              paint_stripes(*object->volumes.front());
+              set_num_filaments(config, 4);
+          } },
+        // Project files.
+        { "project_3mf_1m", "3mf project of a painted sphere with about 1.3M triangles, store and load only",
+          [](Model &model, DynamicPrintConfig &config) {
+              ModelObject *object = add_object(model, make_sphere(50., PI / 570.), "dense_painted_sphere");
+              paint_stripes(*object->volumes.front());
+              set_num_filaments(config, 4);
+          }, true, false },
+        { "project_3mf_objects", "3mf project of 16 spheres with about 80k triangles each, store and load only",
+          [](Model &model, DynamicPrintConfig &) {
+              for (int i = 0; i < 16; ++ i)
+                  add_object(model, make_sphere(10., PI / 140.), "sphere_" + std::to_string(i));
+          }, true, false },
+        { "project_gcode_3mf", "sliced 3mf project of 64 cubes with a hole, including the G-code",
+          [](Model &model, DynamicPrintConfig &) { add_object(model, mesh(TestMesh::cube_with_hole), "cube_with_hole", 64); }, true, true },
+    };
+    return cases;
+}
+
+struct Options
+{
+    std::string filter;
+    std::string json_path;
+    size_t      repeat  { 1 };
+    size_t      threads { 0 };
+    bool        list    { false };
+    bool        clipper2 { false };
+};
+
+bool parse_options(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        auto value = [&](const char *name) -> const char* {
+            if (i + 1 == argc) {
+                std::cerr << "Missing value of " << name << std::endl;
+                return nullptr;
+            }
+            return argv[++ i];
+        };
+        const char *v = nullptr;
+        if (arg == "--list")
+            options.list = true;
+        else if (arg == "--filter" && (v = value("--filter")))
+            options.filter = v;
+        else if (arg == "--json" && (v = value("--json")))
+            options.json_path = v;
+        else if (arg == "--repeat" && (v = value("--repeat")))
+            options.repeat = std::max<size_t>(1, std::strtoul(v, nullptr, 10));
+        else if (arg == "--threads" && (v = value("--threads")))
+            options.threads = std::strtoul(v, nullptr, 10);
+        else if (arg == "--clipper2")
+            options.clipper2 = true;
+        else {
+            std::cerr << "Usage: bench [--list] [--filter <substring>] [--repeat <n>] [--threads <n>] [--clipper2] [--json <file>]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+struct GCodeMove
+{
+    Vec3d  pos;
+    double e;
+};
+
+// Collect the G1 moves of a G-code file with their absolute XYZ positions.
+std::vector<GCodeMove> read_moves(const std::string &path)
+{
+    std::vector<GCodeMove> moves;
+    GCodeReader reader;
+    reader.parse_file(path, [&moves](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+        if (line.cmd_is("G1"))
+            moves.push_back({ Vec3d(line.new_X(reader), line.new_Y(reader), line.new_Z(reader)), line.has(E) ? double(line.e()) : 0. });
+    });
+    return moves;
+}
+
+// Run fn as a single benchmark stage, appending the measurements of this repetition to result.
+template<typename Fn>
+void measure(StageResult &result, Fn &&fn)
+{
+    Bench::reset_peak_rss();
+    Bench::AllocationCounters before = Bench::allocation_counters();
+    Timing::Timer timer;
+    timer.start();
+    fn();
+    result.wall_ms.emplace_back(double(timer.elapsed_nanoseconds()) * 1e-6);
+    Bench::AllocationCounters after = Bench::allocation_counters();
+    result.allocations.emplace_back(after.count - before.count);
+    result.allocated_bytes.emplace_back(after.bytes - before.bytes);
+    result.frees.emplace_back(after.frees - before.frees);
+    result.peak_rss.emplace_back(Bench::peak_rss());
+}
+
+template<typename T>
+T median(std::vector<T> values)
+{
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n == 0 ? T(0) : (n % 2 == 1) ? values[n / 2] : T((values[n / 2 - 1] + values[n / 2]) / 2);
+}
+
+template<typename T>
+T max_value(const std::vector<T> &values)
+{
+    return values.empty() ? T(0) : *std::max_element(values.begin(), values.end());
+}
+
+// The allocation counters are reported as the median over the repetitions, the peak memory as the maximum,
+// the measurements of the individual repetitions are kept as well.
+nlohmann::json to_json(const StageResult &stage)
+{
+    nlohmann::json out;
+    out["wall_ms_median"]  = median(stage.wall_ms);
+    out["wall_ms_min"]     = stage.wall_ms.empty() ? 0. : *std::min_element(stage.wall_ms.begin(), stage.wall_ms.end());
+    out["wall_ms"]         = stage.wall_ms;
+    out["allocations"]     = median(stage.allocations);
+    out["allocated_bytes"] = median(stage.allocated_bytes);
+    out["frees"]           = median(stage.frees);
+    out["peak_rss_bytes"]  = max_value(stage.peak_rss);
+    out["repetitions"]["allocations"]     = stage.allocations;
+    out["repetitions"]["allocated_bytes"] = stage.allocated_bytes;
+    out["repetitions"]["frees"]           = stage.frees;
+    out["repetitions"]["peak_rss_bytes"]  = stage.peak_rss;
+    return out;
+}
+
+nlohmann::json run_case(const BenchCase &bench_case, size_t repeat)
+{
+    std::map<std::string, StageResult> stages;
+    // Zone name -> total time of the zone in each repetition.
+    std::map<std::string, std::vector<double>> zones;
+    size_t num_triangles = 0;
+    size_t num_layers    = 0;
+    size_t gcode_size    = 0;
+    size_t num_moves     = 0;
+    size_t moves_size[3] = { 0, 0, 0 };
+    size_t moves_mismatches = 0;
+
+    for (size_t i = 0; i < repeat; ++ i) {
+        Print              print;
+        Model              model;
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        boost::filesystem::path gcode_path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("bench-%%%%-%%%%.gcode");
+
+        measure(stages["setup"], [&]() {
+            bench_case.setup(model, config);
+            arrange_objects(model, InfiniteBed{}, ArrangeParams{ scaled(min_object_distance(config)) });
+            for (ModelObject *mo : model.objects) {
+                mo->ensure_on_bed();
+                print.auto_assign_extruders(mo);
+            }
+            print.apply(model, config);
+            print.validate();
+            print.set_status_silent();
+        });
+
+        if (bench_case.project_io) {
+            const std::string project_path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("bench-%%%%-%%%%.3mf")).string();
+            measure(stages["store_3mf"], [&]() {
+                StoreParams store_params;
+                store_params.path     = project_path.c_str();
+                store_params.model    = &model;
+                store_params.config   = &config;
+                store_params.strategy = SaveStrategy::Silence | SaveStrategy::SplitModel | SaveStrategy::Zip64;
+                if (! store_bbs_3mf(store_params))
+                    throw Slic3r::RuntimeError("Failed to store " + project_path);
+            });
+            measure(stages["load_3mf"], [&project_path]() {
+                Model                     loaded_model;
+                DynamicPrintConfig        loaded_config;
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Enable };
+                PlateDataPtrs             plate_data;
+                std::vector<Preset*>      project_presets;
+                bool                      is_bbl_3mf = false;
+                Semver                    file_version;
+                if (! load_bbs_3mf(project_path.c_str(), &loaded_config, &ctxt, &loaded_model, &plate_data, &project_presets, &is_bbl_3mf, &file_version,
+                        nullptr, LoadStrategy::LoadModel | LoadStrategy::AddDefaultInstances))
+                    throw Slic3r::RuntimeError("Failed to load " + project_path);
+                release_PlateData_list(plate_data);
+            });
+            boost::filesystem::remove(project_path);
+        }
+
+        num_triangles = 0;
+        for (const ModelObject *mo : model.objects)
+            for (const ModelVolume *mv : mo->volumes)
+                num_triangles += mv->mesh().facets_count() * mo->instances.size();
+        if (! bench_case.slice)
+            continue;
+
+        Profiler::clear();
+        Profiler::enable(true);
+        measure(stages["process"], [&print]() { print.process(); });
+        // The G-code export zones (seam placement, G-code generation) are collected as well.
+        measure(stages["export_gcode"], [&print, &gcode_path]() { print.export_gcode(gcode_path.string(), nullptr, nullptr); });
+        Profiler::enable(false);
+        for (const Profiler::ZoneStats &zone : Profiler::summary())
+            zones[zone.name].emplace_back(double(zone.total_ns) * 1e-6);
+        // Same export with the islands of the extrusions looked up by the serial generator stage,
+        // to measure the gain of GCode::collect_layer_islands().
+        measure(stages["export_gcode_serial_islands"], [&print]() {
+            const std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("bench-%%%%-%%%%.gcode")).string();
+            GCode gcodegen;
+            gcodegen.set_collect_layer_islands(false);
+            const Vec3d origin = print.get_plate_origin();
+            gcodegen.set_gcode_offset(origin(0), origin(1));
+            gcodegen.do_export(&print, path.c_str());
+            boost::filesystem::remove(path);
+        });
+
+        measure(stages["process_file"], [&print, &gcode_path]() {
+            GCodeProcessor processor;
+            processor.apply_config(print.config());
+            processor.process_file(gcode_path.string());
+        });
+        // The G-codes of the bench cases are shorter than a default block of the G1 times, compare the peak memory
+        // with the G1 times spilled in small blocks against the one with all of them kept in memory.
+        measure(stages["process_file_spilled"], [&print, &gcode_path]() {
+            GCodeProcessor processor;
+            processor.apply_config(print.config());
+            processor.set_g1_times_block_size(1 << 14);
+            processor.process_file(gcode_path.string());
+        });
+        measure(stages["process_file_in_memory"], [&print, &gcode_path]() {
+            GCodeProcessor processor;
+            processor.apply_config(print.config());
+            processor.set_g1_times_block_size(std::numeric_limits<size_t>::max());
+            processor.process_file(gcode_path.string());
+        });
+
+        if (bench_case.project_io) {
+            // Same as the sliced project export of the GUI, dominated by the compression of the G-code.
+            const std::string project_path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("bench-%%%%-%%%%.gcode.3mf")).string();
+            measure(stages["store_gcode_3mf"], [&]() {
+                PlateData plate_data;
+                plate_data.plate_index     = 0;
+                plate_data.gcode_file      = gcode_path.string();
+                plate_data.is_sliced_valid = true;
+                StoreParams store_params;
+                store_params.path            = project_path.c_str();
+                store_params.model           = &model;
+                store_params.config          = &config;
+                store_params.plate_data_list = { &plate_data };
+                store_params.strategy        = SaveStrategy::Silence | SaveStrategy::SplitModel | SaveStrategy::WithGcode | SaveStrategy::Zip64;
+                if (! store_bbs_3mf(store_params))
+                    throw Slic3r::RuntimeError("Failed to store " + project_path);
+            });
+            boost::filesystem::remove(project_path);
+        }
+
+        const std::vector<GCodeMove> moves = read_moves(gcode_path.string());
+        num_moves = moves.size();
+        measure(stages["format_moves"], [&moves, &moves_size]() {
+            moves_size[0] = 0;
+            for (const GCodeMove &move : moves) {
+                GCodeG1Formatter w;
+                w.emit_xyz(move.pos);
+                w.emit_e(move.e);
+                moves_size[0] += w.string().size();
+            }
+        });
+        measure(stages["format_moves_to_chars"], [&moves, &moves_size]() {
+            moves_size[1] = 0;
+            for (const GCodeMove &move : moves) {
+                GCodeG1FormatterReference w;
+                w.emit_xyz(move.pos);
+                w.emit_e(move.e);
+                moves_size[1] += w.string().size();
+            }
+        });
+        measure(stages["format_moves_printf"], [&moves, &moves_size]() {
+            moves_size[2] = 0;
+            char buf[256];
+            for (const GCodeMove &move : moves) {
+                int len = ::snprintf(buf, sizeof(buf), "G1 X%.3f Y%.3f Z%.3f E%.5f\n", move.pos.x(), move.pos.y(), move.pos.z(), move.e);
+                moves_size[2] += std::string(buf, len).size();
+            }
+        });
+        moves_mismatches = 0;
+        for (const GCodeMove &move : moves) {
+            GCodeG1Formatter          w;
+            GCodeG1FormatterReference r;
+            w.emit_xyz(move.pos);
+            w.emit_e(move.e);
+            r.emit_xyz(move.pos);
+            r.emit_e(move.e);
+            if (w.string() != r.string())
+                ++ moves_mismatches;
+        }
+
+        num_layers = 0;
+        for (const PrintObject *po : print.objects())
+            num_layers += po->layer_count();
+        gcode_size = boost::filesystem::file_size(gcode_path);
+        boost::filesystem::remove(gcode_path);
+
+        // Release the layers with their extrusion entities, as done when the slicing step is invalidated.
+        measure(stages["clear_layers"], [&print]() {
+            for (PrintObject *po : print.objects_mutable()) {
+                po->clear_support_layers();
+                po->clear_layers();
+            }
+        });
+    }
+
+    nlohmann::json out;
+    out["name"]        = bench_case.name;
+    out["description"] = bench_case.description;
+    out["triangles"]   = num_triangles;
+    out["layers"]      = num_layers;
+    out["gcode_bytes"] = gcode_size;
+    out["moves"]       = num_moves;
+    out["moves_bytes"] = { moves_size[0], moves_size[1], moves_size[2] };
+    out["moves_formatted_differently"] = moves_mismatches;
+    for (const auto &[name, stage] : stages)
+        out["stages"][name] = to_json(stage);
+    for (const auto &[name, totals] : zones) {
+        out["zones"][name]["total_ms_median"] = median(totals);
+        out["zones"][name]["total_ms"]        = totals;
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (! parse_options(argc, argv, options))
+        return EXIT_FAILURE;
+
+    if (options.list) {
+        for (const BenchCase &bench_case : bench_cases())
+            std::cout << std::left << std::setw(20) << bench_case.name << bench_case.description << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+    std::unique_ptr<tbb::global_control> thread_limit;
+    if (options.threads > 0)
+        thread_limit = std::make_unique<tbb::global_control>(tbb::global_control::max_allowed_parallelism, options.threads);
+    if (options.clipper2 && ! ClipperUtils::set_backend(ClipperUtils::Backend::Clipper2)) {
+        std::cerr << "The ClipperUtils backend has already been fixed, --clipper2 can not be applied" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    nlohmann::json results;
+    results["version"] = SLIC3R_VERSION;
+    results["threads"] = tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism);
+    results["repeat"]  = options.repeat;
+    results["clipper"] = ClipperUtils::backend() == ClipperUtils::Backend::Clipper2 ? "clipper2" : "clipper";
+    results["peak_rss_per_stage"] = Bench::reset_peak_rss();
+    results["cases"]   = nlohmann::json::array();
+
+    for (const BenchCase &bench_case : bench_cases()) {
+        if (! options.filter.empty() && bench_case.name.find(options.filter) == std::string::npos)
+            continue;
+        std::cout << bench_case.name << std::endl;
+        nlohmann::json result = run_case(bench_case, options.repeat);
+        for (const char *stage : { "setup", "store_3mf", "load_3mf", "process", "export_gcode", "export_gcode_serial_islands", "process_file", "process_file_spilled", "process_file_in_memory", "format_moves", "format_moves_to_chars", "format_moves_printf", "store_gcode_3mf", "clear_layers" }) {
+            if (! result["stages"].contains(stage))
+                continue;
+            const nlohmann::json &s = result["stages"][stage];
+            std::cout << "    " << std::left << std::setw(28) << stage << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(10) << s["wall_ms_median"].get<double>() << " ms"
+                      << std::setw(12) << s["allocations"].get<uint64_t>() << " allocs"
+                      << std::setw(12) << s["frees"].get<uint64_t>() << " frees"
+                      << std::setw(10) << double(s["peak_rss_bytes"].get<size_t>()) / (1024. * 1024.) << " MB peak" << std::endl;
+        }
+        results["cases"].push_back(std::move(result));
+    }
+
+    if (! options.json_path.empty()) {
+        boost::nowide::ofstream out(options.json_path);
+        out << results.dump(2) << std::endl;
+        if (! out) {
+            std::cerr << "Failed to write " << options.json_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+
+#ifdef _WIN32
+    #include <Windows.h>
+    #include <psapi.h>
+#else
+    #include <stdlib.h>
+    #include <sys/resource.h>
+#endif
+
+namespace {
+    std::atomic<uint64_t> g_allocation_count { 0 };
+    std::atomic<uint64_t> g_allocation_bytes { 0 };
+    std::atomic<uint64_t> g_free_count       { 0 };
+
+    void* counted_malloc(std::size_t size)
+    {
+        g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+        g_allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void counted_free(void *ptr)
+    {
+        if (ptr != nullptr)
+            g_free_count.fetch_add(1, std::memory_order_relaxed);
+        std::free(ptr);
+    }
+
+    void* counted_aligned_malloc(std::size_t size, std::align_val_t alignment)
+    {
+        g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+        g_allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+        const std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+#ifdef _WIN32
+        return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+        void *ptr = nullptr;
+        return posix_memalign(&ptr, align, size == 0 ? 1 : size) == 0 ? ptr : nullptr;
+#endif
+    }
+
+    void counted_aligned_free(void *ptr)
+    {
+        if (ptr != nullptr)
+            g_free_count.fetch_add(1, std::memory_order_relaxed);
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+} // namespace
+
+// Replacements of the global allocation functions counting the allocations of the whole process,
+// including the aligned variants used by the over-aligned types (Eigen fixed size vectorizable types, TBB containers).
+void* operator new(std::size_t size)
+{
+    if (void *ptr = counted_malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size)
+{
+    if (void *ptr = counted_malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t &) noexcept { return counted_malloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t &) noexcept { return counted_malloc(size); }
+void  operator delete(void *ptr) noexcept { counted_free(ptr); }
+void  operator delete[](void *ptr) noexcept { counted_free(ptr); }
+void  operator delete(void *ptr, std::size_t) noexcept { counted_free(ptr); }
+void  operator delete[](void *ptr, std::size_t) noexcept { counted_free(ptr); }
+void  operator delete(void *ptr, const std::nothrow_t &) noexcept { counted_free(ptr); }
+void  operator delete[](void *ptr, const std::nothrow_t &) noexcept { counted_free(ptr); }
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void *ptr = counted_aligned_malloc(size, alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void *ptr = counted_aligned_malloc(size, alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return counted_aligned_malloc(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return counted_aligned_malloc(size, alignment); }
+void  operator delete(void *ptr, std::align_val_t) noexcept { counted_aligned_free(ptr); }
+void  operator delete[](void *ptr, std::align_val_t) noexcept { counted_aligned_free(ptr); }
+void  operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { counted_aligned_free(ptr); }
+void  operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { counted_aligned_free(ptr); }
+void  operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { counted_aligned_free(ptr); }
+void  operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { counted_aligned_free(ptr); }
+
+namespace Slic3r { namespace Bench {
+
+AllocationCounters allocation_counters()
+{
+    return { g_allocation_count.load(std::memory_order_relaxed), g_allocation_bytes.load(std::memory_order_relaxed), g_free_count.load(std::memory_order_relaxed) };
+}
+
+bool reset_peak_rss()
+{
+#if defined(__linux__)
+    // Writing 5 to clear_refs resets VmHWM, supported since Linux 4.0.
+    // The write is buffered, flush it to get the result of the write to the kernel.
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return bool(clear_refs);
+#else
+    return false;
+#endif
+}
+
+size_t peak_rss()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return size_t(pmc.PeakWorkingSetSize);
+    return 0;
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);)
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return size_t(std::strtoull(line.c_str() + 6, nullptr, 10)) * 1024;
+    return 0;
+#else
+    // ru_maxrss is in bytes on macOS.
+    rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? size_t(usage.ru_maxrss) : 0;
+#endif
+}
+
+} } // namespace Slic3r::Bench
@@ -0,0 +1,114 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/BatchServer.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/Utils.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <boost/filesystem.hpp>
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+namespace {
+
+std::string read_file(const boost::filesystem::path &path)
+{
+    std::ifstream     file(path.string(), std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+} // namespace
+
+SCENARIO("Batch server job arguments", "[BatchServer]") {
+    GIVEN("A job with settings, overrides and an input") {
+        std::string              id;
+        std::vector<std::string> args;
+        bool run = BatchServer::job_arguments(
+            R"({"id": "job1", "input": "model.3mf", "plate": 2, "settings": ["machine.json", "process.json"], "overrides": {"layer_height": 0.1}, "output_dir": "out"})",
+            id, args);
+        THEN("The CLI arguments are built from the job") {
+            REQUIRE(run);
+            REQUIRE(id == "job1");
+            REQUIRE(args == std::vector<std::string>{ "--load-settings", "machine.json;process.json", "--layer_height", "0.1", "--outputdir", "out", "--slice", "2", "model.3mf" });
+        }
+    }
+    GIVEN("A quit command") {
+        std::string              id;
+        std::vector<std::string> args;
+        THEN("The server is asked to stop") {
+            REQUIRE(! BatchServer::job_arguments(R"({"command": "quit"})", id, args));
+        }
+    }
+}
+
+SCENARIO("Batch server runs the jobs one by one", "[BatchServer]") {
+    GIVEN("Two jobs slicing a cube with different layer heights") {
+        boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("batch_server_%%%%-%%%%");
+        boost::filesystem::create_directories(dir / "job1");
+        boost::filesystem::create_directories(dir / "job2");
+
+        // Stands in for the CLI, slices a cube with the overrides of the job and writes the G-code into its output directory.
+        size_t      num_runs = 0;
+        BatchServer server([&num_runs](const std::vector<std::string> &args) {
+            ++ num_runs;
+            std::vector<const char*> argv { "bambu-studio" };
+            for (const std::string &arg : args)
+                argv.emplace_back(arg.c_str());
+            DynamicPrintAndCLIConfig cli_config;
+            if (! cli_config.read_cli(int(argv.size()), argv.data(), nullptr))
+                return CLI_INVALID_PARAMS;
+            DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+            config.apply(cli_config, true);
+            std::ofstream out((boost::filesystem::path(cli_config.opt_string("outputdir")) / "plate_1.gcode").string(), std::ios::binary);
+            out << slice({ TestMesh::cube_20x20x20 }, config);
+            return CLI_SUCCESS;
+        });
+
+        std::stringstream in;
+        in << R"({"id": "job1", "overrides": {"layer_height": 0.2}, "output_dir": ")" << (dir / "job1").generic_string() << "\"}\n";
+        in << "\n";
+        in << R"({"id": "job2", "overrides": {"layer_height": 0.1}, "output_dir": ")" << (dir / "job2").generic_string() << "\"}\n";
+        in << R"({"command": "quit"})" << "\n";
+        in << R"({"id": "job3", "output_dir": "never run"})" << "\n";
+        std::stringstream out;
+        size_t num_jobs = server.run(in, out);
+
+        THEN("Both jobs are run and reported") {
+            REQUIRE(num_jobs == 2);
+            REQUIRE(num_runs == 2);
+            std::string report = out.str();
+            REQUIRE(report.find("batch_server: ready") != std::string::npos);
+            REQUIRE(report.find(R"("id":"job1")") != std::string::npos);
+            REQUIRE(report.find(R"("id":"job2")") != std::string::npos);
+            REQUIRE(report.find("job3") == std::string::npos);
+            REQUIRE(report.find(R"("return_code":0)") != std::string::npos);
+            REQUIRE(report.find(R"("return_code":0)", report.find(R"("id":"job2")")) != std::string::npos);
+        }
+        THEN("Each job wrote the G-code of its own overrides") {
+            std::string gcode1 = read_file(dir / "job1" / "plate_1.gcode");
+            std::string gcode2 = read_file(dir / "job2" / "plate_1.gcode");
+            REQUIRE(! gcode1.empty());
+            REQUIRE(! gcode2.empty());
+            REQUIRE(gcode1 == slice({ TestMesh::cube_20x20x20 }, { { "layer_height", 0.2 } }));
+            REQUIRE(gcode2 == slice({ TestMesh::cube_20x20x20 }, { { "layer_height", 0.1 } }));
+        }
+        THEN("An invalid job is reported and does not stop the server") {
+            std::stringstream in2("not a json\n{\"id\": \"job4\", \"output_dir\": \"" + (dir / "job1").generic_string() + "\"}\n");
+            std::stringstream out2;
+            REQUIRE(server.run(in2, out2) == 2);
+            std::string report = out2.str();
+            REQUIRE(report.find("\"return_code\":" + std::to_string(CLI_INVALID_PARAMS)) != std::string::npos);
+            REQUIRE(report.find(R"("id":"job4")") != std::string::npos);
+        }
+
+        boost::filesystem::remove_all(dir);
+    }
+}
@@ -5,6 +5,8 @@
 
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Fill/FillCache.hpp"
+#include "libslic3r/Fill/FillGyroid.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/Print.hpp"
@@ -190,6 +192,82 @@ TEST_CASE("Fill: Pattern Path Length", "[Fill]") {
     }
 }
 
+TEST_CASE("Fill: Gyroid waves are clipped in both orientations", "[Fill]") {
+    std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type("gyroid"));
+    filler->angle   = 0;
+    filler->spacing = 0.45;
+    FillParams fill_params;
+    fill_params.density           = 0.3f;
+    fill_params.anchor_length     = 0.f;
+    fill_params.anchor_length_max = 0.f;
+
+    Points square { Point::new_scale(0, 0), Point::new_scale(100, 0), Point::new_scale(100, 100), Point::new_scale(0, 100) };
+    Points hole   { Point::new_scale(25, 25), Point::new_scale(25, 75), Point::new_scale(75, 75), Point::new_scale(75, 25) };
+    ExPolygon expolygon(square, hole);
+    // Distance of the neighbour waves.
+    const double wave_distance = PI * scale_(filler->spacing) / (fill_params.density * FillGyroid::DensityAdjust);
+
+    // The gyroid waves run along the X or the Y axis depending on the layer height.
+    for (double z : { 0.2, 0.6, 1.0, 1.4, 1.8, 2.2, 2.6, 3.0 }) {
+        filler->z = z;
+        Surface   surface(stInternal, expolygon);
+        Polylines paths = filler->fill_surface(&surface, fill_params);
+        REQUIRE(! paths.empty());
+        // paths don't cross the hole
+        REQUIRE(diff_pl(paths, offset(expolygon, float(SCALED_EPSILON * 10))).empty());
+        // the whole surface is filled
+        double length = std::accumulate(paths.begin(), paths.end(), 0., [](double acc, const Polyline &pl) { return acc + pl.length(); });
+        REQUIRE(length > expolygon.area() / wave_distance);
+        REQUIRE(length < 2. * expolygon.area() / wave_distance);
+    }
+}
+
+TEST_CASE("Fill: Rectilinear infill is shared by the layers with the same region", "[Fill]") {
+    FillCache fill_cache;
+    std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type(ipRectilinear));
+    filler->angle      = float(PI / 4.);
+    filler->fill_cache = &fill_cache;
+    filler->set_bounding_box(BoundingBox(Point::new_scale(0, 0), Point::new_scale(100, 100)));
+    FillParams fill_params;
+    fill_params.density = 0.2f;
+
+    Points square { Point::new_scale(0, 0), Point::new_scale(100, 0), Point::new_scale(100, 100), Point::new_scale(0, 100) };
+    Points hole   { Point::new_scale(25, 25), Point::new_scale(25, 75), Point::new_scale(75, 75), Point::new_scale(75, 25) };
+    Surface surface(stInternal, ExPolygon(square, hole));
+
+    auto fill_layer = [&](size_t layer_id) {
+        filler->layer_id = layer_id;
+        filler->spacing  = 0.45;
+        ExtrusionEntitiesPtr out;
+        filler->fill_surface_extrusion(&surface, fill_params, out);
+        REQUIRE(out.size() == 1);
+        Polylines polylines;
+        for (const ExtrusionEntity *ee : static_cast<const ExtrusionEntityCollection*>(out.front())->entities)
+            polylines.emplace_back(static_cast<const ExtrusionPath*>(ee)->polyline);
+        for (ExtrusionEntity *ee : out)
+            delete ee;
+        return polylines;
+    };
+
+    Polylines layer0 = fill_layer(0);
+    Polylines layer1 = fill_layer(1);
+    Polylines layer2 = fill_layer(2);
+    // Odd layers are filled in the other direction.
+    REQUIRE(fill_cache.lookups() == 3);
+    REQUIRE(fill_cache.hits() == 1);
+    REQUIRE(layer0 == layer2);
+    REQUIRE(layer0 != layer1);
+
+    filler->fill_cache = nullptr;
+    REQUIRE(fill_layer(4) == layer0);
+
+    // A different region is not taken from the cache.
+    filler->fill_cache = &fill_cache;
+    surface.expolygon.holes.front().translate(Point::new_scale(1, 0));
+    fill_layer(6);
+    REQUIRE(fill_cache.hits() == 1);
+}
+
 /*
 {
     my $collection = Slic3r::Polyline::Collection->new(
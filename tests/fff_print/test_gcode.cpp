@@ -1,8 +1,12 @@
 #include <catch2/catch.hpp>
 
+#include <cstdio>
 #include <memory>
 
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/GCodeEditor.hpp"
+#include "libslic3r/GCode/SpiralVase.hpp"
+#include "libslic3r/LocalesUtils.hpp"
 
 using namespace Slic3r;
 
@@ -20,3 +24,199 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+namespace {
+
+// One loop of a spiral vase layer, shifted in X from layer to layer to exercise the smoothing with the previous layer.
+std::string spiral_vase_layer(float z, float dx, bool retract)
+{
+    char buf[512];
+    sprintf(buf,
+        "G1 Z%.3f F600\n"
+        "G1 X%.1f Y10 F9000\n"
+        "; FEATURE: Outer wall\n"
+        "G1 X%.1f Y10.5 E0.83 F1800\n"
+        "G1 X%.1f Y30 E0.81\n"
+        "G1 X%.1f Y30 E0.84\n"
+        "G1 X%.1f Y10 E0.8\n"
+        "%s",
+        z, 10.f + dx, 30.f + dx, 30.2f + dx, 10.f + dx, 10.f + dx, retract ? "G1 E-0.8 F1800\nG1 X12 Y12 F9000\n" : "");
+    return buf;
+}
+
+} // namespace
+
+// The expected G-code was produced by SpiralVase before it was changed to tokenize each layer once.
+TEST_CASE("SpiralVase: layer output", "[GCode]") {
+    CNumericLocalesSetter locales_setter;
+
+    PrintConfig config;
+    config.use_relative_e_distances.value = true;
+    auto process = [&config](bool smooth) {
+        config.spiral_mode_smooth.value = smooth;
+        SpiralVase spiral_vase(config);
+        spiral_vase.set_max_xy_smoothing(1.f);
+        std::vector<std::string> out;
+        // Non spiral bottom layer, transition layer, two spiral layers and the last layer ramping the extrusion down.
+        for (int i = 0; i < 5; ++ i) {
+            spiral_vase.enable(i > 0);
+            out.emplace_back(spiral_vase.process_layer(spiral_vase_layer(0.2f * (i + 1), 0.2f * i, i == 0), i == 4));
+        }
+        return out;
+    };
+
+    const std::string bottom_layer = spiral_vase_layer(0.2f, 0.f, true);
+    const std::string transition_layer =
+        "G1 Z0.200 F600\n"
+        "; FEATURE: Outer wall\n"
+        "G1 Z0.250 X30.2 Y10.5 E0.20833 F1800\n"
+        "G1 Z0.299 X30.4 Y30 E0.40148\n"
+        "G1 Z0.350 X10.2 Y30 E0.62923\n"
+        "G1 Z0.400 X10.2 Y10 E0.80000\n";
+    const std::string ramp_down =
+        "; FEATURE: Outer wall\n"
+        "G1 X30.8 Y10.5 E0.62167 F1800\n"
+        "G1 X31.0 Y30 E0.40852\n"
+        "G1 X10.8 Y30 E0.21077\n"
+        "G1 X10.8 Y10 E0.00000\n";
+
+    SECTION("Spiral vase") {
+        std::vector<std::string> out = process(false);
+        REQUIRE(out.size() == 5);
+        REQUIRE(out[0] == bottom_layer);
+        REQUIRE(out[1] == transition_layer);
+        REQUIRE(out[2] ==
+            "G1 Z0.400 F600\n"
+            "; FEATURE: Outer wall\n"
+            "G1 Z0.450 X30.4 Y10.5 E0.83 F1800\n"
+            "G1 Z0.499 X30.6 Y30 E0.81\n"
+            "G1 Z0.550 X10.4 Y30 E0.84\n"
+            "G1 Z0.600 X10.4 Y10 E0.8\n");
+        REQUIRE(out[3] ==
+            "G1 Z0.600 F600\n"
+            "; FEATURE: Outer wall\n"
+            "G1 Z0.650 X30.6 Y10.5 E0.83 F1800\n"
+            "G1 Z0.699 X30.8 Y30 E0.81\n"
+            "G1 Z0.750 X10.6 Y30 E0.84\n"
+            "G1 Z0.800 X10.6 Y10 E0.8\n");
+        REQUIRE(out[4] ==
+            "G1 Z0.800 F600\n"
+            "; FEATURE: Outer wall\n"
+            "G1 Z0.850 X30.8 Y10.5 E0.83 F1800\n"
+            "G1 Z0.899 X31.0 Y30 E0.81\n"
+            "G1 Z0.950 X10.8 Y30 E0.84\n"
+            "G1 Z1.000 X10.8 Y10 E0.8\n" + ramp_down);
+    }
+    SECTION("Smooth spiral vase") {
+        std::vector<std::string> out = process(true);
+        REQUIRE(out.size() == 5);
+        REQUIRE(out[0] == bottom_layer);
+        REQUIRE(out[1] == transition_layer);
+        REQUIRE(out[2] ==
+            "G1 Z0.400 F600\n"
+            "; FEATURE: Outer wall\n"
+            "G1 Z0.450 X30.250 Y10.502 E0.83208 F1800\n"
+            "G1 Z0.499 X30.499 Y30.000 E0.80996\n"
+            "G1 Z0.550 X10.400 Y30.000 E0.83581\n"
+            "G1 Z0.600 X10.400 Y10.000 E0.80000\n");
+        REQUIRE(out[3] ==
+            "G1 Z0.600 F600\n"
+            "; FEATURE: Outer wall\n"
+            "G1 Z0.650 X30.450 Y10.502 E0.83208 F1800\n"
+            "G1 Z0.699 X30.699 Y30.000 E0.80996\n"
+            "G1 Z0.750 X10.600 Y30.000 E0.83581\n"
+            "G1 Z0.800 X10.600 Y10.000 E0.80000\n");
+        REQUIRE(out[4] ==
+            "G1 Z0.800 F600\n"
+            "; FEATURE: Outer wall\n"
+            "G1 Z0.850 X30.650 Y10.502 E0.83208 F1800\n"
+            "G1 Z0.899 X30.899 Y30.000 E0.80996\n"
+            "G1 Z0.950 X10.800 Y30.000 E0.83581\n"
+            "G1 Z1.000 X10.800 Y10.000 E0.80000\n" + ramp_down);
+    }
+}
+
+// The expected lines were produced by GCodeEditor::parse_layer_gcode() before it was changed to tokenize the lines in place.
+TEST_CASE("GCodeEditor: parsed cooling lines of a layer", "[GCode]") {
+    CNumericLocalesSetter locales_setter;
+
+    Slic3r::GCode gcodegen;
+    gcodegen.writer().set_extruders({ 0 });
+    GCodeEditor editor(gcodegen);
+    const std::string layer =
+        "G1 Z0.4 F600\n"
+        "; OBJECT_ID: 3\n"
+        "M624 AQAAAAAAAAA=\n"
+        "; COOLING_NODE: 1\n"
+        "G1 X10 Y10 F9000\n"
+        "G1 F1800 ;_EXTRUDE_SET_SPEED ;_EXTERNAL_PERIMETER\n"
+        "G1 X30 Y10 E0.8\n"
+        "G1 X30 Y30 E0.8 ;_EXTERNAL_PERIMETER\n"
+        ";_EXTRUDE_END\n"
+        ";_OVERHANG_FAN_START\n"
+        "G1 F3000 ;_EXTRUDE_SET_SPEED\n"
+        "G2 X20 Y20 I-5 J-5 E0.5\n"
+        "G3 X25 Y25 I2.5 J2.5 E0.3 F2400\n"
+        ";_EXTRUDE_END\n"
+        ";_OVERHANG_FAN_END\n"
+        "G1 E-0.8 F1800 ;_WIPE\n"
+        "G92 E0\n"
+        "G4 S1.5\n"
+        "G4 P250\n"
+        "; Slow Down Start\n"
+        "G1 F1200 ;_EXTRUDE_SET_SPEED\n"
+        "G1 X40 Y40 E1.2\n"
+        "; Slow Down End\n"
+        ";_EXTRUDE_END\n"
+        "M625\n"
+        ";_FORCE_RESUME_FAN_SPEED\n"
+        "T0\n"
+        "G0 X0 Y0\n";
+    std::vector<PerExtruderAdjustments> adjustments;
+    REQUIRE(editor.process_layer(std::string(layer), 1, adjustments, { 3 }, true, false) == layer);
+    REQUIRE(adjustments.size() == 1);
+
+    struct Expected
+    {
+        size_t type, line_start, line_end;
+        float  length, feedrate, time, time_max;
+        bool   outwall_smooth_mark;
+        int    object_id, cooling_node_id;
+    };
+    const Expected expected[] = {
+        { 288,    0,   13, 0.4f,     10.f,  0.04f,      0.04f,      false, -1, -1 },
+        { 65536,  28,  46, 0.f,      0.f,   0.f,        0.f,        false, -1, -1 },
+        { 288,    64,  81, 14.1421f, 150.f, 0.0942809f, 0.0942809f, false, -1, -1 },
+        { 480,    81,  131, 40.f,    30.f,  1.33333f,   4.f,        true,   0,  1 },
+        { 2,      184, 198, 0.f,     0.f,   0.f,        0.f,        false, -1, -1 },
+        { 4,      198, 219, 0.f,     0.f,   0.f,        0.f,        false, -1, -1 },
+        { 352,    219, 248, 34.1216f, 50.f, 0.737968f,  3.41216f,   false, -1, -1 },
+        { 2,      304, 318, 0.f,     0.f,   0.f,        0.f,        false, -1, -1 },
+        { 8,      318, 337, 0.f,     0.f,   0.f,        0.f,        false, -1, -1 },
+        { 800,    337, 359, 0.8f,    30.f,  0.0266667f, 0.0266667f, false, -1, -1 },
+        { 2048,   359, 366, 0.f,     0.f,   0.f,        0.f,        false, -1, -1 },
+        { 1024,   366, 374, 0.f,     0.f,   1.5f,       1.5f,       false, -1, -1 },
+        { 1024,   374, 382, 0.f,     0.f,   0.f,        0.f,        false, -1, -1 },
+        { 288,    400, 429, 0.f,     20.f,  0.f,        0.f,        false, -1, -1 },
+        { 32,     429, 445, 21.2132f, 20.f, 1.06066f,   1.06066f,   false, -1, -1 },
+        { 2,      461, 475, 0.f,     0.f,   0.f,        0.f,        false, -1, -1 },
+        { 131072, 475, 480, 0.f,     0.f,   0.f,        0.f,        false, -1, -1 },
+        { 16384,  480, 505, 0.f,     0.f,   0.f,        0.f,        false, -1, -1 },
+        { 16,     508, 517, 56.5685f, 20.f, 2.82843f,   2.82843f,   false, -1, -1 },
+    };
+    const std::vector<CoolingLine> &lines = adjustments.front().lines;
+    REQUIRE(lines.size() == std::size(expected));
+    for (size_t i = 0; i < lines.size(); ++ i) {
+        INFO("Line " << i);
+        REQUIRE(lines[i].type == expected[i].type);
+        REQUIRE(lines[i].line_start == expected[i].line_start);
+        REQUIRE(lines[i].line_end == expected[i].line_end);
+        REQUIRE(lines[i].length == Approx(expected[i].length).epsilon(1e-5));
+        REQUIRE(lines[i].feedrate == Approx(expected[i].feedrate).epsilon(1e-5));
+        REQUIRE(lines[i].time == Approx(expected[i].time).epsilon(1e-5));
+        REQUIRE(lines[i].time_max == Approx(expected[i].time_max).epsilon(1e-5));
+        REQUIRE(lines[i].outwall_smooth_mark == expected[i].outwall_smooth_mark);
+        REQUIRE(lines[i].object_id == expected[i].object_id);
+        REQUIRE(lines[i].cooling_node_id == expected[i].cooling_node_id);
+    }
+}
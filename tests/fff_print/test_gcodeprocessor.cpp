@@ -0,0 +1,231 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/LocalesUtils.hpp"
+#include "libslic3r/PrintConfig.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+using namespace Slic3r;
+
+TEST_CASE("GCodeProcessor: remaining time to a pause with the G1 times spilled to disk", "[GCodeProcessor]") {
+    CNumericLocalesSetter locales_setter;
+
+    // More G1 lines than two blocks of the G1 times cache, so that the first blocks are spilled to disk,
+    // with a pause shortly after the end of the second block: the remaining time to the pause is exported
+    // for the lines of the last minute before the pause, which look one line ahead across the blocks.
+    const size_t block_size   = 1000;
+    const size_t num_g1_lines = 2 * block_size + 2000;
+    const size_t pause_after  = 2 * block_size + 500;
+    std::string gcode = ";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::First_Line_M73_Placeholder) + "\nG1 F600\n";
+    for (size_t i = 0; i < num_g1_lines; ++ i) {
+        gcode += (i % 2 == 0) ? "G1 X10.1 Y10\n" : "G1 X10 Y10\n";
+        if (i == pause_after)
+            gcode += ";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Pause_Print) + "\n";
+    }
+    gcode += ";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Last_Line_M73_Placeholder) + "\n";
+
+    const std::string file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.gcode")).string();
+    {
+        boost::nowide::ofstream out(file, std::ios::binary);
+        out << gcode;
+    }
+
+    GCodeProcessor processor;
+    processor.apply_config(FullPrintConfig::defaults());
+    processor.set_g1_times_block_size(block_size);
+    processor.initialize(file);
+    processor.process_buffer(gcode);
+    REQUIRE(processor.g1_times_spilled_count() >= 2 * block_size);
+    processor.finalize(true);
+
+    std::string exported;
+    {
+        boost::nowide::ifstream   in(file, std::ios::binary);
+        std::stringstream         buffer;
+        buffer << in.rdbuf();
+        exported = buffer.str();
+    }
+    boost::filesystem::remove(file);
+
+    const size_t pause = exported.find(GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Pause_Print));
+    REQUIRE(pause != std::string::npos);
+    // The remaining time to the pause is counted down to zero right before it.
+    const size_t last_stop_line = exported.rfind("\nM73 C", pause);
+    REQUIRE(last_stop_line != std::string::npos);
+    REQUIRE(exported.compare(last_stop_line, 8, "\nM73 C0\n") == 0);
+    REQUIRE(exported.find("\nM73 C", pause) == std::string::npos);
+}
+
+TEST_CASE("GCodeProcessorResult::Moves: moves are decoded as stored", "[GCodeProcessor]") {
+    using MoveVertex = GCodeProcessorResult::MoveVertex;
+    const std::vector<Vec3f> arc_points { Vec3f(1.f, 0.f, 0.2f), Vec3f(0.f, 1.f, 0.2f) };
+
+    GCodeProcessorResult::Moves moves;
+    moves.emplace_back();
+    MoveVertex extrusion;
+    extrusion.type           = EMoveType::Extrude;
+    extrusion.extrusion_role = erExternalPerimeter;
+    extrusion.extruder_id    = 1;
+    extrusion.gcode_id       = 12;
+    extrusion.position       = Vec3f(10.f, 20.f, 0.2f);
+    extrusion.width          = 0.42f;
+    extrusion.height         = 0.2f;
+    extrusion.print_z        = 0.2f;
+    extrusion.temperature    = 220.f;
+    moves.push_back(extrusion);
+    MoveVertex arc           = extrusion;
+    arc.gcode_id             = 13;
+    arc.move_path_type       = EMovePathType::Arc_move_ccw;
+    arc.interpolation_points = GCodeProcessorResult::InterpolationPoints(arc_points);
+    moves.push_back(arc);
+
+    REQUIRE(moves.size() == 3);
+    const MoveVertex decoded = moves[1];
+    REQUIRE(decoded.type == EMoveType::Extrude);
+    REQUIRE(decoded.extrusion_role == erExternalPerimeter);
+    REQUIRE(decoded.extruder_id == 1);
+    REQUIRE(decoded.gcode_id == 12);
+    REQUIRE(decoded.position == extrusion.position);
+    // Width and height are stored as half floats.
+    REQUIRE(decoded.width == Approx(0.42f).epsilon(1e-3));
+    REQUIRE(decoded.height == Approx(0.2f).epsilon(1e-3));
+    REQUIRE(decoded.print_z == 0.2f);
+    REQUIRE(decoded.temperature == 220.f);
+    REQUIRE(decoded.interpolation_points.empty());
+
+    // The interpolation points are copied, not referenced.
+    REQUIRE(moves.is_arc_move_with_interpolation_points(2));
+    REQUIRE(moves.interpolation_points(2).size() == 2);
+    REQUIRE(moves.interpolation_points(2).begin() != arc_points.data());
+    REQUIRE(moves.interpolation_points(2)[1] == arc_points[1]);
+
+    // Moving a move to the back keeps its interpolation points and the order of the others.
+    moves.push_back(moves[2]);
+    moves.erase(2);
+    REQUIRE(moves.size() == 3);
+    REQUIRE(moves.gcode_id(1) == 12);
+    REQUIRE(moves.gcode_id(2) == 13);
+    REQUIRE(moves.interpolation_points(2)[0] == arc_points[0]);
+
+    moves.set_time(2, 0, 5.f);
+    moves.set_width_height(1, 1.f, 0.5f);
+    REQUIRE(moves.back().time[0] == 5.f);
+    REQUIRE(moves[1].width == 1.f);
+    REQUIRE(moves[1].height == 0.5f);
+}
+
+TEST_CASE("GCodeProcessorResult::Moves: push_back, operator[] and erase round trip over all the move types", "[GCodeProcessor]") {
+    using MoveVertex = GCodeProcessorResult::MoveVertex;
+    std::vector<Vec3f> arc_points;
+    for (int i = 0; i < 12; ++ i)
+        arc_points.emplace_back(float(i), float(2 * i), 0.2f);
+
+    // Two moves of each type. The state changes every third move, so that some states are shared by a run of moves
+    // and others are not, and every other extrusion is an arc with its own interpolation points.
+    std::vector<MoveVertex> expected;
+    for (int i = 0; i < 2 * int(EMoveType::Count); ++ i) {
+        MoveVertex move;
+        move.type            = EMoveType(i % int(EMoveType::Count));
+        move.extrusion_role  = ExtrusionRole(i % int(erCount));
+        move.extruder_id     = (unsigned char)(i % 4);
+        move.cp_color_id     = (unsigned char)(i % 3);
+        move.gcode_id        = 100 + i;
+        move.delta_extruder  = 0.01f * float(i);
+        move.feedrate        = 10.f + float(i);
+        // Exactly representable as half floats.
+        move.width           = 0.25f + 0.125f * float(i % 4);
+        move.height          = 0.125f * float(1 + i % 2);
+        move.mm3_per_mm      = 0.05f * float(i);
+        move.time            = { float(i), 2.f * float(i) };
+        move.position        = Vec3f(float(i), float(-i), 0.2f * float(1 + i / 3));
+        move.print_z         = 0.2f * float(1 + i / 3);
+        move.layer_duration  = float(i / 3);
+        move.temperature     = 200.f + float(i / 3);
+        move.fan_speed       = float(10 * (i / 3));
+        move.object_label_id = i / 6;
+        if (move.type == EMoveType::Extrude && i % 4 < 2) {
+            move.move_path_type       = (i % 2 == 0) ? EMovePathType::Arc_move_cw : EMovePathType::Arc_move_ccw;
+            move.interpolation_points = GCodeProcessorResult::InterpolationPoints(arc_points.data() + i % 8, 1 + i % 5);
+        } else
+            move.move_path_type = EMovePathType::Linear_move;
+        expected.emplace_back(move);
+    }
+
+    GCodeProcessorResult::Moves moves;
+    for (const MoveVertex &move : expected)
+        moves.push_back(move);
+
+    auto check = [&moves, &expected]() {
+        REQUIRE(moves.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++ i) {
+            const MoveVertex &e = expected[i];
+            const MoveVertex  m = moves[i];
+            REQUIRE(m.type == e.type);
+            REQUIRE(m.extrusion_role == e.extrusion_role);
+            REQUIRE(m.move_path_type == e.move_path_type);
+            REQUIRE(m.extruder_id == e.extruder_id);
+            REQUIRE(m.cp_color_id == e.cp_color_id);
+            REQUIRE(m.gcode_id == e.gcode_id);
+            REQUIRE(m.delta_extruder == e.delta_extruder);
+            REQUIRE(m.feedrate == e.feedrate);
+            REQUIRE(m.width == e.width);
+            REQUIRE(m.height == e.height);
+            REQUIRE(m.mm3_per_mm == e.mm3_per_mm);
+            REQUIRE(m.time == e.time);
+            REQUIRE(m.position == e.position);
+            REQUIRE(m.print_z == e.print_z);
+            REQUIRE(m.layer_duration == e.layer_duration);
+            REQUIRE(m.temperature == e.temperature);
+            REQUIRE(m.fan_speed == e.fan_speed);
+            REQUIRE(m.object_label_id == e.object_label_id);
+            REQUIRE(std::vector<Vec3f>(m.interpolation_points.begin(), m.interpolation_points.end()) ==
+                    std::vector<Vec3f>(e.interpolation_points.begin(), e.interpolation_points.end()));
+            // The column accessors agree with the decoded move.
+            REQUIRE(moves.type(i) == e.type);
+            REQUIRE(moves.extrusion_role(i) == e.extrusion_role);
+            REQUIRE(moves.extruder_id(i) == e.extruder_id);
+            REQUIRE(moves.gcode_id(i) == e.gcode_id);
+            REQUIRE(moves.position(i) == e.position);
+            REQUIRE(moves.width(i) == e.width);
+            REQUIRE(moves.height(i) == e.height);
+            REQUIRE(moves.volumetric_rate(i) == e.volumetric_rate());
+            REQUIRE(moves.time(i) == e.time);
+            REQUIRE(moves.print_z(i) == e.print_z);
+            REQUIRE(moves.object_label_id(i) == e.object_label_id);
+            REQUIRE(moves.is_arc_move_with_interpolation_points(i) == e.is_arc_move_with_interpolation_points());
+            REQUIRE(moves.interpolation_points(i).size() == e.interpolation_points.size());
+        }
+    };
+    check();
+
+    // Move an arc to the back, sharing its interpolation points, then erase the original.
+    const size_t arc = std::find_if(expected.begin(), expected.end(), [](const MoveVertex &m) { return m.is_arc_move_with_interpolation_points(); }) - expected.begin();
+    REQUIRE(arc < expected.size());
+    moves.push_back(moves[arc]);
+    expected.emplace_back(expected[arc]);
+    moves.erase(arc);
+    expected.erase(expected.begin() + arc);
+    check();
+
+    // Erase from the front, the middle and the back, releasing both shared and unshared states and arcs.
+    for (size_t idx : { size_t(0), size_t(5), size_t(18), size_t(3), size_t(7) }) {
+        moves.erase(idx);
+        expected.erase(expected.begin() + idx);
+        check();
+    }
+    while (! expected.empty()) {
+        const size_t idx = expected.size() / 2;
+        moves.erase(idx);
+        expected.erase(expected.begin() + idx);
+        check();
+    }
+
+    // Nothing is left of the states, arcs and interpolation points of the erased moves.
+    moves.shrink_to_fit();
+    REQUIRE(moves.memsize() == 0);
+}
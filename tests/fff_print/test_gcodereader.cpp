@@ -0,0 +1,199 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/LocalesUtils.hpp"
+#include "libslic3r/Timer.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+namespace {
+
+struct ParsedLine
+{
+    std::string raw;
+    float       x, y, z, e;
+    uint32_t    axes;
+};
+
+std::vector<ParsedLine> parse(const std::string &file, bool parallel, std::vector<size_t> &lines_ends, size_t quit_after = 0)
+{
+    std::vector<ParsedLine> out;
+    GCodeReader reader;
+    const std::thread::id calling_thread = std::this_thread::get_id();
+    bool                  on_calling_thread = true;
+    auto callback = [&out, quit_after, calling_thread, &on_calling_thread](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+        on_calling_thread &= std::this_thread::get_id() == calling_thread;
+        uint32_t axes = 0;
+        for (int axis = 0; axis < int(NUM_AXES); ++ axis)
+            if (line.has(Axis(axis)))
+                axes |= 1 << axis;
+        out.push_back({ line.raw(), reader.x(), reader.y(), reader.z(), reader.e(), axes });
+        if (out.size() == quit_after)
+            reader.quit_parsing();
+    };
+    if (parallel)
+        reader.parse_file_parallel(file, callback, lines_ends);
+    else
+        reader.parse_file(file, callback, lines_ends);
+    // The callback updates the state of the caller, it runs under its locale and it may throw to cancel.
+    REQUIRE(on_calling_thread);
+    return out;
+}
+
+void check_same_result(const std::string &file, size_t quit_after = 0)
+{
+    std::vector<size_t> lines_ends, lines_ends_parallel;
+    std::vector<ParsedLine> lines          = parse(file, false, lines_ends, quit_after);
+    std::vector<ParsedLine> lines_parallel = parse(file, true, lines_ends_parallel, quit_after);
+    REQUIRE(lines.size() == lines_parallel.size());
+    for (size_t i = 0; i < lines.size(); ++ i) {
+        REQUIRE(lines[i].raw == lines_parallel[i].raw);
+        REQUIRE(lines[i].axes == lines_parallel[i].axes);
+        REQUIRE(lines[i].x == lines_parallel[i].x);
+        REQUIRE(lines[i].y == lines_parallel[i].y);
+        REQUIRE(lines[i].z == lines_parallel[i].z);
+        REQUIRE(lines[i].e == lines_parallel[i].e);
+    }
+    if (quit_after == 0)
+        REQUIRE(lines_ends == lines_ends_parallel);
+}
+
+std::string write_temp_file(const std::string &content)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.gcode");
+    boost::nowide::ofstream out(path.string(), std::ios::binary);
+    out << content;
+    return path.string();
+}
+
+// G-code spanning several chunks of GCodeReader::parse_file_parallel(), with a line crossing the end of the first chunk,
+// the "\r\n" of a line split between the second and the third chunk and a last line without its end of line.
+std::string multi_chunk_gcode()
+{
+    const size_t chunk_size = GCodeReader::parallel_chunk_size;
+    std::string  gcode;
+    gcode.reserve(3 * chunk_size);
+    size_t line_idx = 0;
+    auto fill_up_to = [&gcode, &line_idx](size_t size) {
+        for (; gcode.size() + 64 < size; ++ line_idx) {
+            gcode += (line_idx % 50 == 0) ? "G92 E0\n" : (line_idx % 7 == 0) ? "; comment\r\n" : "";
+            gcode += "G1 X" + std::to_string(line_idx % 200) + "." + std::to_string(line_idx % 1000) + " Y" + std::to_string(line_idx % 150) +
+                " E" + std::to_string(line_idx % 50) + ".0" + std::to_string(line_idx % 97) + ((line_idx % 3 == 0) ? " F1800\n" : "\n");
+        }
+    };
+
+    fill_up_to(chunk_size);
+    REQUIRE(gcode.size() < chunk_size);
+    gcode += "G1 X1.5 Y2.5 E0.1 ;" + std::string(chunk_size + 16 - gcode.size(), 'c') + "\n";
+    const size_t second_chunk_begin = gcode.size();
+    fill_up_to(second_chunk_begin + chunk_size);
+    // The '\r' is the last character of the second chunk, the '\n' the first one of the third chunk.
+    gcode += ";" + std::string(second_chunk_begin + chunk_size - 2 - gcode.size(), 'x') + "\r\n";
+    REQUIRE(gcode[second_chunk_begin + chunk_size - 1] == '\r');
+    fill_up_to(gcode.size() + chunk_size / 2);
+    gcode += "G1 X3 Y3 E1";
+    return gcode;
+}
+
+} // namespace
+
+TEST_CASE("GCodeReader: parallel parsing matches sequential parsing", "[GCodeReader]") {
+    CNumericLocalesSetter locales_setter;
+
+    SECTION("Hand written G-code") {
+        const char *gcodes[] = {
+            "",
+            "G1 X10 Y20\n",
+            "G1 X10 Y20",
+            "; comment\r\nN10 G1 X1.5 Y2.5 E0.1 ; move\r\n\r\nG92 E0\nG1 Z0.2 F3000\n\n",
+            "G28\nM104 S200\nG1 X5 Y5 E1 Q7\nG2 X10 Y10 I2.5 J2.5 E2\nG1 E-0.8 F1800",
+        };
+        for (const char *gcode : gcodes) {
+            std::string file = write_temp_file(gcode);
+            check_same_result(file);
+            boost::filesystem::remove(file);
+        }
+    }
+
+    SECTION("Sliced G-code") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, { { "layer_height", 0.2 } });
+        std::string file = write_temp_file(Slic3r::Test::gcode(print));
+        check_same_result(file);
+        // Stop from the callback in the middle of the file.
+        check_same_result(file, 1000);
+        boost::filesystem::remove(file);
+    }
+
+    SECTION("G-code of several chunks") {
+        std::string file = write_temp_file(multi_chunk_gcode());
+        check_same_result(file);
+        // Stop in the middle of the second chunk.
+        check_same_result(file, 200000);
+        boost::filesystem::remove(file);
+    }
+}
+
+TEST_CASE("GCodeReader: exception thrown by the callback of the parallel parsing", "[GCodeReader]") {
+    CNumericLocalesSetter locales_setter;
+
+    std::string         file = write_temp_file(multi_chunk_gcode());
+    std::vector<size_t> lines_ends;
+    GCodeReader         reader;
+    size_t              lines = 0;
+    REQUIRE_THROWS_AS(reader.parse_file_parallel(file, [&lines](GCodeReader &, const GCodeReader::GCodeLine &) {
+        if (++ lines == 200000)
+            throw std::runtime_error("canceled");
+    }, lines_ends), std::runtime_error);
+    REQUIRE(lines == 200000);
+    // The reader may be used again.
+    check_same_result(file);
+    boost::filesystem::remove(file);
+}
+
+// Not run by default, invoke with "[Benchmark]". Set SLIC3R_GCODE_BENCHMARK_FILE to measure on an existing G-code file,
+// otherwise a large G-code is generated by slicing the test meshes with thin layers.
+TEST_CASE("GCodeReader: sequential / parallel parsing benchmark", "[.][Benchmark]") {
+    CNumericLocalesSetter locales_setter;
+
+    std::string file;
+    bool        temporary = false;
+    if (const char *env = std::getenv("SLIC3R_GCODE_BENCHMARK_FILE"))
+        file = env;
+    else {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::sphere_50mm, TestMesh::ipadstand}, print, model, { { "layer_height", 0.08 }, { "fill_density", 0.3 } });
+        file      = write_temp_file(Slic3r::Test::gcode(print));
+        temporary = true;
+    }
+
+    for (bool parallel : { false, true }) {
+        size_t              lines = 0;
+        std::vector<size_t> lines_ends;
+        GCodeReader         reader;
+        Timing::Timer       timer;
+        timer.start();
+        auto callback = [&lines](GCodeReader &, const GCodeReader::GCodeLine &) { ++ lines; };
+        if (parallel)
+            reader.parse_file_parallel(file, callback, lines_ends);
+        else
+            reader.parse_file(file, callback, lines_ends);
+        std::cout << (parallel ? "parallel  " : "sequential") << ": " << lines << " lines, " << boost::filesystem::file_size(file) << " bytes, "
+                  << timer.elapsed_seconds() << "s" << std::endl;
+    }
+    if (temporary)
+        boost::filesystem::remove(file);
+}
@@ -1,9 +1,12 @@
 #include <catch2/catch.hpp>
 
 #include <memory>
+#include <random>
 
 #include "libslic3r/GCodeWriter.hpp"
 
+#include "gcode_formatter_reference.hpp"
+
 using namespace Slic3r;
 
 SCENARIO("lift() is not ignored after unlift() at normal values of Z", "[GCodeWriter]") {
@@ -94,3 +97,68 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+SCENARIO("GCodeG1Formatter emits the shortest fixed-point representation of the rounded values.", "[GCodeWriter]") {
+    auto emit = [](const Vec3d &point, double e) {
+        GCodeG1Formatter w;
+        w.emit_xyz(point);
+        w.emit_e(e);
+        return w.string();
+    };
+    GIVEN("Values with and without an integer part") {
+        THEN("Leading zeros of the fraction and trailing zeros are omitted") {
+            REQUIRE_THAT(emit(Vec3d(0.5, -0.001, 12.3), 2.), Catch::Equals("G1 X.5 Y-.001 Z12.3 E2\n"));
+            REQUIRE_THAT(emit(Vec3d(-1., 100., 0.), -0.00001), Catch::Equals("G1 X-1 Y100 Z0 E-.00001\n"));
+        }
+        THEN("Values rounding to zero are emitted as 0 without a sign") {
+            REQUIRE_THAT(emit(Vec3d(0.0004, -0.0004, -0.), -0.000004), Catch::Equals("G1 X0 Y0 Z0 E0\n"));
+        }
+    }
+    GIVEN("Random values") {
+        THEN("The value parsed back matches the value rounded by printf") {
+            std::mt19937 rng(12345);
+            std::uniform_real_distribution<double> dist(-2000., 2000.);
+            for (size_t i = 0; i < 10000; ++ i) {
+                const double v = i % 2 ? dist(rng) : dist(rng) * 1e-3;
+                GCodeG1Formatter w;
+                w.emit_f(v);
+                w.emit_e(v);
+                const std::string out = w.string();
+                const size_t      e   = out.find(" E");
+                char buf[64];
+                sprintf(buf, "%.3lf", v);
+                REQUIRE(std::abs(atof(out.substr(4, e - 4).c_str()) - atof(buf)) < 1.00001e-3);
+                sprintf(buf, "%.5lf", v);
+                REQUIRE(std::abs(atof(out.substr(e + 2).c_str()) - atof(buf)) < 1.00001e-5);
+            }
+        }
+    }
+}
+
+SCENARIO("GCodeG1Formatter emits the same text as the std::to_chars() based formatter it replaced.", "[GCodeWriter]") {
+    auto emit = [](auto &&w, double v) {
+        w.emit_f(v);
+        w.emit_e(v);
+        return w.string();
+    };
+    GIVEN("Values at the boundaries of the rounding") {
+        THEN("The outputs are equal") {
+            for (double v : { 0., -0., 0.0005, -0.0005, 0.000005, -0.000005, 0.0004999, 0.9995, -0.9995, 1., -1., 9.99999, 1e6, -1e6, 123456.789012 })
+                REQUIRE_THAT(emit(GCodeG1Formatter(), v), Catch::Equals(emit(Test::GCodeG1FormatterReference(), v)));
+        }
+    }
+    GIVEN("Random values of magnitudes from 1e-7 to 1e6") {
+        THEN("The outputs are equal") {
+            std::mt19937 rng(54321);
+            std::uniform_real_distribution<double> mantissa(-10., 10.);
+            std::uniform_int_distribution<int>     exponent(-8, 5);
+            for (size_t i = 0; i < 1000000; ++ i) {
+                const double v = mantissa(rng) * std::pow(10., exponent(rng));
+                const std::string out = emit(GCodeG1Formatter(), v);
+                const std::string ref = emit(Test::GCodeG1FormatterReference(), v);
+                if (out != ref)
+                    REQUIRE_THAT(out, Catch::Equals(ref));
+            }
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/MultiMaterialSegmentation.hpp"
+#include "libslic3r/Print.hpp"
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+SCENARIO("MMU segmentation cache", "[MMUSegmentation]") {
+    GIVEN("A cube with half of its triangles painted with the second filament") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "filament_diameter", "1.75,1.75" },
+            { "filament_colour",   "#FF0000FF;#00FF00FF" }
+        });
+        Print print;
+        Model model;
+        init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+        ModelVolume *volume = model.objects.front()->volumes.front();
+        const int    facets_count = int(volume->mesh().facets_count());
+        for (int i = 0; i < facets_count; ++ i)
+            volume->mmu_segmentation_facets.set_triangle_from_string(i, (i < facets_count / 2) ? "8" : "4");
+        print.apply(model, config);
+        print.set_status_silent();
+        print.process();
+
+        const PrintObject &object = *print.objects().front();
+        REQUIRE(object.shared_regions() != nullptr);
+        // The cache is owned by the regions shared by the instances, swap it to compare against an uncached segmentation.
+        std::shared_ptr<MMUSegmentationCache> &cache = const_cast<PrintObjectRegions*>(object.shared_regions())->mmu_segmentation_cache;
+        REQUIRE(cache != nullptr);
+
+        WHEN("The object is segmented again without and with the cache") {
+            auto no_cancel = []() {};
+            std::shared_ptr<MMUSegmentationCache> cache_of_process = std::move(cache);
+            std::vector<std::vector<ExPolygons>> fresh = multi_material_segmentation_by_painting(object, no_cancel);
+            cache = std::make_shared<MMUSegmentationCache>();
+            std::vector<std::vector<ExPolygons>> cold = multi_material_segmentation_by_painting(object, no_cancel);
+            const size_t num_entries = cache->size();
+            std::vector<std::vector<ExPolygons>> hit = multi_material_segmentation_by_painting(object, no_cancel);
+            // a layer missing the cache would add a new entry
+            const size_t num_entries_after_hit = cache->size();
+            cache = std::move(cache_of_process);
+            THEN("The layers are cached by the first run and taken from the cache by the second one") {
+                REQUIRE(num_entries > 0);
+                REQUIRE(num_entries_after_hit == num_entries);
+            }
+            THEN("The regions taken from the cache are the same as the computed ones") {
+                REQUIRE(fresh.size() == object.layers().size());
+                bool painted = false;
+                for (const std::vector<ExPolygons> &layer : fresh)
+                    painted |= std::any_of(layer.begin() + 1, layer.end(), [](const ExPolygons &expolys) { return ! expolys.empty(); });
+                REQUIRE(painted);
+                REQUIRE(cold == fresh);
+                REQUIRE(hit == fresh);
+            }
+        }
+    }
+}
+
+SCENARIO("MMU segmentation cache with colliding hashes", "[MMUSegmentation]") {
+    GIVEN("A cached layer") {
+        MMUSegmentationCache cache;
+        cache.next_run();
+        MMUSegmentationCache::LayerInput input;
+        input.num_extruders = 2;
+        input.expolygons    = { ExPolygon(Polygon::new_scale({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } })) };
+        input.painted_lines = { { 0, 1, Line(Point::new_scale(10, 0), Point::new_scale(10, 10)), 1 } };
+        input.hash          = 42;
+        const std::vector<ExPolygons> regions { {}, input.expolygons };
+        cache.insert(MMUSegmentationCache::LayerInput(input), regions);
+
+        WHEN("A layer with the same hash and the same input is looked up") {
+            std::vector<ExPolygons> found;
+            THEN("Its regions are taken from the cache") {
+                REQUIRE(cache.find(input, found));
+                REQUIRE(found == regions);
+            }
+        }
+        WHEN("A layer with the same hash but another painted line is looked up") {
+            MMUSegmentationCache::LayerInput other = input;
+            other.painted_lines.front().color = 2;
+            std::vector<ExPolygons> found;
+            THEN("It misses the cache") {
+                REQUIRE(! cache.find(other, found));
+                REQUIRE(found.empty());
+            }
+        }
+        WHEN("A layer with the same hash but other expolygons is looked up") {
+            MMUSegmentationCache::LayerInput other = input;
+            other.expolygons.front().translate(Point::new_scale(1, 0));
+            std::vector<ExPolygons> found;
+            THEN("It misses the cache") {
+                REQUIRE(! cache.find(other, found));
+            }
+        }
+    }
+}
@@ -0,0 +1,270 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/PrintCache.hpp"
+#include "libslic3r/Timer.hpp"
+#include "libslic3r/Utils.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+namespace {
+
+struct LayerSummary
+{
+    size_t lslices;
+    double area;
+    size_t perimeters;
+    size_t fills;
+};
+
+std::vector<LayerSummary> summarize(const PrintObject &object)
+{
+    std::vector<LayerSummary> out;
+    for (const Layer *layer : object.layers()) {
+        LayerSummary summary { layer->lslices.size(), 0., 0, 0 };
+        for (const ExPolygon &expoly : layer->lslices)
+            summary.area += expoly.area();
+        for (const LayerRegion *layerm : layer->regions()) {
+            summary.perimeters += layerm->perimeters.items_count();
+            summary.fills      += layerm->fills.items_count();
+        }
+        out.push_back(summary);
+    }
+    return out;
+}
+
+// Offset table of a binary cache file of an object: the table is followed by the blobs, thus its first entry
+// is the end of the table and its last entry is the file size.
+struct CacheFile
+{
+    std::string           data;
+    size_t                table_pos { 0 };
+    std::vector<uint64_t> offsets;
+
+    CacheFile(const std::string &path, size_t num_offsets) {
+        boost::nowide::ifstream ifs(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        for (size_t pos = 0; pos + sizeof(uint64_t) <= data.size(); ++ pos)
+            if (get(pos) == data.size() && pos + sizeof(uint64_t) >= num_offsets * sizeof(uint64_t)) {
+                table_pos = pos + sizeof(uint64_t) - num_offsets * sizeof(uint64_t);
+                if (get(table_pos) == pos + sizeof(uint64_t))
+                    break;
+            }
+        for (size_t i = 0; i < num_offsets; ++ i)
+            offsets.push_back(get(table_pos + i * sizeof(uint64_t)));
+    }
+    uint64_t get(size_t pos) const { uint64_t v; ::memcpy(&v, data.data() + pos, sizeof(v)); return v; }
+    void     set(size_t pos, uint64_t v) { ::memcpy(data.data() + pos, &v, sizeof(v)); }
+    void     save(const std::string &path) const {
+        boost::nowide::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs.write(data.data(), data.size());
+    }
+};
+
+uintmax_t directory_size(const boost::filesystem::path &dir)
+{
+    uintmax_t size = 0;
+    for (const boost::filesystem::directory_entry &entry : boost::filesystem::directory_iterator(dir))
+        size += boost::filesystem::file_size(entry.path());
+    return size;
+}
+
+} // namespace
+
+SCENARIO("Print: binary slicing cache round trip", "[Print]") {
+    GIVEN("A sliced 20mm cube") {
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, { { "fill_density", 0.2 } });
+        const PrintObject &object = *print.objects().front();
+        std::vector<LayerSummary> expected = summarize(object);
+        boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+
+        WHEN("The cache is exported and loaded back") {
+            REQUIRE(print.export_cached_data(dir.string()) == 0);
+            REQUIRE(print.load_cached_data(dir.string()) == 0);
+            THEN("The layers are restored") {
+                std::vector<LayerSummary> loaded = summarize(object);
+                REQUIRE(loaded.size() == expected.size());
+                for (size_t i = 0; i < loaded.size(); ++ i) {
+                    REQUIRE(loaded[i].lslices == expected[i].lslices);
+                    REQUIRE(loaded[i].area == Approx(expected[i].area));
+                    REQUIRE(loaded[i].perimeters == expected[i].perimeters);
+                    REQUIRE(loaded[i].fills == expected[i].fills);
+                }
+            }
+        }
+        WHEN("The offset table of the exported cache is not ordered") {
+            const_cast<ModelInstance*>(object.instances().front().model_instance)->loaded_id = 1;
+            REQUIRE(print.export_cached_data(dir.string()) == 0);
+            const std::string path = PrintCache::binary_file_name(dir.string(), 1);
+            CacheFile file(path, object.layer_count() + object.support_layer_count() + 3);
+            REQUIRE(file.offsets.back() == file.data.size());
+            // The second layer blob would end before it starts.
+            file.set(file.table_pos + 2 * sizeof(uint64_t), file.offsets[1] - 1);
+            file.save(path);
+            THEN("The cache is refused without reading outside of the blobs") {
+                REQUIRE(print.load_cached_data(dir.string()) == CLI_IMPORT_CACHE_LOAD_FAILED);
+                REQUIRE(object.layer_count() == 0);
+            }
+        }
+        WHEN("A layer of the exported cache references an unknown region") {
+            const_cast<ModelInstance*>(object.instances().front().model_instance)->loaded_id = 1;
+            REQUIRE(print.export_cached_data(dir.string()) == 0);
+            const std::string path = PrintCache::binary_file_name(dir.string(), 1);
+            CacheFile file(path, object.layer_count() + object.support_layer_count() + 3);
+            // Region hash of the first region of the last layer: id, height, print_z, slice_z, region count, region id.
+            const size_t region_hash_pos = file.offsets[object.layer_count() - 1] + 4 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+            file.set(region_hash_pos, ~file.get(region_hash_pos));
+            file.save(path);
+            THEN("The layers loaded before the failure are released") {
+                REQUIRE(print.load_cached_data(dir.string()) == CLI_IMPORT_CACHE_DATA_CAN_NOT_USE);
+                REQUIRE(object.layer_count() == 0);
+                REQUIRE(object.support_layer_count() == 0);
+            }
+        }
+        WHEN("The object geometry changes after the export") {
+            Slic3r::Print other;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, other, { { "fill_density", 0.4 } });
+            // The cache files are named after the loaded id of the instance, give both prints the same one as a project loaded twice would.
+            for (const Slic3r::Print *p : { &print, &other })
+                const_cast<ModelInstance*>(p->objects().front()->instances().front().model_instance)->loaded_id = 1;
+            REQUIRE(print.export_cached_data(dir.string()) == 0);
+            REQUIRE(boost::filesystem::exists(PrintCache::binary_file_name(dir.string(), 1)));
+            THEN("The content hash differs and the cached data is refused") {
+                REQUIRE(PrintCache::object_content_hash(*other.objects().front()) != PrintCache::object_content_hash(object));
+                REQUIRE(other.load_cached_data(dir.string()) == CLI_IMPORT_CACHE_DATA_CAN_NOT_USE);
+            }
+        }
+        boost::filesystem::remove_all(dir);
+    }
+}
+
+SCENARIO("Print: step cache across prints", "[Print]") {
+    GIVEN("A 20mm cube sliced into the step cache") {
+        boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        {
+            Slic3r::Print print;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, { { "fill_density", 0.2 } });
+            REQUIRE(print.export_step_cache(dir.string()) == 0);
+        }
+
+        WHEN("The same cube is sliced with a different infill density") {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, { { "fill_density", 0.4 } });
+            REQUIRE(print.load_step_cache(dir.string()) == 0);
+            const PrintObject &object = *print.objects().front();
+            THEN("Only the infill dependent steps are invalidated") {
+                REQUIRE(object.is_step_done(posSlice));
+                REQUIRE(object.is_step_done(posPerimeters));
+                REQUIRE(! object.is_step_done(posInfill));
+            }
+            THEN("Finishing the slicing gives the same layers as slicing from scratch") {
+                print.process();
+                Slic3r::Print reference;
+                Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, reference, { { "fill_density", 0.4 } });
+                std::vector<LayerSummary> loaded   = summarize(object);
+                std::vector<LayerSummary> expected = summarize(*reference.objects().front());
+                REQUIRE(loaded.size() == expected.size());
+                for (size_t i = 0; i < loaded.size(); ++ i) {
+                    REQUIRE(loaded[i].area == Approx(expected[i].area));
+                    REQUIRE(loaded[i].perimeters == expected[i].perimeters);
+                    REQUIRE(loaded[i].fills == expected[i].fills);
+                }
+            }
+        }
+        WHEN("The layer height profile of the cube is edited") {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+            config.set_deserialize_strict({ { "fill_density", 0.2 } });
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+            const uint64_t hash = PrintCache::object_geometry_hash(*print.objects().front());
+            model.objects.front()->layer_height_profile.set({ 0., 0.2, 10., 0.1, 20., 0.1 });
+            print.apply(model, config);
+            REQUIRE(print.load_step_cache(dir.string()) == 0);
+            THEN("The geometry hash differs and the sliced layers are not reused") {
+                REQUIRE(PrintCache::object_geometry_hash(*print.objects().front()) != hash);
+                REQUIRE(! print.objects().front()->is_step_done(posSlice));
+            }
+        }
+        WHEN("A different object is sliced") {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({TestMesh::pyramid}, print, model, { { "fill_density", 0.2 } });
+            REQUIRE(print.load_step_cache(dir.string()) == 0);
+            THEN("Nothing is reused") {
+                REQUIRE(! print.objects().front()->is_step_done(posSlice));
+            }
+        }
+        boost::filesystem::remove_all(dir);
+    }
+}
+
+SCENARIO("Print: step cache of an object with adaptive cubic infill", "[Print]") {
+    GIVEN("A 20mm cube with adaptive cubic infill sliced into the step cache") {
+        boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        {
+            Slic3r::Print print;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, { { "fill_density", 0.2 }, { "sparse_infill_pattern", "adaptivecubic" } });
+            REQUIRE(print.export_step_cache(dir.string()) == 0);
+        }
+
+        WHEN("The same cube is sliced with only the top surface pattern changed") {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model,
+                { { "fill_density", 0.2 }, { "sparse_infill_pattern", "adaptivecubic" }, { "top_surface_pattern", "concentric" } });
+            REQUIRE(print.load_step_cache(dir.string()) == 0);
+            const PrintObject &object = *print.objects().front();
+            THEN("The infill regions are prepared again, as the adaptive cubic octree is not cached") {
+                REQUIRE(object.is_step_done(posPerimeters));
+                REQUIRE(! object.is_step_done(posPrepareInfill));
+                REQUIRE(! object.is_step_done(posInfill));
+            }
+            THEN("Finishing the slicing gives the same layers as slicing from scratch") {
+                print.process();
+                Slic3r::Print reference;
+                Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, reference,
+                    { { "fill_density", 0.2 }, { "sparse_infill_pattern", "adaptivecubic" }, { "top_surface_pattern", "concentric" } });
+                std::vector<LayerSummary> loaded   = summarize(object);
+                std::vector<LayerSummary> expected = summarize(*reference.objects().front());
+                REQUIRE(loaded.size() == expected.size());
+                for (size_t i = 0; i < loaded.size(); ++ i) {
+                    REQUIRE(loaded[i].perimeters == expected[i].perimeters);
+                    REQUIRE(loaded[i].fills == expected[i].fills);
+                }
+            }
+        }
+        boost::filesystem::remove_all(dir);
+    }
+}
+
+// Not run by default, invoke with "[Benchmark]" to compare the binary cache with the readable json one.
+TEST_CASE("Print: slicing cache store / load benchmark", "[.][Benchmark]") {
+    Slic3r::Print print;
+    Slic3r::Test::init_and_process_print({TestMesh::sphere_50mm, TestMesh::ipadstand}, print, { { "fill_density", 0.3 }, { "layer_height", 0.1 } });
+
+    for (bool json : { false, true }) {
+        boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        Timing::Timer timer;
+        timer.start();
+        REQUIRE(print.export_cached_data(dir.string(), json) == 0);
+        double store_time = timer.elapsed_seconds();
+        timer.start();
+        REQUIRE(print.load_cached_data(dir.string()) == 0);
+        double load_time = timer.elapsed_seconds();
+        std::cout << (json ? "json  " : "binary") << ": store " << store_time << "s, load " << load_time << "s, size " << directory_size(dir) << " bytes" << std::endl;
+        boost::filesystem::remove_all(dir);
+    }
+}
@@ -1,12 +1,21 @@
 #include <catch2/catch.hpp>
 
 #include "libslic3r/libslic3r.h"
+#include "libslic3r/GCode.hpp"
 #include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/Model.hpp"
 
 #include "test_data.hpp"
 
 #include <algorithm>
+#include <map>
+#include <optional>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <boost/nowide/fstream.hpp>
 #include <boost/regex.hpp>
+#include <tbb/task_group.h>
 
 using namespace Slic3r;
 using namespace Slic3r::Test;
@@ -269,3 +278,123 @@ SCENARIO( "PrintGCode basic functionality", "[PrintGCode]") {
         }
     }
 }
+
+SCENARIO("PrintGCode of plates processed concurrently", "[PrintGCode]") {
+    GIVEN("Two plates with different objects and settings sharing the print speed table") {
+        DynamicPrintConfig config1 = DynamicPrintConfig::full_print_config();
+        DynamicPrintConfig config2 = DynamicPrintConfig::full_print_config();
+        config1.set_deserialize_strict({ { "brim_width", 3 } });
+        config2.set_deserialize_strict({ { "brim_width", 3 }, { "layer_height", 0.1 }, { "sparse_infill_density", "40%" } });
+        Model::setPrintSpeedTable(config1, Print().config());
+        WHEN("Both prints are processed at the same time") {
+            Print print1, print2;
+            Model model1, model2;
+            init_print({ TestMesh::cube_20x20x20 }, print1, model1, config1);
+            init_print({ TestMesh::pyramid }, print2, model2, config2);
+            print1.set_status_silent();
+            print2.set_status_silent();
+            tbb::task_group group;
+            group.run([&print1]() { print1.process(); });
+            group.run([&print2]() { print2.process(); });
+            group.wait();
+            THEN("The G-code of each plate is the same as if it was sliced alone") {
+                REQUIRE(gcode(print1) == slice({ TestMesh::cube_20x20x20 }, config1));
+                REQUIRE(gcode(print2) == slice({ TestMesh::pyramid }, config2));
+            }
+        }
+    }
+}
+
+SCENARIO("PrintGCode infill order of the instances of an object", "[PrintGCode]") {
+    GIVEN("Three instances of a step with solid and sparse infill in the same layers") {
+        // The lower layers of the step have a solid and a sparse infill collection in a single island,
+        // their chained copies are kept by the first instance for the other ones.
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({ { "sparse_infill_density", "20%" }, { "top_shell_layers", 3 }, { "bottom_shell_layers", 3 } });
+        Print print;
+        Model model;
+        init_print({ TestMesh::step }, print, model, config);
+        ModelObject *object = model.objects.front();
+        for (int i = 1; i < 3; ++ i)
+            object->add_instance(*object->instances.front())->set_offset(object->instances.front()->get_offset() + Vec3d(60. * i, 0., 0.));
+        print.apply(model, config);
+        print.validate();
+        std::string gcode = Slic3r::Test::gcode(print);
+
+        WHEN("The infill extrusions of each instance are collected") {
+            // Infill extrusion end points of the layer blocks of each instance, in their printing order.
+            std::map<int, std::vector<std::vector<Vec2d>>> infill_by_instance;
+            std::vector<Vec2d> *block = nullptr;
+            bool in_infill = false;
+            GCodeReader parser;
+            parser.parse_buffer(gcode, [&](GCodeReader &self, const GCodeReader::GCodeLine &line) {
+                const std::string &raw = line.raw();
+                if (boost::starts_with(raw, "; OBJECT_ID: ")) {
+                    std::vector<std::vector<Vec2d>> &blocks = infill_by_instance[std::stoi(raw.substr(13))];
+                    block = &blocks.emplace_back();
+                    in_infill = false;
+                } else if (boost::starts_with(raw, "; FEATURE: ")) {
+                    const std::string feature = raw.substr(11);
+                    in_infill = feature == "Sparse infill" || feature == "Internal solid infill" || feature == "Top surface" || feature == "Bottom surface";
+                } else if (in_infill && block != nullptr && line.cmd_is("G1") && line.has_e() && line.dist_XY(self) > 0)
+                    block->emplace_back(line.new_X(self), line.new_Y(self));
+            });
+            THEN("Every instance extrudes the infill of the first one shifted by its offset") {
+                REQUIRE(infill_by_instance.size() == 3);
+                const std::vector<std::vector<Vec2d>> &first = infill_by_instance.begin()->second;
+                size_t num_points = 0;
+                for (const std::vector<Vec2d> &points : first)
+                    num_points += points.size();
+                REQUIRE(num_points > 0);
+                for (const auto &[object_id, blocks] : infill_by_instance) {
+                    REQUIRE(blocks.size() == first.size());
+                    std::optional<Vec2d> shift;
+                    bool same_order = true;
+                    for (size_t layer = 0; layer < blocks.size() && same_order; ++ layer) {
+                        same_order = blocks[layer].size() == first[layer].size();
+                        for (size_t i = 0; i < blocks[layer].size() && same_order; ++ i) {
+                            if (! shift)
+                                shift = blocks[layer][i] - first[layer][i];
+                            same_order = (blocks[layer][i] - first[layer][i] - *shift).norm() < 0.002;
+                        }
+                    }
+                    REQUIRE(same_order);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("PrintGCode with the islands collected ahead of the generator", "[PrintGCode]") {
+    // Export the G-code the way Print::export_gcode() does, with or without GCode::collect_layer_islands().
+    auto export_gcode = [](Print &print, bool collect_layer_islands) {
+        boost::filesystem::path temp = boost::filesystem::unique_path();
+        GCode gcodegen;
+        gcodegen.set_collect_layer_islands(collect_layer_islands);
+        const Vec3d origin = print.get_plate_origin();
+        gcodegen.set_gcode_offset(origin(0), origin(1));
+        gcodegen.do_export(&print, temp.string().c_str());
+        boost::nowide::ifstream t(temp.string());
+        std::string str((std::istreambuf_iterator<char>(t)), std::istreambuf_iterator<char>());
+        t.close();
+        boost::nowide::remove(temp.string().c_str());
+        return str;
+    };
+    for (const char *print_sequence : { "by layer", "by object" }) {
+        GIVEN(std::string("Objects with several islands per layer, printed ") + print_sequence) {
+            // The legs of the bridge are two islands below the deck, the teeth of the pulley are separate perimeter collections.
+            DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+            config.set_deserialize_strict({ { "print_sequence", print_sequence }, { "sparse_infill_density", "20%" } });
+            Print print;
+            Model model;
+            init_print({ TestMesh::bridge, TestMesh::gt2_teeth }, print, model, config);
+            print.set_status_silent();
+            print.process();
+            THEN("The G-code is the same as with the islands looked up by the generator") {
+                const std::string gcode = export_gcode(print, true);
+                REQUIRE(! gcode.empty());
+                REQUIRE(gcode == export_gcode(print, false));
+            }
+        }
+    }
+}
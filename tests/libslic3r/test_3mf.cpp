@@ -2,7 +2,9 @@
 
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/3mf.hpp"
+#include "libslic3r/Format/bbs_3mf.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/TriangleSelector.hpp"
 
 #include <boost/filesystem/operations.hpp>
 
@@ -131,3 +133,95 @@ SCENARIO("2D convex hull of sinking object", "[3mf]") {
     }
 }
 
+SCENARIO("Painting strings of 3mf files round trip through TriangleSelector", "[3mf]") {
+    GIVEN("a cube painted with plain, extended and split triangles") {
+        Model        model;
+        ModelObject *object = model.add_object();
+        ModelVolume *volume = object->add_volume(make_cube(20., 20., 20.));
+        const std::vector<std::pair<int, std::string>> painting {
+            { 0, "4" }, { 1, "8" },
+            // Extruder5, Extruder20
+            { 2, "2C" }, { 5, "2FC" },
+            // Split into 4 triangles, the first of them split again.
+            { 7, "1C0C2C0C1C13" }
+        };
+        for (const auto &[triangle_id, str] : painting)
+            volume->mmu_segmentation_facets.set_triangle_from_string(triangle_id, str);
+
+        THEN("the strings are stored unchanged") {
+            for (const auto &[triangle_id, str] : painting)
+                REQUIRE(volume->mmu_segmentation_facets.get_triangle_as_string(triangle_id) == str);
+            REQUIRE(volume->mmu_segmentation_facets.get_triangle_as_string(3).empty());
+        }
+        THEN("the used states are read without expanding the trees") {
+            EnforcerBlockerStates used_states = volume->mmu_segmentation_facets.get_used_states();
+            REQUIRE(used_states.count() == 6);
+            for (int state : { 1, 2, 3, 4, 5, 20 })
+                REQUIRE(used_states.test(state));
+            REQUIRE(volume->mmu_segmentation_facets.has_facets(*volume, EnforcerBlockerType::Extruder20));
+            REQUIRE(! volume->mmu_segmentation_facets.has_facets(*volume, EnforcerBlockerType::Extruder6));
+            // Painted extruders followed by the extruder of the volume.
+            REQUIRE(volume->get_extruders() == std::vector<int>{ 1, 2, 3, 4, 5, 20, 1 });
+        }
+        WHEN("the painting is expanded by TriangleSelector and serialized again") {
+            TriangleSelector selector(volume->mesh());
+            selector.deserialize(volume->mmu_segmentation_facets.get_data(), false);
+            THEN("the serialized data match") {
+                REQUIRE(selector.serialize() == volume->mmu_segmentation_facets.get_data());
+            }
+        }
+    }
+}
+
+SCENARIO("Export+Import painted geometry to/from a split bbs 3mf file", "[3mf]") {
+    GIVEN("a dense painted sphere") {
+        // large enough for the triangles block to be parsed in several chunks
+        Model src_model;
+        ModelObject *src_object = src_model.add_object();
+        src_object->name = "sphere";
+        ModelVolume *src_volume = src_object->add_volume(make_sphere(20., PI / 200.));
+        src_object->add_instance();
+        const int facets_count = int(src_volume->mesh().facets_count());
+        src_volume->mmu_segmentation_facets.reserve(facets_count);
+        for (int i = 0; i < facets_count; i += 3)
+            src_volume->mmu_segmentation_facets.set_triangle_from_string(i, (i % 2) ? "4" : "8");
+        src_volume->mmu_segmentation_facets.shrink_to_fit();
+
+        WHEN("model is saved+loaded to/from 3mf file") {
+            std::string test_file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.3mf")).string();
+            DynamicPrintConfig src_config = DynamicPrintConfig::full_print_config();
+            StoreParams store_params;
+            store_params.path     = test_file.c_str();
+            store_params.model    = &src_model;
+            store_params.config   = &src_config;
+            store_params.strategy = SaveStrategy::Silence | SaveStrategy::SplitModel | SaveStrategy::Zip64;
+            REQUIRE(store_bbs_3mf(store_params));
+
+            Model                     dst_model;
+            DynamicPrintConfig        dst_config;
+            ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Enable };
+            PlateDataPtrs             plate_data;
+            std::vector<Preset*>      project_presets;
+            bool                      is_bbl_3mf = false;
+            Semver                    file_version;
+            bool loaded = load_bbs_3mf(test_file.c_str(), &dst_config, &ctxt, &dst_model, &plate_data, &project_presets, &is_bbl_3mf, &file_version, nullptr,
+                LoadStrategy::LoadModel | LoadStrategy::AddDefaultInstances);
+            release_PlateData_list(plate_data);
+            boost::filesystem::remove(test_file);
+
+            THEN("the mesh and its painting match") {
+                REQUIRE(loaded);
+                REQUIRE(dst_model.objects.size() == 1);
+                REQUIRE(dst_model.objects.front()->volumes.size() == 1);
+                const ModelVolume *dst_volume = dst_model.objects.front()->volumes.front();
+                REQUIRE(dst_volume->mesh().facets_count() == size_t(facets_count));
+                REQUIRE(dst_volume->mesh().its.vertices.size() == src_volume->mesh().its.vertices.size());
+                REQUIRE(std::abs(its_volume(dst_volume->mesh().its) - its_volume(src_volume->mesh().its)) < 1e-3 * its_volume(src_volume->mesh().its));
+                bool same_painting = true;
+                for (int i = 0; i < facets_count && same_painting; ++ i)
+                    same_painting = dst_volume->mmu_segmentation_facets.get_triangle_as_string(i) == src_volume->mmu_segmentation_facets.get_triangle_as_string(i);
+                REQUIRE(same_painting);
+            }
+        }
+    }
+}
@@ -58,3 +58,40 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Approx(0.5));
     REQUIRE(closest_point.z() == Approx(1.));
 }
+
+TEST_CASE("Ray packets find the same first hits as single rays", "[AABBIndirect]")
+{
+    TriangleMesh tmesh = make_sphere(1., PI / 20.);
+    tmesh.merge(make_cube(0.5, 0.5, 0.5));
+
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+    REQUIRE(! tree.empty());
+
+    // 37 rays, thus the last ray packet is only partially filled.
+    const Vec3d        origin(0.1, 0.2, 0.3);
+    std::vector<Vec3d> dirs;
+    for (int i = 0; i < 37; ++ i) {
+        double phi   = 2. * PI * i / 37.;
+        double theta = PI * (i + 0.5) / 37.;
+        dirs.emplace_back(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+    }
+    // Axis aligned ray, the inverse direction contains infinities.
+    dirs.emplace_back(0., 0., -1.);
+
+    std::vector<igl::Hit> hits;
+    AABBTreeIndirect::intersect_rays_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origin, dirs, hits);
+    REQUIRE(hits.size() == dirs.size());
+    for (size_t i = 0; i < dirs.size(); ++ i) {
+        igl::Hit hit;
+        bool intersected = AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origin, dirs[i], hit);
+        REQUIRE(intersected);
+        REQUIRE(hits[i].id == hit.id);
+        REQUIRE(hits[i].t == Approx(hit.t));
+    }
+
+    // Rays pointing away from the mesh do not hit anything.
+    AABBTreeIndirect::intersect_rays_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, Vec3d(0., 0., 5.), std::vector<Vec3d>{ Vec3d(0., 0., 1.), Vec3d(0.6, 0., 0.8) }, hits);
+    REQUIRE(hits.size() == 2);
+    REQUIRE(hits[0].id == -1);
+    REQUIRE(hits[1].id == -1);
+}
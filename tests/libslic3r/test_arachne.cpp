@@ -0,0 +1,133 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Arachne/WallToolPaths.hpp"
+#include "libslic3r/Line.hpp"
+#include "libslic3r/Polygon.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+using namespace Slic3r;
+
+// Extrusion line in a form independent of the order of the lines and of the start of the closed ones.
+using CanonicalLine = std::tuple<size_t, bool, bool, std::vector<std::tuple<coord_t, coord_t, coord_t>>>;
+
+static std::vector<CanonicalLine> canonical_lines(const std::vector<Arachne::VariableWidthLines> &toolpaths)
+{
+    std::vector<CanonicalLine> out;
+    for (const Arachne::VariableWidthLines &lines : toolpaths)
+        for (const Arachne::ExtrusionLine &line : lines) {
+            std::vector<std::tuple<coord_t, coord_t, coord_t>> junctions;
+            for (const Arachne::ExtrusionJunction &junction : line.junctions)
+                junctions.emplace_back(junction.p.x(), junction.p.y(), junction.w);
+            if (line.is_closed && junctions.size() > 1) {
+                // closed lines repeat their first junction at the end
+                bool repeated = junctions.front() == junctions.back();
+                if (repeated)
+                    junctions.pop_back();
+                std::rotate(junctions.begin(), std::min_element(junctions.begin(), junctions.end()), junctions.end());
+                if (repeated)
+                    junctions.emplace_back(junctions.front());
+            }
+            out.emplace_back(line.inset_idx, line.is_odd, line.is_closed, std::move(junctions));
+        }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Total length of the lines of a wall.
+static double wall_length(const Arachne::VariableWidthLines &lines)
+{
+    double length = 0.;
+    for (const Arachne::ExtrusionLine &line : lines)
+        length += line.getLength();
+    return length;
+}
+
+// With single_pass, the walls are generated by a single skeletal trapezoidation over the whole outline as before the islands
+// were split: enabling the hole compensation without any hole to compensate keeps the outline in one piece.
+// Largest distance of the junctions of line to the polyline of other.
+static double max_distance(const Arachne::ExtrusionLine &line, const Arachne::ExtrusionLine &other)
+{
+    double max_dist = 0.;
+    for (const Arachne::ExtrusionJunction &junction : line.junctions) {
+        double dist = std::numeric_limits<double>::max();
+        for (size_t i = 1; i < other.junctions.size(); ++ i)
+            dist = std::min(dist, Line(other.junctions[i - 1].p, other.junctions[i].p).distance_to(junction.p));
+        max_dist = std::max(max_dist, dist);
+    }
+    return max_dist;
+}
+
+static std::vector<Arachne::VariableWidthLines> generate_walls(const Polygons &outline, bool single_pass = false)
+{
+    Arachne::WallToolPathsParams params;
+    params.min_bead_width                   = 0.85f * 0.4f;
+    params.min_feature_size                 = 0.25f * 0.4f;
+    params.wall_transition_length           = 0.4f;
+    params.wall_transition_angle            = 10.f;
+    params.wall_transition_filter_deviation = 0.25f * 0.4f;
+    params.wall_distribution_count          = 1;
+    Arachne::WallToolPaths wall_tool_paths(outline, scaled<coord_t>(0.45), scaled<coord_t>(0.45), 3, 0, 0.2, params);
+    if (single_pass)
+        wall_tool_paths.EnableHoleCompensation(true, {});
+    return wall_tool_paths.getToolPaths();
+}
+
+TEST_CASE("Arachne walls of disjoint islands", "[ArachneWalls]") {
+    // A frame with a hole, a wedge getting thinner than the walls and a narrow strip, far from each other.
+    Polygon frame      = Polygon::new_scale({ { 0., 0. }, { 20., 0. }, { 20., 20. }, { 0., 20. } });
+    Polygon frame_hole = Polygon::new_scale({ { 5., 5. }, { 5., 15. }, { 15., 15. }, { 15., 5. } });
+    Polygon wedge      = Polygon::new_scale({ { 30., 0. }, { 50., 0. }, { 50., 0.5 }, { 30., 8. } });
+    Polygon strip      = Polygon::new_scale({ { 0., 30. }, { 40., 30. }, { 40., 31.2 }, { 0., 31.2 } });
+    std::vector<Polygons> islands { { frame, frame_hole }, { wedge }, { strip } };
+
+    Polygons outline;
+    for (const Polygons &island : islands)
+        append(outline, island);
+    std::vector<Arachne::VariableWidthLines> walls = generate_walls(outline);
+
+    std::vector<Arachne::VariableWidthLines> walls_by_islands;
+    for (const Polygons &island : islands) {
+        std::vector<Arachne::VariableWidthLines> island_walls = generate_walls(island);
+        REQUIRE(! island_walls.empty());
+        if (walls_by_islands.size() < island_walls.size())
+            walls_by_islands.resize(island_walls.size());
+        for (size_t wall_idx = 0; wall_idx < island_walls.size(); ++ wall_idx)
+            append(walls_by_islands[wall_idx], std::move(island_walls[wall_idx]));
+    }
+
+    // The walls of each island are the same as if the island was alone.
+    REQUIRE(walls.size() == walls_by_islands.size());
+    REQUIRE(canonical_lines(walls) == canonical_lines(walls_by_islands));
+}
+
+TEST_CASE("Arachne walls of disjoint islands match a single pass over the whole outline", "[ArachneWalls]") {
+    Polygon frame      = Polygon::new_scale({ { 0., 0. }, { 20., 0. }, { 20., 20. }, { 0., 20. } });
+    Polygon frame_hole = Polygon::new_scale({ { 5., 5. }, { 5., 15. }, { 15., 15. }, { 15., 5. } });
+    Polygon wedge      = Polygon::new_scale({ { 30., 0. }, { 50., 0. }, { 50., 0.5 }, { 30., 8. } });
+    Polygon strip      = Polygon::new_scale({ { 0., 30. }, { 40., 30. }, { 40., 31.2 }, { 0., 31.2 } });
+    Polygon ring       = Polygon::new_scale({ { 30., 20. }, { 40., 20. }, { 40., 25. }, { 30., 25. } });
+    Polygon ring_hole  = Polygon::new_scale({ { 31., 21. }, { 31., 24. }, { 39., 24. }, { 39., 21. } });
+    const Polygons outline { frame, frame_hole, wedge, strip, ring, ring_hole };
+
+    std::vector<Arachne::VariableWidthLines> walls        = generate_walls(outline);
+    std::vector<Arachne::VariableWidthLines> walls_single = generate_walls(outline, true);
+
+    // The junctions of the lines are placed differently by the two passes (a straight segment split in two, a corner
+    // rounded by a few microns), the lines are compared by their shape, not junction by junction.
+    const double tolerance = scaled<double>(0.025);
+    REQUIRE(walls.size() == walls_single.size());
+    for (size_t wall_idx = 0; wall_idx < walls.size(); ++ wall_idx) {
+        REQUIRE(walls[wall_idx].size() == walls_single[wall_idx].size());
+        REQUIRE(wall_length(walls[wall_idx]) == Approx(wall_length(walls_single[wall_idx])).margin(tolerance));
+        for (const Arachne::ExtrusionLine &line : walls[wall_idx]) {
+            auto it = std::min_element(walls_single[wall_idx].begin(), walls_single[wall_idx].end(),
+                [&line](const Arachne::ExtrusionLine &l1, const Arachne::ExtrusionLine &l2) { return max_distance(line, l1) < max_distance(line, l2); });
+            REQUIRE(it->is_closed == line.is_closed);
+            REQUIRE(max_distance(line, *it) < tolerance);
+            REQUIRE(max_distance(*it, line) < tolerance);
+        }
+    }
+}
@@ -7,6 +7,8 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/ExPolygon.hpp"
 #include "libslic3r/SVG.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+#include "libslic3r/Format/OBJ.hpp"
 
 using namespace Slic3r;
 
@@ -299,3 +301,164 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+namespace {
+
+// ClipperUtils operations reimplemented on ClipperLib directly, as a reference for the backend selected for this process.
+ClipperLib::Paths reference_clip(ClipperLib::ClipType clip_type, const Polygons &subject, const Polygons &clip)
+{
+    ClipperLib::Clipper clipper;
+    for (const Polygon &polygon : subject)
+        clipper.AddPath(polygon.points, ClipperLib::ptSubject, true);
+    for (const Polygon &polygon : clip)
+        clipper.AddPath(polygon.points, ClipperLib::ptClip, true);
+    ClipperLib::Paths out;
+    clipper.Execute(clip_type, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return out;
+}
+
+ClipperLib::Paths reference_clip_open(ClipperLib::ClipType clip_type, const Polylines &subject, const Polygons &clip)
+{
+    ClipperLib::Clipper clipper;
+    for (const Polyline &polyline : subject)
+        clipper.AddPath(polyline.points, ClipperLib::ptSubject, false);
+    for (const Polygon &polygon : clip)
+        clipper.AddPath(polygon.points, ClipperLib::ptClip, true);
+    ClipperLib::PolyTree polytree;
+    clipper.Execute(clip_type, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    ClipperLib::Paths out;
+    ClipperLib::OpenPathsFromPolyTree(polytree, out);
+    return out;
+}
+
+ClipperLib::Paths reference_offset(const Points &path, double delta, ClipperLib::JoinType join_type, double miter_limit, ClipperLib::EndType end_type)
+{
+    ClipperLib::ClipperOffset co;
+    if (join_type == ClipperLib::jtRound)
+        co.ArcTolerance = miter_limit;
+    else
+        co.MiterLimit = miter_limit;
+    co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
+    co.AddPath(path, join_type, end_type);
+    ClipperLib::Paths out;
+    co.Execute(out, delta);
+    return out;
+}
+
+// Largest distance of a vertex of one set of paths to the segments of the other set.
+double max_distance(const Lines &lines, const std::vector<Points> &paths)
+{
+    double max_dist = 0.;
+    for (const Points &path : paths)
+        for (const Point &pt : path) {
+            double dist = std::numeric_limits<double>::max();
+            for (const Line &line : lines)
+                dist = std::min(dist, line.distance_to(pt));
+            max_dist = std::max(max_dist, dist);
+        }
+    return max_dist;
+}
+
+// Both outlines have the same number of polygons and each vertex of one lies on the other one up to eps.
+void require_same_outlines(const Polygons &result, const ClipperLib::Paths &reference, double eps)
+{
+    REQUIRE(result.size() == reference.size());
+    const Polygons reference_polygons = to_polygons(reference);
+    std::vector<Points> result_paths;
+    for (const Polygon &polygon : result)
+        result_paths.emplace_back(polygon.points);
+    REQUIRE(max_distance(to_lines(reference_polygons), result_paths) <= eps);
+    REQUIRE(max_distance(to_lines(result), reference) <= eps);
+}
+
+void require_same_polylines(const Polylines &result, const ClipperLib::Paths &reference, double eps)
+{
+    Lines reference_lines;
+    double reference_length = 0.;
+    for (const Points &path : reference) {
+        Polyline polyline(path);
+        append(reference_lines, polyline.lines());
+        reference_length += polyline.length();
+    }
+    Lines result_lines;
+    double result_length = 0.;
+    std::vector<Points> result_paths;
+    for (const Polyline &polyline : result) {
+        append(result_lines, polyline.lines());
+        result_length += polyline.length();
+        result_paths.emplace_back(polyline.points);
+    }
+    REQUIRE(result_length == Approx(reference_length).margin(eps * double(reference.size() + 1)));
+    REQUIRE(max_distance(reference_lines, result_paths) <= eps);
+    REQUIRE(max_distance(result_lines, reference) <= eps);
+}
+
+} // namespace
+
+// ClipperUtils runs on the backend fixed for this process, ctest runs the [ClipperUtils] tests once more with SLIC3R_CLIPPER_BACKEND=clipper2.
+// The results are compared vertex by vertex against ClipperLib called directly.
+TEST_CASE("ClipperUtils backend produces the same outlines as ClipperLib on sliced layers", "[ClipperUtils]") {
+    INFO("Backend: " << (ClipperUtils::backend() == ClipperUtils::Backend::Clipper2 ? "Clipper2" : "ClipperLib"));
+
+    TriangleMesh        mesh;
+    ObjInfo             obj_info;
+    std::string         message;
+    REQUIRE(load_obj(TEST_DATA_DIR "/extruder_idler.obj", &mesh, obj_info, message));
+    const BoundingBoxf3 bbox = mesh.bounding_box();
+    std::vector<float>  zs;
+    for (int i = 1; i < 12; ++ i)
+        zs.emplace_back(float(bbox.min.z() + (bbox.max.z() - bbox.min.z()) * i / 12.));
+    std::vector<ExPolygons> layers = slice_mesh_ex(mesh.its, zs);
+
+    // Both libraries round the intersection points and the offsetted vertices to integers.
+    const double eps_boolean = 2.;
+    // Arc tolerance of the round offsets. ClipperLib rounds the number of segments of an arc to the nearest integer,
+    // Clipper2 rounds it up, thus the chords of ClipperLib's short arcs may deviate from the arc up to 2.25 times the arc tolerance.
+    const double arc_tolerance = 5.;
+    const double eps_offset    = 2.5 * arc_tolerance;
+    // Clipper2 replaces the square join of corners straighter than 2.5 degrees with a miter join, which deviates
+    // from the square join by up to delta * (1 - cos(1.25 degrees)). The miter joins of both libraries differ by rounding.
+    auto         eps_join      = [eps_boolean](float delta) { return eps_boolean + 2.5e-4 * std::abs(delta); };
+
+    for (size_t i = 1; i < layers.size(); ++ i) {
+        const Polygons lower = to_polygons(layers[i - 1]);
+        const Polygons upper = to_polygons(layers[i]);
+        REQUIRE(! upper.empty());
+        INFO("Layer " << i);
+
+        require_same_outlines(union_(upper, lower), reference_clip(ClipperLib::ctUnion, upper, lower), eps_boolean);
+        require_same_outlines(diff(upper, lower), reference_clip(ClipperLib::ctDifference, upper, lower), eps_boolean);
+        require_same_outlines(intersection(upper, lower), reference_clip(ClipperLib::ctIntersection, upper, lower), eps_boolean);
+        {
+            const ExPolygons result    = diff_ex(upper, lower);
+            ClipperLib::Paths reference = reference_clip(ClipperLib::ctDifference, upper, lower);
+            REQUIRE(result.size() == size_t(std::count_if(reference.begin(), reference.end(), [](const Points &path) { return ClipperLib::Orientation(path); })));
+            require_same_outlines(to_polygons(result), reference, eps_boolean);
+        }
+
+        // Infill like hatching clipped by the layer.
+        const BoundingBox layer_bbox = get_extents(upper);
+        Polylines hatching;
+        for (coord_t x = layer_bbox.min.x() + scaled<coord_t>(0.3); x < layer_bbox.max.x(); x += scaled<coord_t>(0.9))
+            hatching.emplace_back(Point(x, layer_bbox.min.y() - 100), Point(x + scaled<coord_t>(0.5), layer_bbox.max.y() + 100));
+        const Polylines infill = intersection_pl(hatching, upper);
+        require_same_polylines(infill, reference_clip_open(ClipperLib::ctIntersection, hatching, upper), eps_boolean);
+        require_same_polylines(diff_pl(hatching, upper), reference_clip_open(ClipperLib::ctDifference, hatching, upper), eps_boolean);
+
+        // Offsets of the contours with all the join types.
+        for (const ExPolygon &expoly : layers[i])
+            for (const float delta : { scaled<float>(0.2), - scaled<float>(0.2), scaled<float>(1.5) }) {
+                require_same_outlines(offset(expoly.contour, delta, ClipperLib::jtMiter, 3.),
+                    reference_offset(expoly.contour.points, delta, ClipperLib::jtMiter, 3., ClipperLib::etClosedPolygon), eps_join(delta));
+                require_same_outlines(offset(expoly.contour, delta, ClipperLib::jtSquare, 3.),
+                    reference_offset(expoly.contour.points, delta, ClipperLib::jtSquare, 3., ClipperLib::etClosedPolygon), eps_join(delta));
+                require_same_outlines(offset(expoly.contour, delta, ClipperLib::jtRound, arc_tolerance),
+                    reference_offset(expoly.contour.points, delta, ClipperLib::jtRound, arc_tolerance, ClipperLib::etClosedPolygon), eps_offset);
+            }
+        // Offsets of open polylines, as used for the thick lines of the support and of the brim.
+        for (const Polyline &polyline : infill)
+            for (const ClipperLib::EndType end_type : { ClipperLib::etOpenButt, ClipperLib::etOpenSquare, ClipperLib::etOpenRound })
+                require_same_outlines(offset(polyline, scaled<float>(0.2), ClipperLib::jtRound, arc_tolerance, end_type),
+                    reference_offset(polyline.points, scaled<float>(0.2), ClipperLib::jtRound, arc_tolerance, end_type), eps_offset);
+    }
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/miniz_extension.hpp"
+
+#include <random>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+using namespace Slic3r;
+
+static std::string make_test_data(size_t size)
+{
+    // G-code like text with some noise, so that the blocks neither compress to nothing nor fail to compress.
+    std::mt19937 rng(42);
+    std::string  data;
+    data.reserve(size + 64);
+    while (data.size() < size)
+        data += "G1 X" + std::to_string(rng() % 25600) + " Y" + std::to_string(rng() % 25600) + " E0.0" + std::to_string(rng() % 1000) + "\n";
+    data.resize(size);
+    return data;
+}
+
+static std::string deflate_to_zip_and_extract(const std::string &data, int level)
+{
+    const std::string src_file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.gcode")).string();
+    const std::string zip_file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.zip")).string();
+    {
+        boost::nowide::ofstream ofs(src_file, std::ios::binary);
+        ofs.write(data.data(), std::streamsize(data.size()));
+    }
+
+    MZ_DeflatedData deflated;
+    REQUIRE(deflate_file_parallel(src_file, level, deflated));
+    REQUIRE(deflated.uncomp_size == data.size());
+
+    mz_zip_archive writer;
+    mz_zip_zero_struct(&writer);
+    REQUIRE(open_zip_writer(&writer, zip_file));
+    REQUIRE(add_deflated_to_zip(&writer, "Metadata/plate_1.gcode", deflated, level));
+    REQUIRE(mz_zip_writer_finalize_archive(&writer));
+    REQUIRE(close_zip_writer(&writer));
+
+    mz_zip_archive reader;
+    mz_zip_zero_struct(&reader);
+    REQUIRE(open_zip_reader(&reader, zip_file));
+    mz_zip_archive_file_stat stat;
+    REQUIRE(mz_zip_reader_file_stat(&reader, 0, &stat));
+    CHECK(stat.m_method == MZ_DEFLATED);
+    CHECK(stat.m_uncomp_size == data.size());
+    std::string extracted(size_t(stat.m_uncomp_size), '\0');
+    // miniz verifies the crc32 of the extracted entry
+    bool ok = mz_zip_reader_extract_to_mem(&reader, 0, extracted.data(), extracted.size(), 0);
+    close_zip_reader(&reader);
+
+    boost::filesystem::remove(src_file);
+    boost::filesystem::remove(zip_file);
+    REQUIRE(ok);
+    return extracted;
+}
+
+TEST_CASE("Parallel deflate round trip through a zip entry", "[miniz]") {
+    // several blocks of 1MB, the last one partial
+    const std::string data = make_test_data(3 * 1024 * 1024 + 12345);
+    SECTION("default compression") {
+        REQUIRE(deflate_to_zip_and_extract(data, MZ_DEFAULT_COMPRESSION) == data);
+    }
+    SECTION("fastest compression") {
+        REQUIRE(deflate_to_zip_and_extract(data, MZ_BEST_SPEED) == data);
+    }
+    SECTION("best compression") {
+        REQUIRE(deflate_to_zip_and_extract(data, MZ_BEST_COMPRESSION) == data);
+    }
+    SECTION("no compression") {
+        REQUIRE(deflate_to_zip_and_extract(data, MZ_NO_COMPRESSION) == data);
+    }
+    SECTION("single block") {
+        const std::string small = make_test_data(1000);
+        REQUIRE(deflate_to_zip_and_extract(small, MZ_DEFAULT_COMPRESSION) == small);
+    }
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Profiler.hpp"
+
+#include <clocale>
+#include <set>
+#include <thread>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "nlohmann/json.hpp"
+
+using namespace Slic3r;
+
+static void profiled_work(int depth)
+{
+    SLIC3R_PROFILE_ZONE_DETAIL("work", "depth \"" + std::to_string(depth) + "\"");
+    if (depth > 0)
+        profiled_work(depth - 1);
+}
+
+TEST_CASE("Profiler records nested zones of multiple threads", "[Profiler]") {
+    Profiler::clear();
+
+    SECTION("Nothing is recorded while disabled") {
+        profiled_work(2);
+        REQUIRE(Profiler::summary().empty());
+    }
+
+    SECTION("Zones are recorded and exported while enabled") {
+        boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.json");
+        {
+            Profiler::Session session(path.string());
+            profiled_work(2);
+            std::thread thread([]() { profiled_work(1); });
+            thread.join();
+        }
+        REQUIRE(! Profiler::enabled());
+
+        std::vector<Profiler::ZoneStats> stats = Profiler::summary();
+        REQUIRE(stats.size() == 1);
+        REQUIRE(stats.front().name == "work");
+        REQUIRE(stats.front().count == 5);
+
+        boost::nowide::ifstream in(path.string());
+        nlohmann::json trace = nlohmann::json::parse(in);
+        size_t zones = 0;
+        std::set<int> threads;
+        for (const nlohmann::json &event : trace["traceEvents"])
+            if (event["ph"] == "X") {
+                ++ zones;
+                threads.insert(event["tid"].get<int>());
+                REQUIRE(event["args"]["detail"].get<std::string>().find("depth \"") == 0);
+            }
+        REQUIRE(zones == 5);
+        REQUIRE(threads.size() == 2);
+        in.close();
+        boost::filesystem::remove(path);
+    }
+
+    SECTION("The export does not depend on the numeric locale") {
+        // The GUI runs with the user locale, which may use a decimal comma.
+        std::string old_locale = std::setlocale(LC_NUMERIC, nullptr);
+        const char *comma_locale = nullptr;
+        for (const char *name : { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR", "German" })
+            if (std::setlocale(LC_NUMERIC, name) != nullptr) {
+                comma_locale = name;
+                break;
+            }
+        if (comma_locale == nullptr)
+            WARN("No locale with a decimal comma is installed, the trace is exported with the current locale.");
+
+        boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.json");
+        {
+            Profiler::Session session(path.string());
+            profiled_work(1);
+        }
+        std::setlocale(LC_NUMERIC, old_locale.c_str());
+
+        boost::nowide::ifstream in(path.string());
+        nlohmann::json trace;
+        REQUIRE_NOTHROW(trace = nlohmann::json::parse(in));
+        size_t zones = 0;
+        for (const nlohmann::json &event : trace["traceEvents"])
+            if (event["ph"] == "X") {
+                ++ zones;
+                REQUIRE(event["ts"].is_number());
+                REQUIRE(event["dur"].is_number());
+                REQUIRE(event["dur"].get<double>() >= 0.);
+            }
+        REQUIRE(zones == 2);
+        in.close();
+        boost::filesystem::remove(path);
+    }
+
+    Profiler::clear();
+}